@@ -0,0 +1,241 @@
+"""
+Decoder for the device's live framebuffer stream (src/frame_stream.hh)
+
+The device sends each streamed frame as a COBS packet between 0x00 bytes on
+its USB serial port, interleaved with the usual console text. This tool
+rebuilds the frames and shows them in a window and/or writes them as PNGs.
+Console text is passed through to stdout, so a REPLAY capture still works
+while streaming.
+
+    python3 frame_stream.py /dev/ttyACM0 --window
+    python3 frame_stream.py /dev/ttyACM0 --png frames/
+    python3 frame_stream.py capture.bin --png frames/   # a saved stream
+
+Input can be a serial device (put in raw mode, no baud rate needed for
+USB CDC), a file, or - for stdin.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import time
+import tty
+import zlib
+
+KEYFRAME = ord("K")
+DELTA = ord("D")
+HEADER = struct.Struct("<BBBBHHI")   # type, width, height, reserved, sequence, base, tick
+
+
+def _crc_table():
+    table = []
+    for byte in range(256):
+        crc = byte << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x04C11DB7) if crc & 0x80000000 else crc << 1
+        table.append(crc & 0xFFFFFFFF)
+    return table
+
+
+_CRC_TABLE = _crc_table()
+
+
+def crc32_mpeg2(data):
+    """CRC-32/MPEG-2, as the device's DMA sniffer computes it"""
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc = ((crc << 8) & 0xFFFFFFFF) ^ _CRC_TABLE[(crc >> 24) ^ byte]
+    return crc
+
+
+def cobs_decode(chunk):
+    """Bytes of one COBS packet (delimiters stripped), or None if malformed"""
+    out = bytearray()
+    i = 0
+    while i < len(chunk):
+        code = chunk[i]
+        if code == 0 or i + code > len(chunk):
+            return None
+        out += chunk[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(chunk):
+            out.append(0)
+    return bytes(out)
+
+
+def _varint(data, pos):
+    value = shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+class StreamDecoder:
+    """Rebuilds frames from packets; deltas wait for a matching base"""
+
+    def __init__(self):
+        self.frame = None
+        self.width = self.height = 0
+        self.sequence = None
+        self.packets = self.keyframes = self.bad = self.unsynced = 0
+        self.bytes = 0
+
+    def packet(self, packet):
+        """
+        Apply one decoded packet
+
+        Returns:
+            (tick, frame bytes) for a new frame, or None
+        """
+        if len(packet) < HEADER.size + 4:
+            self.bad += 1
+            return None
+        body, crc = packet[:-4], struct.unpack_from("<I", packet, len(packet) - 4)[0]
+        if crc32_mpeg2(body) != crc:
+            self.bad += 1
+            return None
+
+        kind, width, height, _, sequence, base, tick = HEADER.unpack_from(body, 0)
+        if kind == KEYFRAME:
+            self.width, self.height = width, height
+            self.frame = bytearray(width * height * 3)
+            self.keyframes += 1
+        elif kind != DELTA or self.frame is None or base != self.sequence:
+            # Joined mid-stream or lost the delta's base: wait for a keyframe
+            self.unsynced += 1
+            self.sequence = None
+            return None
+
+        frame = self.frame
+        pos = HEADER.size
+        pixel = 0
+        try:
+            while pos < len(body):
+                skip, pos = _varint(body, pos)
+                count, pos = _varint(body, pos)
+                fill, count = count & 1, count >> 1
+                pixel += skip
+                start, end = pixel * 3, (pixel + count) * 3
+                if end > len(frame):
+                    raise IndexError
+                if fill:
+                    frame[start:end] = body[pos:pos + 3] * count
+                    pos += 3
+                else:
+                    frame[start:end] = body[pos:pos + count * 3]
+                    pos += count * 3
+                pixel += count
+        except IndexError:
+            self.bad += 1
+            self.sequence = None
+            return None
+
+        self.sequence = sequence
+        self.packets += 1
+        self.bytes += len(packet)
+        return tick, bytes(frame)
+
+
+def write_png(path, width, height, rgb):
+    """Minimal 8-bit RGB PNG writer (no dependencies)"""
+    def chunk(tag, data):
+        return (struct.pack(">I", len(data)) + tag + data +
+                struct.pack(">I", zlib.crc32(tag + data) & 0xFFFFFFFF))
+
+    stride = width * 3
+    raw = b"".join(b"\x00" + rgb[y * stride:(y + 1) * stride] for y in range(height))
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw)))
+        f.write(chunk(b"IEND", b""))
+
+
+def _open_input(path):
+    if path == "-":
+        return sys.stdin.buffer.raw
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd, termios.TCSANOW)
+    return os.fdopen(fd, "rb", buffering=0)
+
+
+def _is_text(chunk):
+    return all(byte >= 0x20 or byte in b"\t\r\n" for byte in chunk)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("input", help="serial device, stream file, or - for stdin")
+    parser.add_argument("--png", metavar="DIR", help="write every frame as DIR/frame_NNNNNN.png")
+    parser.add_argument("--window", action="store_true", help="show the frames in a window")
+    parser.add_argument("--pixel-size", type=int, default=15)
+    args = parser.parse_args()
+
+    if args.png:
+        os.makedirs(args.png, exist_ok=True)
+    matrix = None
+
+    decoder = StreamDecoder()
+    source = _open_input(args.input)
+    pending = b""
+    frames = 0
+    start = time.monotonic()
+    try:
+        while True:
+            data = source.read(4096)
+            if not data:
+                break
+            chunks = (pending + data).split(b"\x00")
+            pending = chunks.pop()
+
+            for chunk in chunks:
+                if not chunk:
+                    continue
+                # A packet's first byte is always 4 (the header's reserved
+                # byte is 0), so it is never mistaken for console text
+                if _is_text(chunk):
+                    sys.stdout.write(chunk.decode("ascii", "replace"))
+                    sys.stdout.flush()
+                    continue
+                packet = cobs_decode(chunk)
+                if packet is None:
+                    decoder.bad += 1
+                    continue
+                result = decoder.packet(packet)
+                if result is None:
+                    continue
+
+                tick, frame = result
+                frames += 1
+                if args.png:
+                    write_png(os.path.join(args.png, "frame_%06d.png" % frames),
+                              decoder.width, decoder.height, frame)
+                if args.window:
+                    if matrix is None:
+                        from led_matrix import LEDMatrixSimulator
+                        matrix = LEDMatrixSimulator(decoder.width, decoder.height,
+                                                    pixel_size=args.pixel_size)
+                    if not matrix.show_frame(frame):
+                        return
+    except KeyboardInterrupt:
+        pass
+    finally:
+        seconds = time.monotonic() - start
+        sys.stderr.write("%d frames (%d keyframes) in %.1f s, %.0f bytes/frame; "
+                         "%d bad packets, %d deltas without a base\n"
+                         % (frames, decoder.keyframes, seconds,
+                            decoder.bytes / max(decoder.packets, 1),
+                            decoder.bad, decoder.unsynced))
+        if matrix is not None:
+            matrix.close()
+
+
+if __name__ == "__main__":
+    main()
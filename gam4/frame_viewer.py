@@ -0,0 +1,136 @@
+"""
+Live view of the C++ engine through the shared-memory frame ring
+
+A host tool publishes every finished frame to a POSIX shared-memory ring
+(host/frame_ring.hh), e.g.
+
+    .pio/build/replay/program capture.log view 4
+
+and this viewer maps the ring read-only and blits the newest frame straight
+out of it each time the window refreshes; no pixels are copied or parsed in
+Python. Start it before or after the producer.
+
+    python3 frame_viewer.py [pixel_size] [ring_name]
+"""
+
+import mmap
+import os
+import struct
+import sys
+import time
+
+import pygame
+
+from led_matrix import LEDMatrixSimulator
+
+RING_MAGIC = 0x52464454  # "TDFR"
+RING_VERSION = 1
+HEADER = struct.Struct("<IHHHHIII")   # magic .. target_fps
+SEQUENCE_OFFSET = 24                  # FrameRingHeader.sequence
+HEADER_SIZE = 64
+SLOT = struct.Struct("<QQI")          # sequence, publish_ns, tick
+
+
+class FrameRing:
+    """Read-only mapping of a frame ring"""
+
+    def __init__(self, name):
+        self.path = path = "/dev/shm/" + name.lstrip("/")
+        fd = os.open(path, os.O_RDONLY)
+        self.inode = os.fstat(fd).st_ino
+        try:
+            self.map = mmap.mmap(fd, 0, prot=mmap.PROT_READ)
+        finally:
+            os.close(fd)
+        self.view = memoryview(self.map)
+
+        (magic, version, self.slot_count, self.width, self.height,
+         self.slot_stride, self.pixels_offset, self.target_fps) = HEADER.unpack_from(self.map, 0)
+        if magic != RING_MAGIC or version != RING_VERSION:
+            raise ValueError("%s is not a version %d frame ring" % (path, RING_VERSION))
+        self.frame_size = self.width * self.height * 3
+
+    def sequence(self):
+        return struct.unpack_from("<Q", self.map, SEQUENCE_OFFSET)[0]
+
+    def slot(self, sequence):
+        """(slot sequence, publish_ns, tick, pixel memoryview) for a frame"""
+        offset = HEADER_SIZE + (sequence % self.slot_count) * self.slot_stride
+        slot_sequence, publish_ns, tick = SLOT.unpack_from(self.map, offset)
+        start = offset + self.pixels_offset
+        return slot_sequence, publish_ns, tick, self.view[start:start + self.frame_size]
+
+    def slot_sequence(self, sequence):
+        offset = HEADER_SIZE + (sequence % self.slot_count) * self.slot_stride
+        return struct.unpack_from("<Q", self.map, offset)[0]
+
+    def replaced(self):
+        """True once the producer has gone or a new one made a new segment"""
+        try:
+            return os.stat(self.path).st_ino != self.inode
+        except FileNotFoundError:
+            return True
+
+    def close(self):
+        self.view.release()
+        self.map.close()
+
+
+def wait_for_ring(name):
+    while True:
+        try:
+            return FrameRing(name)
+        except (FileNotFoundError, ValueError):
+            time.sleep(0.2)
+
+
+def main():
+    pixel_size = int(sys.argv[1]) if len(sys.argv) > 1 else 15
+    name = sys.argv[2] if len(sys.argv) > 2 else "/td_frames"
+
+    print("Waiting for frames on %s..." % name)
+    ring = wait_for_ring(name)
+    matrix = LEDMatrixSimulator(ring.width, ring.height, pixel_size=pixel_size)
+
+    shown = 0
+    last_sequence = 0
+    last_report = time.monotonic()
+    running = True
+    while running:
+        sequence = ring.sequence()
+        if sequence != last_sequence and sequence > 0:
+            slot_sequence, publish_ns, tick, pixels = ring.slot(sequence)
+            frame = bytes(pixels)
+            pixels.release()
+            # Show the copy only if the producer did not lap the ring while
+            # it was being taken; otherwise wait for the next frame
+            if slot_sequence == sequence and ring.slot_sequence(sequence) == sequence:
+                running = matrix.show_frame(frame)
+                last_sequence = sequence
+                shown += 1
+        else:
+            for event in pygame.event.get():
+                if event.type == pygame.QUIT:
+                    running = False
+            time.sleep(0.001)
+
+        now = time.monotonic()
+        if now - last_report >= 1.0 and ring.replaced():
+            # A restarted producer creates a fresh segment; follow it
+            ring.close()
+            ring = wait_for_ring(name)
+            last_sequence = 0
+        if now - last_report >= 1.0:
+            pygame.display.set_caption("td frames: %d shown/s, frame %d, tick %d, producer %s fps"
+                                       % (shown / (now - last_report), last_sequence,
+                                          tick if last_sequence else 0,
+                                          ring.target_fps or "unpaced"))
+            shown = 0
+            last_report = now
+
+    ring.close()
+    matrix.close()
+
+
+if __name__ == "__main__":
+    main()
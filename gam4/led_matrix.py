@@ -114,6 +114,26 @@ class LEDMatrixSimulator:
         pygame.display.flip()
         return True
     
+    def show_frame(self, frame):
+        """
+        Display a whole frame in one blit, bypassing the per-pixel buffer
+        
+        Args:
+            frame: height x width x 3 uint8 RGB pixels, row by row (any
+                   buffer: bytes, memoryview, contiguous numpy array)
+        
+        Returns:
+            bool: False if window was closed, True otherwise
+        """
+        for event in pygame.event.get():
+            if event.type == pygame.QUIT:
+                return False
+        
+        surface = pygame.image.frombuffer(frame, (self.width, self.height), "RGB")
+        self.screen.blit(pygame.transform.scale(surface, self.screen.get_size()), (0, 0))
+        pygame.display.flip()
+        return True
+    
     def tick(self, fps=60):
         """
         Control frame rate
@@ -0,0 +1,293 @@
+"""
+Python bindings to the C++ game core (host/td_engine.h)
+
+Build the shared library first:
+
+    pio run -e pylib        # -> .pio/build/pylib/libtd.so
+
+then drive the real engine from the prototype, the map tools or a balancing
+script:
+
+    from td_engine import Engine, MACHINE_GUN
+    engine = Engine(map_index=0)
+    engine.place_tower(2, MACHINE_GUN)
+    engine.start_wave(0)
+    engine.auto_waves = True
+    engine.step(5000)
+    print(engine.status())
+
+Enemy, tower and framebuffer arrays are numpy views straight into the C++
+state. They are never copied and they update in place as the engine steps.
+Set TD_ENGINE_LIB to load the library from somewhere else.
+"""
+
+import ctypes
+import os
+import sys
+import time
+
+import numpy as np
+
+ABI_VERSION = 1
+
+# TowerType / EnemyType (src/game_types.h)
+MACHINE_GUN, CANNON, SNIPER, RADAR = range(4)
+SCOUT, TANK, SPLITTER, GHOST = range(4)
+
+# ENEMY_FLAG_* (src/game_types.h)
+FLAG_INVISIBLE = 0x01
+FLAG_REVEALED = 0x02
+
+# TdArrayId, in order
+_ARRAYS = [
+    "enemy_x", "enemy_y", "enemy_progress", "enemy_speed", "enemy_health",
+    "enemy_type", "enemy_flags", "enemy_alive", "enemy_order",
+    "tower_x", "tower_y", "tower_ready_tick", "tower_type", "tower_alive",
+    "framebuffer",
+]
+
+
+class _Status(ctypes.Structure):
+    _fields_ = [
+        ("tick", ctypes.c_uint32),
+        ("money", ctypes.c_uint32),
+        ("score", ctypes.c_uint32),
+        ("wave", ctypes.c_uint16),
+        ("enemy_count", ctypes.c_uint16),
+        ("lives", ctypes.c_uint8),
+        ("tower_count", ctypes.c_uint8),
+        ("projectile_count", ctypes.c_uint8),
+        ("tower_slot_count", ctypes.c_uint8),
+        ("map_index", ctypes.c_uint8),
+        ("total_waves", ctypes.c_uint8),
+        ("wave_active", ctypes.c_bool),
+        ("wave_complete", ctypes.c_bool),
+        ("endless", ctypes.c_bool),
+    ]
+
+
+class _Array(ctypes.Structure):
+    _fields_ = [
+        ("data", ctypes.c_void_p),
+        ("kind", ctypes.c_char),
+        ("item_size", ctypes.c_uint8),
+        ("ndim", ctypes.c_uint8),
+        ("shape", ctypes.c_uint32 * 3),
+    ]
+
+
+def _library_path():
+    if "TD_ENGINE_LIB" in os.environ:
+        return os.environ["TD_ENGINE_LIB"]
+    suffix = {"win32": ".dll", "darwin": ".dylib"}.get(sys.platform, ".so")
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    return os.path.join(root, ".pio", "build", "pylib", "libtd" + suffix)
+
+
+def _load():
+    lib = ctypes.CDLL(_library_path())
+    engine = ctypes.c_void_p
+
+    signatures = {
+        "td_abi_version": (ctypes.c_uint32, []),
+        "td_create": (engine, [ctypes.c_uint8]),
+        "td_destroy": (None, [engine]),
+        "td_step": (ctypes.c_uint32, [engine, ctypes.c_uint32]),
+        "td_set_auto_waves": (None, [engine, ctypes.c_bool]),
+        "td_status": (None, [engine, ctypes.POINTER(_Status)]),
+        "td_place_tower": (ctypes.c_bool, [engine, ctypes.c_uint8, ctypes.c_uint8]),
+        "td_start_wave": (ctypes.c_bool, [engine, ctypes.c_uint16]),
+        "td_set_endless": (None, [engine, ctypes.c_uint32]),
+        "td_spawn_enemy": (None, [engine, ctypes.c_uint8]),
+        "td_set_money": (None, [engine, ctypes.c_uint32]),
+        "td_tower_slot": (ctypes.c_bool, [engine, ctypes.c_uint8,
+                                          ctypes.POINTER(ctypes.c_int16),
+                                          ctypes.POINTER(ctypes.c_int16),
+                                          ctypes.POINTER(ctypes.c_bool)]),
+        "td_draw": (None, [engine]),
+        "td_array": (ctypes.c_bool, [engine, ctypes.c_int, ctypes.POINTER(_Array)]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+
+    if lib.td_abi_version() != ABI_VERSION:
+        raise RuntimeError("libtd ABI %d does not match td_engine.py (%d); rebuild it"
+                           % (lib.td_abi_version(), ABI_VERSION))
+    return lib
+
+
+_lib = None
+
+
+class _Views:
+    """Attribute bag of numpy views (e.g. engine.enemies.x)"""
+
+    def __init__(self, **views):
+        self.__dict__.update(views)
+
+
+class Engine:
+    """One game running in the C++ core"""
+
+    def __init__(self, map_index=0):
+        """
+        Create a game on a compiled-in map
+
+        Args:
+            map_index: Map to load (index into the sorted gam4/maps/*.json)
+        """
+        global _lib
+        if _lib is None:
+            _lib = _load()
+
+        self._handle = _lib.td_create(map_index)
+        if not self._handle:
+            raise ValueError("map %d does not exist in this build" % map_index)
+        self._auto_waves = False
+
+        views = {name: self._view(i) for i, name in enumerate(_ARRAYS)}
+        self.framebuffer_view = views.pop("framebuffer")
+        self.enemies = _Views(**{k[6:]: v for k, v in views.items() if k.startswith("enemy_")})
+        self.towers = _Views(**{k[6:]: v for k, v in views.items() if k.startswith("tower_")})
+
+    def _view(self, array_id):
+        info = _Array()
+        if not _lib.td_array(self._handle, array_id, ctypes.byref(info)):
+            raise RuntimeError("td_array(%d) failed" % array_id)
+
+        dtype = np.dtype("<%s%d" % (info.kind.decode(), info.item_size))
+        shape = tuple(info.shape[:info.ndim])
+        count = int(np.prod(shape))
+        buffer = (ctypes.c_uint8 * (count * dtype.itemsize)).from_address(info.data)
+        return np.frombuffer(buffer, dtype=dtype, count=count).reshape(shape)
+
+    def close(self):
+        """Free the game; its views must not be used afterwards"""
+        if self._handle:
+            _lib.td_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    # ------------------------------------------------------------------
+    # Simulation
+    # ------------------------------------------------------------------
+
+    def step(self, ticks=1):
+        """
+        Run fixed 60 Hz ticks
+
+        Returns:
+            int: Ticks actually run (fewer if the lives ran out)
+        """
+        return _lib.td_step(self._handle, ticks)
+
+    @property
+    def auto_waves(self):
+        """Start the next wave as soon as one completes (endless once enabled)"""
+        return self._auto_waves
+
+    @auto_waves.setter
+    def auto_waves(self, enabled):
+        self._auto_waves = bool(enabled)
+        _lib.td_set_auto_waves(self._handle, self._auto_waves)
+
+    def status(self):
+        """Scalar game state as a dict"""
+        status = _Status()
+        _lib.td_status(self._handle, ctypes.byref(status))
+        return {name: getattr(status, name) for name, _ in _Status._fields_}
+
+    # ------------------------------------------------------------------
+    # Actions (applied before the next tick, like player input)
+    # ------------------------------------------------------------------
+
+    def place_tower(self, slot, tower_type):
+        """Buy a tower on a slot. Returns False if unaffordable or taken."""
+        return _lib.td_place_tower(self._handle, slot, tower_type)
+
+    def start_wave(self, wave):
+        return _lib.td_start_wave(self._handle, wave)
+
+    def set_endless(self, seed):
+        _lib.td_set_endless(self._handle, seed)
+
+    def spawn_enemy(self, enemy_type):
+        _lib.td_spawn_enemy(self._handle, enemy_type)
+
+    def set_money(self, money):
+        _lib.td_set_money(self._handle, money)
+
+    def tower_slots(self):
+        """List of (x, y, occupied) for the map's tower slots"""
+        slots = []
+        x, y, occupied = ctypes.c_int16(), ctypes.c_int16(), ctypes.c_bool()
+        for slot in range(self.status()["tower_slot_count"]):
+            _lib.td_tower_slot(self._handle, slot, ctypes.byref(x), ctypes.byref(y),
+                               ctypes.byref(occupied))
+            slots.append((x.value, y.value, occupied.value))
+        return slots
+
+    # ------------------------------------------------------------------
+    # Views
+    # ------------------------------------------------------------------
+
+    def alive_enemies(self):
+        """Boolean mask over enemy slots"""
+        return _unpack_mask(self.enemies.alive, len(self.enemies.x))
+
+    def alive_towers(self):
+        """Boolean mask over tower slots"""
+        return _unpack_mask(self.towers.alive, len(self.towers.x))
+
+    def framebuffer(self):
+        """
+        Render the frame and return the shared (32, 64, 3) uint8 view
+
+        Every Engine draws into the same buffer, so copy it before drawing
+        another engine if both frames are needed.
+        """
+        _lib.td_draw(self._handle)
+        return self.framebuffer_view
+
+
+def _unpack_mask(words, count):
+    bits = np.unpackbits(words.view(np.uint8), bitorder="little")
+    return bits[:count].astype(bool)
+
+
+if __name__ == "__main__":
+    # Quick check: one tower per slot, the hand-written waves, then timed
+    # endless play
+    engine = Engine()
+    engine.set_money(10000)
+    for slot in range(engine.status()["tower_slot_count"]):
+        engine.place_tower(slot, slot % 3)
+
+    engine.auto_waves = True
+    engine.start_wave(0)
+    while True:
+        status = engine.status()
+        if status["wave"] + 1 == status["total_waves"] and status["wave_complete"]:
+            break
+        engine.step(60)
+    print("hand-written waves: lives %d, money %d, score %d"
+          % (status["lives"], status["money"], status["score"]))
+
+    engine.set_endless(1)
+    start = time.perf_counter()
+    ticks = engine.step(20000)
+    seconds = time.perf_counter() - start
+
+    status = engine.status()
+    alive = engine.alive_enemies()
+    print("endless: %d ticks in %.3f s (%.0f ticks/s), reached wave %d with %d lives"
+          % (ticks, seconds, ticks / seconds, status["wave"] + 1, status["lives"]))
+    if alive.any():
+        print("%d enemies alive, mean progress %.1f"
+              % (alive.sum(), engine.enemies.progress[alive].mean()))
+    frame = engine.framebuffer()
+    print("frame %s, mean colour %s" % (frame.shape, frame.reshape(-1, 3).mean(axis=0).round(1)))
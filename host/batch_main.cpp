@@ -0,0 +1,172 @@
+// batch_main.cpp - Throughput of the batched lockstep stepper
+//
+// Plays the same set of games three times: one game_step() call per game
+// per tick (the scalar path), then in lockstep through game_batch_step()
+// without and with its AVX2 kernels. Every game plays endless waves from
+// its own seed with its own tower mix, so the lanes diverge from the first
+// wave. State hashes are compared every second of play and the final games
+// byte for byte, so a pass that drifts from game_step() fails the run.
+// Reports games x ticks per second for each pass. Game logging goes to
+// /dev/null; results are printed to stderr.
+//
+//   pio run -e batch
+//   .pio/build/batch/program [games] [ticks]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "game_types.h"
+#include "game_batch.h"
+#include "map_blob.h"
+#include "replay.h"
+#include "wave_system.h"
+
+static const TowerType BATCH_TOWERS[] = {
+    TOWER_MACHINE_GUN, TOWER_CANNON, TOWER_RADAR, TOWER_SNIPER, TOWER_MACHINE_GUN
+};
+
+#define BATCH_FIRST_WAVE   20
+#define BATCH_SEED         12345
+#define BATCH_HASH_TICKS   SIM_TICK_HZ
+
+typedef enum {
+    PASS_SCALAR = 0,     // game_step() per game
+    PASS_LOCKSTEP,       // game_batch_step(), scalar kernels
+    PASS_VECTOR,         // game_batch_step(), AVX2 kernels
+    PASS_COUNT
+} Pass;
+
+static const char* PASS_NAMES[PASS_COUNT] = {"game_step", "batch scalar", "batch avx2"};
+
+typedef struct {
+    std::unique_ptr<GameState[]>   games;
+    std::unique_ptr<WaveManager[]> waves;
+    std::vector<uint32_t>          hashes;   // Rolling state hash per game
+} GameSet;
+
+// Same start for every pass: lane-specific map, towers and endless seed
+static void game_set_init(GameSet* set, int count) {
+    set->games.reset(new GameState[count]);
+    set->waves.reset(new WaveManager[count]);
+    set->hashes.assign(count, 2166136261u);
+
+    const int tower_kinds = sizeof(BATCH_TOWERS) / sizeof(BATCH_TOWERS[0]);
+    for (int g = 0; g < count; g++) {
+        GameState* game = &set->games[g];
+        WaveManager* wm = &set->waves[g];
+
+        memset(game, 0, sizeof(*game));
+        game_init(game);
+        map_blob_load(game, (uint8_t)(g % MAP_COUNT));
+        game->money = 60000;
+        for (int i = 0; i < game->tower_slot_count; i++) {
+            TowerType type = BATCH_TOWERS[(g + i) % tower_kinds];
+            game_place_tower(game, type, game->tower_slots[i].x, game->tower_slots[i].y);
+        }
+
+        memset(wm, 0, sizeof(*wm));
+        wave_manager_init(wm);
+        wave_manager_set_endless(wm, BATCH_SEED + g);
+        wave_manager_start_wave(wm, (uint16_t)(BATCH_FIRST_WAVE + g % 8), game);
+    }
+}
+
+// Seconds spent stepping (waves and hashing are left out)
+static double game_set_run(GameSet* set, int count, int ticks, Pass pass) {
+    std::vector<GameBatch> batches((count + GAME_BATCH_MAX_LANES - 1) / GAME_BATCH_MAX_LANES);
+    for (size_t b = 0; b < batches.size(); b++) {
+        int first = (int)b * GAME_BATCH_MAX_LANES;
+        int lanes = count - first < GAME_BATCH_MAX_LANES ? count - first : GAME_BATCH_MAX_LANES;
+
+        GameState* games[GAME_BATCH_MAX_LANES];
+        for (int l = 0; l < lanes; l++) games[l] = &set->games[first + l];
+        game_batch_init(&batches[b], games, (uint16_t)lanes, pass == PASS_VECTOR);
+    }
+
+    double seconds = 0.0;
+    for (int t = 0; t < ticks; t++) {
+        for (int g = 0; g < count; g++) {
+            WaveManager* wm = &set->waves[g];
+            wave_manager_update(wm, &set->games[g]);
+            if (wave_manager_is_complete(wm, &set->games[g])) {
+                wave_manager_start_wave(wm, wm->current_wave + 1, &set->games[g]);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (pass == PASS_SCALAR) {
+            for (int g = 0; g < count; g++) game_step(&set->games[g]);
+        } else {
+            for (GameBatch& batch : batches) game_batch_step(&batch);
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (int g = 0; g < count; g++) {
+            GameState* game = &set->games[g];
+            game->lives = 20;  // Never end the run
+            if (game->tick % BATCH_HASH_TICKS == 0) {
+                set->hashes[g] = (set->hashes[g] ^ replay_state_hash(game, &set->waves[g])) *
+                                 16777619u;
+            }
+        }
+    }
+    return seconds;
+}
+
+int main(int argc, char** argv) {
+    int count = (argc > 1) ? atoi(argv[1]) : 64;
+    int ticks = (argc > 2) ? atoi(argv[2]) : 20000;
+    if (count <= 0 || ticks <= 0) {
+        fprintf(stderr, "usage: %s [games] [ticks]\n", argv[0]);
+        return 2;
+    }
+
+    if (!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "warning: could not silence game logging\n");
+    }
+
+    fprintf(stderr, "games:            %d (lanes of %d)\n", count, GAME_BATCH_MAX_LANES);
+    fprintf(stderr, "ticks:            %d\n", ticks);
+    fprintf(stderr, "avx2 kernels:     %s\n\n", GAME_BATCH_AVX2 ? "yes" : "not in this build");
+
+    GameSet reference;
+    game_set_init(&reference, count);
+    double scalar_seconds = game_set_run(&reference, count, ticks, PASS_SCALAR);
+
+    long enemy_total = 0;
+    for (int g = 0; g < count; g++) enemy_total += reference.games[g].enemy_count;
+    double rate = (double)count * ticks / scalar_seconds;
+    fprintf(stderr, "%-16s  %10.0f game-ticks/s  (%.1f enemies/game at the end)\n",
+            PASS_NAMES[PASS_SCALAR], rate, (double)enemy_total / count);
+
+    bool identical = true;
+    for (int p = PASS_LOCKSTEP; p < PASS_COUNT; p++) {
+        if (p == PASS_VECTOR && !GAME_BATCH_AVX2) continue;
+
+        GameSet set;
+        game_set_init(&set, count);
+        double seconds = game_set_run(&set, count, ticks, (Pass)p);
+
+        int mismatched = 0;
+        for (int g = 0; g < count; g++) {
+            if (set.hashes[g] != reference.hashes[g] ||
+                memcmp(&set.games[g], &reference.games[g], sizeof(GameState)) != 0) {
+                mismatched++;
+            }
+        }
+        identical &= mismatched == 0;
+
+        fprintf(stderr, "%-16s  %10.0f game-ticks/s  %.2fx  %s\n", PASS_NAMES[p],
+                (double)count * ticks / seconds, scalar_seconds / seconds,
+                mismatched ? "MISMATCH" : "bit-identical");
+        if (mismatched) {
+            fprintf(stderr, "                  %d of %d games differ from game_step()\n",
+                    mismatched, count);
+        }
+    }
+
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+// bench_main.cpp - Headless stress benchmark for the game simulation
+//
+// Fills every tower slot, keeps the enemy array topped up to MAX_ENEMIES and
+// times game_update() at a fixed 60 Hz step, along with drawing split the
+// way the device splits it: capturing the render snapshot (core 0) and
+// composing the frame from it (core 1), over the frame two back as on the
+// double-buffered panel. Then times decoding each map's compressed
+// background row by row, which core 1 does on every map change.
+// With "endless", spawns come from the endless-mode wave generator instead,
+// starting at a late wave. Game logging goes to /dev/null; results are
+// printed to stderr.
+//
+//   pio run -e bench -t exec
+//   .pio/build/bench/program [ticks] [endless]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "game_types.h"
+#include "map_blob.h"
+#include "matrix.hh"
+#include "render_snapshot.h"
+#include "wave_system.h"
+
+static const TowerType BENCH_TOWERS[] = {
+    TOWER_MACHINE_GUN, TOWER_CANNON, TOWER_RADAR, TOWER_SNIPER, TOWER_MACHINE_GUN
+};
+
+#define BENCH_ENDLESS_FIRST_WAVE  40
+#define BENCH_ENDLESS_SEED        12345
+
+static GameState game;
+static WaveManager wave_manager;
+static RenderSnapshot snapshot;
+static RenderComposer composer;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    int ticks = (argc > 1) ? atoi(argv[1]) : 200000;
+    bool endless = (argc > 2) && strcmp(argv[2], "endless") == 0;
+    const float dt = 1.0f / 60.0f;
+
+    if (!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "warning: could not silence game logging\n");
+    }
+
+    game_init(&game);
+    game.money = 60000;
+    for (int i = 0; i < game.tower_slot_count; i++) {
+        TowerType type = BENCH_TOWERS[i % (sizeof(BENCH_TOWERS) / sizeof(BENCH_TOWERS[0]))];
+        game_place_tower(&game, type, game.tower_slots[i].x, game.tower_slots[i].y);
+    }
+
+    wave_manager_init(&wave_manager);
+    render_composer_init(&composer);
+    if (endless) {
+        wave_manager_set_endless(&wave_manager, BENCH_ENDLESS_SEED);
+        wave_manager_start_wave(&wave_manager, BENCH_ENDLESS_FIRST_WAVE, &game);
+    }
+
+    // Stagger spawns so the field holds a steady stream along the whole path
+    long enemy_ticks = 0;
+    int max_enemies = 0;
+    double sim_ns = 0.0;
+    double capture_ns = 0.0;
+    double compose_ns = 0.0;
+    long commands = 0;
+    long culled = 0;
+    long damage = 0;
+
+    for (int t = 0; t < ticks; t++) {
+        auto start = std::chrono::steady_clock::now();
+        if (endless) {
+            wave_manager_update(&wave_manager, &game);
+            if (wave_manager_is_complete(&wave_manager, &game)) {
+                wave_manager_start_wave(&wave_manager, wave_manager.current_wave + 1, &game);
+            }
+        } else if (game.enemy_count < MAX_ENEMIES && (t % 4) == 0) {
+            game_spawn_enemy(&game, (EnemyType)(t / 4 % 4));
+        }
+
+        game_update(&game, dt);
+        sim_ns += elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        render_snapshot_capture(&snapshot, &game, NULL);
+        capture_ns += elapsed_ns(start);
+
+        start = std::chrono::steady_clock::now();
+        render_compose_begin(&composer, &snapshot);
+        while (render_compose_step(&composer)) {}
+        swap_frames();
+        compose_ns += elapsed_ns(start);
+        damage += composer.stats.damage;
+        commands += snapshot.list.count;
+        culled += snapshot.list.culled;
+
+        enemy_ticks += game.enemy_count;
+        if (game.enemy_count > max_enemies) max_enemies = game.enemy_count;
+        game.lives = 20;  // Never end the run
+    }
+
+    fprintf(stderr, "ticks:            %d\n", ticks);
+    fprintf(stderr, "avg enemies:      %.1f (peak %d, capacity %d)\n",
+            (double)enemy_ticks / ticks, max_enemies, MAX_ENEMIES);
+    if (endless) {
+        fprintf(stderr, "endless wave:     %d\n", wave_manager.current_wave + 1);
+    }
+    fprintf(stderr, "game_update:      %.0f ns/tick\n", sim_ns / ticks);
+    fprintf(stderr, "snapshot capture: %.0f ns/tick\n", capture_ns / ticks);
+    fprintf(stderr, "compose:          %.0f ns/tick, %.0f of %d pixels, %lu full frames\n",
+            compose_ns / ticks, (double)damage / ticks, MATRIX_WIDTH * MATRIX_HEIGHT,
+            (unsigned long)composer.stats.full_frames);
+    fprintf(stderr, "backdrops built:  %lu\n", (unsigned long)composer.stats.backdrops);
+    fprintf(stderr, "display list:     %.1f commands/tick, %.1f culled, %d in scenery\n",
+            (double)commands / ticks, (double)culled / ticks, snapshot.scenery.count);
+    fprintf(stderr, "sim throughput:   %.0f ticks/s\n", ticks / (sim_ns * 1e-9));
+    fprintf(stderr, "final score:      %lu\n", (unsigned long)game.score);
+
+    // Background decode, as core 1 does every frame
+    const int decode_frames = 20000;
+    for (int m = 0; m < MAP_COUNT; m++) {
+        MapBackground background;
+        if (!map_blob_background((uint8_t)m, &background)) continue;
+
+        static Color rows[MATRIX_HEIGHT][MATRIX_WIDTH];
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < decode_frames; f++) {
+            for (int y = 0; y < background.height; y++) {
+                map_background_decode_row(&background, y, rows[y]);
+            }
+        }
+        double row_ns = elapsed_ns(start) / ((double)decode_frames * background.height);
+
+        fprintf(stderr, "decode %-10s %.1f ns/row\n",
+                map_blob_header((uint8_t)m)->name, row_ns);
+    }
+
+    return 0;
+}
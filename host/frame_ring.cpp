@@ -0,0 +1,97 @@
+// frame_ring.cpp - Finished frames published to a POSIX shared-memory ring
+#include "frame_ring.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static_assert(sizeof(Color) == 3, "frames are published as packed RGB");
+
+static uint64_t monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static inline FrameRingSlot* frame_ring_slot(const FrameRing* ring, uint64_t sequence) {
+    uint32_t index = (uint32_t)(sequence % ring->header->slot_count);
+    return (FrameRingSlot*)(ring->base + sizeof(FrameRingHeader) +
+                            (size_t)index * ring->header->slot_stride);
+}
+
+bool frame_ring_open(FrameRing* ring, const char* name, uint16_t width, uint16_t height,
+                     uint32_t target_fps) {
+    memset(ring, 0, sizeof(*ring));
+    snprintf(ring->name, sizeof(ring->name), "%s", name);
+
+    uint32_t pixels_offset = sizeof(FrameRingSlot);
+    uint32_t slot_stride = (pixels_offset + (uint32_t)width * height * 3 + 63) & ~63u;
+    size_t size = sizeof(FrameRingHeader) + (size_t)FRAME_RING_SLOTS * slot_stride;
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("frame ring: shm_open");
+        return false;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        perror("frame ring: ftruncate");
+        close(fd);
+        return false;
+    }
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("frame ring: mmap");
+        return false;
+    }
+
+    ring->base = (uint8_t*)base;
+    ring->size = size;
+    ring->header = (FrameRingHeader*)base;
+
+    // A leftover segment from an earlier run is reset; clear the magic
+    // first so a viewer never sees the new geometry with old contents
+    FrameRingHeader* header = ring->header;
+    __atomic_store_n(&header->magic, 0, __ATOMIC_RELAXED);
+    memset(ring->base + sizeof(uint32_t), 0, size - sizeof(uint32_t));
+    header->version = FRAME_RING_VERSION;
+    header->slot_count = FRAME_RING_SLOTS;
+    header->width = width;
+    header->height = height;
+    header->slot_stride = slot_stride;
+    header->pixels_offset = pixels_offset;
+    header->target_fps = target_fps;
+    __atomic_store_n(&header->magic, FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+void frame_ring_publish(FrameRing* ring, const Color* pixels, uint32_t tick) {
+    if (ring->header == NULL) return;
+
+    uint64_t sequence = ring->sequence + 1;
+    FrameRingSlot* slot = frame_ring_slot(ring, sequence);
+
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy((uint8_t*)slot + ring->header->pixels_offset, pixels,
+           (size_t)ring->header->width * ring->header->height * 3);
+    slot->tick = tick;
+    slot->publish_ns = monotonic_ns();
+
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->header->sequence, sequence, __ATOMIC_RELEASE);
+    ring->sequence = sequence;
+}
+
+void frame_ring_close(FrameRing* ring) {
+    if (ring->header == NULL) return;
+
+    munmap(ring->base, ring->size);
+    shm_unlink(ring->name);
+    ring->header = NULL;
+    ring->base = NULL;
+}
@@ -0,0 +1,73 @@
+// frame_ring.hh - Finished frames published to a POSIX shared-memory ring
+//
+// A host tool renders into the matrix framebuffer as the device does and
+// publishes each finished frame here. Viewers on the same machine map the
+// segment (/dev/shm/<name> on Linux) read-only and blit straight out of it
+// (gam4/frame_viewer.py), so nothing is serialised or copied through a pipe.
+//
+// Layout, in host byte order:
+//   FrameRingHeader (64 bytes), then slot_count slots, slot_stride bytes
+//   apart. Each slot is a FrameRingSlot followed, at pixels_offset, by
+//   height x width packed RGB pixels, row by row.
+//
+// Publishing frame n (n = 1, 2, ...) writes slot n % slot_count: the
+// slot's sequence is zeroed, then the pixels and metadata are written, then
+// the slot's sequence is set to n, and last header.sequence = n. A reader
+// takes header.sequence, uses that slot, and keeps what it read only if the
+// slot's sequence is still n afterwards. The writer would have to lap the
+// whole ring during the read to tear it.
+#ifndef FRAME_RING_HH
+#define FRAME_RING_HH
+
+#include <stdint.h>
+#include <stddef.h>
+#include "color.hh"
+
+#define FRAME_RING_MAGIC        0x52464454u  // "TDFR"
+#define FRAME_RING_VERSION      1
+#define FRAME_RING_SLOTS        8
+#define FRAME_RING_DEFAULT_NAME "/td_frames"
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t slot_count;
+    uint16_t width;
+    uint16_t height;
+    uint32_t slot_stride;     // Bytes from one slot to the next
+    uint32_t pixels_offset;   // Pixels start this far into a slot
+    uint32_t target_fps;      // Producer's pacing; 0 = as fast as it runs
+    uint64_t sequence;        // Latest complete frame, 0 before the first
+    uint8_t  reserved[32];
+} FrameRingHeader;
+
+typedef struct {
+    uint64_t sequence;        // Frame held, 0 while being written
+    uint64_t publish_ns;      // CLOCK_MONOTONIC time of publication
+    uint32_t tick;            // Simulation tick the frame shows
+    uint32_t reserved[3];
+} FrameRingSlot;
+
+static_assert(sizeof(FrameRingHeader) == 64, "viewers hard-code the header layout");
+static_assert(sizeof(FrameRingSlot) == 32, "viewers hard-code the slot layout");
+
+typedef struct {
+    FrameRingHeader* header;
+    uint8_t*         base;
+    size_t           size;
+    uint64_t         sequence;    // Last frame published
+    char             name[64];
+} FrameRing;
+
+// Create (or take over) the named segment. Returns false with a message on
+// stderr if it cannot be created or mapped.
+bool frame_ring_open(FrameRing* ring, const char* name, uint16_t width, uint16_t height,
+                     uint32_t target_fps);
+
+// Copy width x height pixels in as the next frame
+void frame_ring_publish(FrameRing* ring, const Color* pixels, uint32_t tick);
+
+// Unmap and unlink; viewers that still map the segment keep their mapping
+void frame_ring_close(FrameRing* ring);
+
+#endif // FRAME_RING_HH
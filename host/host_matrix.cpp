@@ -0,0 +1,28 @@
+// host_matrix.cpp - Headless stand-in for the LED matrix driver (host builds)
+//
+// Provides the same framebuffer symbols as lib/led_matrix/matrix.cpp so the
+// game core links unchanged; nothing is ever scanned out to a panel.
+#include "matrix.hh"
+
+Color frames[2][MATRIX_ROWS][MATRIX_COLS];
+int frame_index = 0;
+
+void init_matrix() {
+    for (int row = 0; row < MATRIX_ROWS; row++) {
+        for (int col = 0; col < MATRIX_COLS; col++) {
+            frames[0][row][col] = GRASS;
+            frames[1][row][col] = GRASS;
+        }
+    }
+}
+
+void swap_frames() {
+    frame_index = !frame_index;
+}
+
+void render_frame() {
+}
+
+void set_pixel(int x, int y, Color color) {
+    frames[frame_index][y][x] = color;
+}
@@ -0,0 +1,423 @@
+// optimizer_main.cpp - Monte Carlo search over tower placement strategies
+//
+// A strategy is a purchase plan: an ordered list of (slot, tower type) bought
+// one step at a time as soon as the money allows. Every strategy plays the
+// hand-written waves and then endless waves until its lives run out or
+// OPT_MAX_WAVES is reached, once per run; run r uses the same endless seed
+// for every strategy, so strategies are compared on identical waves. The
+// first slot_count x tower type strategies enumerate every opening purchase
+// and the rest of each plan (and every later strategy) is drawn from
+// OPT_MASTER_SEED, so a search always gives the same results whatever the
+// thread count.
+//
+// Games run on a work-stealing thread pool with one GameState per worker.
+// The report ranks strategies by waves survived, then score, and prints the
+// survival, lives, score and money curves of the best ones. With "scaling"
+// in place of the thread count, the search is repeated on 1, 2, 4 ... threads
+// to report the speedup and check every pass gave identical results.
+// Game logging goes to /dev/null; results are printed to stderr.
+//
+//   pio run -e optimizer
+//   .pio/build/optimizer/program [strategies] [runs] [threads | scaling] [map]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "game_types.h"
+#include "map_blob.h"
+#include "wave_system.h"
+
+#define OPT_MAX_WAVES        40
+#define OPT_MASTER_SEED      0x7D0A1E55u
+#define OPT_WAVE_TICK_LIMIT  (SIM_TICK_HZ * 600)  // Safety net; waves end long before
+#define OPT_REPORT_TOP       10
+#define OPT_CURVE_TOP        3
+
+static const char TOWER_LETTERS[GAME_TOWER_TYPE_COUNT] = {'M', 'C', 'S', 'R'};
+
+typedef struct {
+    uint8_t  step_count;
+    uint8_t  slot[MAX_TOWERS];   // tower_slots index per purchase
+    uint8_t  type[MAX_TOWERS];   // TowerType per purchase
+} Strategy;
+
+// One seeded run, sampled at the end of every wave cleared
+typedef struct {
+    uint16_t waves_cleared;
+    uint32_t ticks;
+    uint32_t final_score;
+    uint8_t  lives[OPT_MAX_WAVES];
+    uint32_t score[OPT_MAX_WAVES];
+    uint32_t money[OPT_MAX_WAVES];
+} RunResult;
+
+typedef struct {
+    std::mutex            lock;
+    std::deque<uint32_t>  tasks;   // strategy * runs + run
+} WorkQueue;
+
+typedef struct {
+    const std::vector<Strategy>* strategies;
+    uint16_t                     runs;
+    uint8_t                      map_index;
+    std::vector<RunResult>*      results;
+    std::vector<WorkQueue>*      queues;
+    std::atomic<uint32_t>        steals;
+} Search;
+
+// ============================================================================
+// Strategies
+// ============================================================================
+
+// splitmix32: a full-period mix, cheap enough to reseed per strategy
+static uint32_t opt_next(uint32_t* state) {
+    uint32_t z = (*state += 0x9E3779B9u);
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    return z ^ (z >> 16);
+}
+
+static uint32_t run_seed(uint16_t run) {
+    uint32_t state = OPT_MASTER_SEED ^ 0xA5A5A5A5u ^ run;
+    return opt_next(&state);
+}
+
+static void strategy_generate(Strategy* strategy, uint32_t index, uint8_t slot_count) {
+    uint32_t rng = OPT_MASTER_SEED + index * 0x632BE5ABu;
+    uint8_t order[MAX_TOWERS];
+    for (uint8_t i = 0; i < slot_count; i++) order[i] = i;
+
+    // Openings first: slot_count x type strategies fix the first purchase
+    uint8_t first = 0;
+    uint32_t openings = (uint32_t)slot_count * GAME_TOWER_TYPE_COUNT;
+    if (index < openings) {
+        uint8_t slot = (uint8_t)(index / GAME_TOWER_TYPE_COUNT);
+        order[slot] = 0;
+        order[0] = slot;
+        strategy->type[0] = (uint8_t)(index % GAME_TOWER_TYPE_COUNT);
+        first = 1;
+    }
+
+    // Fisher-Yates over the remaining slots
+    for (uint8_t i = slot_count - 1; i > first; i--) {
+        uint8_t j = (uint8_t)(first + opt_next(&rng) % (i - first + 1));
+        uint8_t swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+
+    strategy->step_count = slot_count;
+    for (uint8_t i = 0; i < slot_count; i++) {
+        strategy->slot[i] = order[i];
+        if (i >= first) strategy->type[i] = (uint8_t)(opt_next(&rng) % GAME_TOWER_TYPE_COUNT);
+    }
+}
+
+static void strategy_format(const Strategy* strategy, char* out, size_t size) {
+    size_t pos = 0;
+    out[0] = '\0';
+    for (uint8_t i = 0; i < strategy->step_count && pos + 6 < size; i++) {
+        pos += snprintf(out + pos, size - pos, "%s%d%c", i ? " " : "",
+                        strategy->slot[i], TOWER_LETTERS[strategy->type[i]]);
+    }
+}
+
+// ============================================================================
+// Simulation
+// ============================================================================
+
+// Buy every next step the money covers, as a player placing on cue would
+static void strategy_buy(GameState* game, const Strategy* strategy, uint8_t* next_step) {
+    while (*next_step < strategy->step_count) {
+        const TowerSlot* slot = &game->tower_slots[strategy->slot[*next_step]];
+        if (!game_place_tower(game, (TowerType)strategy->type[*next_step], slot->x, slot->y)) {
+            return;
+        }
+        (*next_step)++;
+    }
+}
+
+static void strategy_run(GameState* game, WaveManager* wm, const Strategy* strategy,
+                         uint8_t map_index, uint32_t endless_seed, RunResult* result) {
+    // Workers reuse their state across tasks; start every game from zero so
+    // results cannot depend on which worker ran what before
+    memset(game, 0, sizeof(*game));
+    game_init(game);
+    if (map_index != game->map_index) map_blob_load(game, map_index);
+    wave_manager_init(wm);
+    memset(result, 0, sizeof(*result));
+
+    uint8_t next_step = 0;
+    uint8_t table_waves = wave_manager_get_total_waves();
+
+    for (uint16_t wave = 0; wave < OPT_MAX_WAVES; wave++) {
+        if (wave == table_waves) wave_manager_set_endless(wm, endless_seed);
+        wave_manager_start_wave(wm, wave, game);
+
+        uint32_t wave_end = game->tick + OPT_WAVE_TICK_LIMIT;
+        while (!wave_manager_is_complete(wm, game) && game->lives > 0 && game->tick < wave_end) {
+            strategy_buy(game, strategy, &next_step);
+            wave_manager_update(wm, game);
+            game_step(game);
+        }
+        if (game->lives == 0 || game->tick >= wave_end) break;
+
+        result->lives[wave] = game->lives;
+        result->score[wave] = game->score;
+        result->money[wave] = game->money;
+        result->waves_cleared = wave + 1;
+    }
+
+    result->ticks = game->tick;
+    result->final_score = game->score;
+}
+
+// ============================================================================
+// Work-stealing pool
+// ============================================================================
+
+// Own work comes off the front of a worker's queue; thieves take from the
+// back, the part of the victim's range it would reach last
+static bool work_take(Search* search, int self, uint32_t* task) {
+    std::vector<WorkQueue>& queues = *search->queues;
+    int count = (int)queues.size();
+
+    for (int k = 0; k < count; k++) {
+        WorkQueue* queue = &queues[(self + k) % count];
+        std::lock_guard<std::mutex> guard(queue->lock);
+        if (queue->tasks.empty()) continue;
+
+        if (k == 0) {
+            *task = queue->tasks.front();
+            queue->tasks.pop_front();
+        } else {
+            *task = queue->tasks.back();
+            queue->tasks.pop_back();
+            search->steals.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;  // Nothing is ever queued later, so all work is taken
+}
+
+static void worker_main(Search* search, int self) {
+    std::unique_ptr<GameState> game(new GameState);
+    WaveManager wave_manager;
+    uint32_t task;
+
+    while (work_take(search, self, &task)) {
+        uint32_t strategy = task / search->runs;
+        uint16_t run = (uint16_t)(task % search->runs);
+        strategy_run(game.get(), &wave_manager, &(*search->strategies)[strategy],
+                     search->map_index, run_seed(run), &(*search->results)[task]);
+    }
+}
+
+// Play every (strategy, run) pair. Returns wall time in seconds.
+static double search_run(const std::vector<Strategy>& strategies, uint16_t runs,
+                         uint8_t map_index, int threads, std::vector<RunResult>* results,
+                         uint32_t* steals) {
+    uint32_t task_count = (uint32_t)strategies.size() * runs;
+    results->assign(task_count, RunResult());
+    std::vector<WorkQueue> queues(threads);
+
+    // Contiguous blocks keep each worker on its own strategies until it
+    // runs dry and starts stealing
+    for (int w = 0; w < threads; w++) {
+        uint32_t begin = (uint32_t)((uint64_t)task_count * w / threads);
+        uint32_t end = (uint32_t)((uint64_t)task_count * (w + 1) / threads);
+        for (uint32_t t = begin; t < end; t++) queues[w].tasks.push_back(t);
+    }
+
+    Search search;
+    search.strategies = &strategies;
+    search.runs = runs;
+    search.map_index = map_index;
+    search.results = results;
+    search.queues = &queues;
+    search.steals = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int w = 1; w < threads; w++) workers.emplace_back(worker_main, &search, w);
+    worker_main(&search, 0);
+    for (std::thread& worker : workers) worker.join();
+    auto end = std::chrono::steady_clock::now();
+
+    *steals = search.steals.load();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() * 1e-9;
+}
+
+// FNV-1a over every result, to compare passes
+static uint32_t results_digest(const std::vector<RunResult>& results) {
+    const uint8_t* bytes = (const uint8_t*)results.data();
+    size_t size = results.size() * sizeof(RunResult);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+typedef struct {
+    uint32_t strategy;
+    double   mean_waves;
+    double   mean_score;
+} Ranking;
+
+static void report_curve(const std::vector<RunResult>& results, uint32_t strategy,
+                         uint16_t runs) {
+    const RunResult* first = &results[(size_t)strategy * runs];
+
+    fprintf(stderr, "\nstrategy %lu by wave:\n", (unsigned long)strategy);
+    fprintf(stderr, "  wave  survival   lives     score     money\n");
+    for (int wave = 0; wave < OPT_MAX_WAVES; wave++) {
+        int alive = 0;
+        double lives = 0.0, score = 0.0, money = 0.0;
+        for (uint16_t r = 0; r < runs; r++) {
+            if (first[r].waves_cleared <= wave) continue;
+            alive++;
+            lives += first[r].lives[wave];
+            score += first[r].score[wave];
+            money += first[r].money[wave];
+        }
+        if (alive == 0) break;
+
+        fprintf(stderr, "  %4d  %7.0f%%  %6.1f  %8.0f  %8.0f\n", wave + 1,
+                100.0 * alive / runs, lives / alive, score / alive, money / alive);
+    }
+}
+
+static void report(const std::vector<Strategy>& strategies,
+                   const std::vector<RunResult>& results, uint16_t runs) {
+    std::vector<Ranking> ranking(strategies.size());
+    for (uint32_t s = 0; s < strategies.size(); s++) {
+        double waves = 0.0, score = 0.0;
+        for (uint16_t r = 0; r < runs; r++) {
+            waves += results[(size_t)s * runs + r].waves_cleared;
+            score += results[(size_t)s * runs + r].final_score;
+        }
+        ranking[s].strategy = s;
+        ranking[s].mean_waves = waves / runs;
+        ranking[s].mean_score = score / runs;
+    }
+    std::sort(ranking.begin(), ranking.end(), [](const Ranking& a, const Ranking& b) {
+        if (a.mean_waves != b.mean_waves) return a.mean_waves > b.mean_waves;
+        if (a.mean_score != b.mean_score) return a.mean_score > b.mean_score;
+        return a.strategy < b.strategy;
+    });
+
+    fprintf(stderr, "\nrank  strategy  waves     score  plan (slot + M/C/S/R, in purchase order)\n");
+    size_t top = std::min((size_t)OPT_REPORT_TOP, ranking.size());
+    for (size_t i = 0; i < top; i++) {
+        char plan[8 * MAX_TOWERS];
+        strategy_format(&strategies[ranking[i].strategy], plan, sizeof(plan));
+        fprintf(stderr, "%4zu  %8lu  %5.2f  %8.0f  %s\n", i + 1,
+                (unsigned long)ranking[i].strategy, ranking[i].mean_waves,
+                ranking[i].mean_score, plan);
+    }
+    const Ranking* worst = &ranking.back();
+    fprintf(stderr, "worst %8lu  %5.2f  %8.0f\n", (unsigned long)worst->strategy,
+            worst->mean_waves, worst->mean_score);
+
+    for (size_t i = 0; i < std::min((size_t)OPT_CURVE_TOP, ranking.size()); i++) {
+        report_curve(results, ranking[i].strategy, runs);
+    }
+}
+
+static void report_pass(int threads, double seconds, const std::vector<RunResult>& results,
+                        uint32_t steals) {
+    uint64_t ticks = 0;
+    for (const RunResult& result : results) ticks += result.ticks;
+
+    fprintf(stderr, "threads %3d: %8.3f s  %8.0f games/s  %6.2fM ticks/s  %5lu stolen  digest %08lx\n",
+            threads, seconds, results.size() / seconds, ticks / seconds * 1e-6,
+            (unsigned long)steals, (unsigned long)results_digest(results));
+}
+
+int main(int argc, char** argv) {
+    uint32_t strategy_count = (argc > 1) ? (uint32_t)atoi(argv[1]) : 1000;
+    uint16_t runs = (argc > 2) ? (uint16_t)atoi(argv[2]) : 4;
+    bool scaling = (argc > 3) && strcmp(argv[3], "scaling") == 0;
+    int hardware_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    int threads = (argc > 3 && !scaling) ? atoi(argv[3]) : hardware_threads;
+    uint8_t map_index = (argc > 4) ? (uint8_t)atoi(argv[4]) : 0;
+
+    if (strategy_count == 0 || runs == 0 || threads <= 0 || map_index >= MAP_COUNT) {
+        fprintf(stderr, "usage: %s [strategies] [runs] [threads | scaling] [map]\n", argv[0]);
+        return 2;
+    }
+
+    if (!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "warning: could not silence game logging\n");
+    }
+
+    // Slot count of the chosen map
+    std::unique_ptr<GameState> probe(new GameState);
+    game_init(probe.get());
+    if (!map_blob_load(probe.get(), map_index)) {
+        fprintf(stderr, "error: map %d does not load\n", map_index);
+        return 2;
+    }
+    uint8_t slot_count = probe->tower_slot_count;
+
+    std::vector<Strategy> strategies(strategy_count);
+    for (uint32_t s = 0; s < strategy_count; s++) {
+        strategy_generate(&strategies[s], s, slot_count);
+    }
+
+    fprintf(stderr, "map:              %s (%d slots)\n", map_blob_header(map_index)->name, slot_count);
+    fprintf(stderr, "strategies:       %lu (%lu openings enumerated) x %d runs\n",
+            (unsigned long)strategy_count,
+            (unsigned long)std::min(strategy_count, (uint32_t)slot_count * GAME_TOWER_TYPE_COUNT),
+            runs);
+    fprintf(stderr, "waves:            %d hand-written, then endless up to %d\n\n",
+            wave_manager_get_total_waves(), OPT_MAX_WAVES);
+
+    std::vector<RunResult> results;
+    uint32_t steals;
+
+    if (scaling) {
+        std::vector<int> passes;
+        for (int t = 1; t < hardware_threads; t *= 2) passes.push_back(t);
+        passes.push_back(hardware_threads);
+
+        double single = 0.0;
+        uint32_t reference = 0;
+        bool identical = true;
+        for (int t : passes) {
+            double seconds = search_run(strategies, runs, map_index, t, &results, &steals);
+            report_pass(t, seconds, results, steals);
+            if (t == 1) {
+                single = seconds;
+                reference = results_digest(results);
+            } else {
+                fprintf(stderr, "             speedup %.2fx, efficiency %.0f%%\n",
+                        single / seconds, 100.0 * single / seconds / t);
+                identical &= results_digest(results) == reference;
+            }
+        }
+        if (!identical) {
+            fprintf(stderr, "error: results differ between thread counts\n");
+            return 1;
+        }
+    } else {
+        double seconds = search_run(strategies, runs, map_index, threads, &results, &steals);
+        report_pass(threads, seconds, results, steals);
+    }
+
+    report(strategies, results, runs);
+    return 0;
+}
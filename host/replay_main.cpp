@@ -0,0 +1,166 @@
+// replay_main.cpp - Headless replay of a recorded game
+//
+// Takes either a raw replay stream or a serial console capture holding a
+// "REPLAY BEGIN ... REPLAY END" dump (the last complete dump is used), re-runs
+// the recorded inputs tick by tick and compares every checkpoint hash with
+// the device's. Exits non-zero on a mismatch. Game logging goes to
+// /dev/null; results are printed to stderr.
+//
+// With "view", every tick is also rendered as on the device and published
+// to the shared-memory frame ring (frame_ring.hh) for gam4/frame_viewer.py,
+// paced at `speed` times real time (0 = as fast as it renders).
+//
+//   pio run -e replay
+//   .pio/build/replay/program <capture.log | replay.bin> [view [speed]]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include "game_types.h"
+#include "replay.h"
+#include "wave_system.h"
+#include "map_render.hh"
+#include "matrix.hh"
+#include "frame_ring.hh"
+
+static GameState game;
+static WaveManager wave_manager;
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Pull the last complete dump out of a console capture
+static bool parse_capture(const std::vector<uint8_t>& file, std::vector<uint8_t>* out) {
+    std::vector<uint8_t> current;
+    bool in_dump = false;
+    bool found = false;
+    size_t pos = 0;
+
+    while (pos < file.size()) {
+        size_t end = pos;
+        while (end < file.size() && file[end] != '\n') end++;
+        const char* line = (const char*)&file[pos];
+        size_t length = end - pos;
+        if (length > 0 && line[length - 1] == '\r') length--;
+        pos = end + 1;
+
+        if (length < 7 || strncmp(line, "REPLAY ", 7) != 0) continue;
+        line += 7;
+        length -= 7;
+
+        if (length >= 5 && strncmp(line, "BEGIN", 5) == 0) {
+            current.clear();
+            in_dump = true;
+        } else if (length == 3 && strncmp(line, "END", 3) == 0) {
+            if (in_dump) {
+                *out = current;
+                found = true;
+            }
+            in_dump = false;
+        } else if (in_dump) {
+            for (size_t i = 0; i + 1 < length; i += 2) {
+                int hi = hex_digit(line[i]);
+                int lo = hex_digit(line[i + 1]);
+                if (hi < 0 || lo < 0) {
+                    in_dump = false;  // Garbled line; wait for the next dump
+                    break;
+                }
+                current.push_back((uint8_t)(hi << 4 | lo));
+            }
+        }
+    }
+    return found;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <capture.log | replay.bin> [view [speed]]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) {
+        fprintf(stderr, "error: cannot open %s\n", argv[1]);
+        return 2;
+    }
+    std::vector<uint8_t> file;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        file.insert(file.end(), chunk, chunk + n);
+    }
+    fclose(f);
+
+    std::vector<uint8_t> stream;
+    uint32_t magic = REPLAY_MAGIC;
+    if (file.size() >= 4 && memcmp(file.data(), &magic, 4) == 0) {
+        stream = file;
+    } else if (!parse_capture(file, &stream)) {
+        fprintf(stderr, "error: no complete REPLAY dump in %s\n", argv[1]);
+        return 2;
+    }
+
+    if (!freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "warning: could not silence game logging\n");
+    }
+
+    ReplayPlayer player;
+    if (!replay_player_start(&player, stream.data(), (uint32_t)stream.size(),
+                             &game, &wave_manager)) {
+        fprintf(stderr, "error: not a replay from a build with these capacities and maps\n");
+        return 2;
+    }
+
+    bool view = (argc > 2) && strcmp(argv[2], "view") == 0;
+    double speed = (argc > 3) ? atof(argv[3]) : 1.0;
+    FrameRing ring;
+    if (view) {
+        if (!frame_ring_open(&ring, FRAME_RING_DEFAULT_NAME, MATRIX_COLS, MATRIX_ROWS,
+                             (uint32_t)(SIM_TICK_HZ * speed + 0.5))) {
+            return 2;
+        }
+        map_render_init(&game);
+        fprintf(stderr, "publishing frames to %s\n", FRAME_RING_DEFAULT_NAME);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (replay_player_step(&player, &game, &wave_manager)) {
+        if (!view) continue;
+
+        map_render_draw_static();
+        game_draw(&game);
+        frame_ring_publish(&ring, &frames[frame_index][0][0], game.tick);
+        if (speed > 0.0) {
+            std::this_thread::sleep_until(start + std::chrono::duration<double>(
+                game.tick / (SIM_TICK_HZ * speed)));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (view) frame_ring_close(&ring);
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    fprintf(stderr, "stream:           %lu bytes\n", (unsigned long)stream.size());
+    fprintf(stderr, "ticks:            %lu (%.1f s of play)\n",
+            (unsigned long)game.tick, game.tick * SIM_DT);
+    fprintf(stderr, "replay speed:     %.0f ticks/s%s\n", game.tick / seconds,
+            view ? " (rendering every tick)" : "");
+    fprintf(stderr, "final state:      wave %d, lives %d, money %lu, score %lu\n",
+            wave_manager.current_wave + 1, game.lives,
+            (unsigned long)game.money, (unsigned long)game.score);
+    fprintf(stderr, "checkpoints:      %lu\n", (unsigned long)player.checkpoints);
+
+    if (player.mismatches > 0) {
+        fprintf(stderr, "DESYNC:           %lu mismatched, first at tick %lu\n",
+                (unsigned long)player.mismatches, (unsigned long)player.first_mismatch_tick);
+        return 1;
+    }
+    fprintf(stderr, "all checkpoints match\n");
+    return 0;
+}
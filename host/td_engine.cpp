@@ -0,0 +1,188 @@
+// td_engine.cpp - C ABI to the game core for the Python bindings
+#include "td_engine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_types.h"
+#include "map_blob.h"
+#include "matrix.hh"
+#include "wave_system.h"
+
+struct TdEngine {
+    GameState   game;
+    WaveManager waves;
+    bool        auto_waves;
+};
+
+uint32_t td_abi_version(void) {
+    return TD_ABI_VERSION;
+}
+
+TdEngine* td_create(uint8_t map_index) {
+    if (map_index >= MAP_COUNT) return NULL;
+
+    TdEngine* engine = (TdEngine*)calloc(1, sizeof(TdEngine));
+    if (engine == NULL) return NULL;
+
+    game_init(&engine->game);
+    if (map_index != engine->game.map_index && !map_blob_load(&engine->game, map_index)) {
+        free(engine);
+        return NULL;
+    }
+    wave_manager_init(&engine->waves);
+    return engine;
+}
+
+void td_destroy(TdEngine* engine) {
+    free(engine);
+}
+
+// Start the next wave once one completes, as the device does between waves
+static void td_advance_wave(TdEngine* engine) {
+    WaveManager* wm = &engine->waves;
+    if (!wm->wave_active || !wave_manager_is_complete(wm, &engine->game)) return;
+
+    if (wm->endless || wm->current_wave + 1 < wave_manager_get_total_waves()) {
+        wave_manager_start_wave(wm, wm->current_wave + 1, &engine->game);
+    }
+}
+
+uint32_t td_step(TdEngine* engine, uint32_t ticks) {
+    GameState* game = &engine->game;
+    uint32_t run = 0;
+
+    while (run < ticks && game->lives > 0) {
+        wave_manager_update(&engine->waves, game);
+        game_step(game);
+        run++;
+        if (engine->auto_waves) td_advance_wave(engine);
+    }
+    return run;
+}
+
+void td_set_auto_waves(TdEngine* engine, bool enabled) {
+    engine->auto_waves = enabled;
+}
+
+void td_status(const TdEngine* engine, TdStatus* status) {
+    const GameState* game = &engine->game;
+    const WaveManager* wm = &engine->waves;
+
+    memset(status, 0, sizeof(*status));
+    status->tick = game->tick;
+    status->money = game->money;
+    status->score = game->score;
+    status->wave = wm->current_wave;
+    status->enemy_count = game->enemy_count;
+    status->lives = game->lives;
+    status->tower_count = game->tower_count;
+    status->projectile_count = game->projectile_count;
+    status->tower_slot_count = game->tower_slot_count;
+    status->map_index = game->map_index;
+    status->total_waves = wave_manager_get_total_waves();
+    status->wave_active = wm->wave_active;
+    status->wave_complete = wm->wave_active && wave_manager_is_complete(wm, game);
+    status->endless = wm->endless;
+}
+
+bool td_place_tower(TdEngine* engine, uint8_t slot, uint8_t tower_type) {
+    GameState* game = &engine->game;
+    if (slot >= game->tower_slot_count || tower_type >= GAME_TOWER_TYPE_COUNT) return false;
+
+    return game_place_tower(game, (TowerType)tower_type,
+                            game->tower_slots[slot].x, game->tower_slots[slot].y);
+}
+
+bool td_start_wave(TdEngine* engine, uint16_t wave) {
+    WaveManager* wm = &engine->waves;
+    if (!wm->endless && wave >= wave_manager_get_total_waves()) return false;
+
+    wave_manager_start_wave(wm, wave, &engine->game);
+    return true;
+}
+
+void td_set_endless(TdEngine* engine, uint32_t seed) {
+    wave_manager_set_endless(&engine->waves, seed);
+}
+
+void td_spawn_enemy(TdEngine* engine, uint8_t enemy_type) {
+    if (enemy_type > ENEMY_GHOST) return;
+    game_spawn_enemy(&engine->game, (EnemyType)enemy_type);
+}
+
+void td_set_money(TdEngine* engine, uint32_t money) {
+    engine->game.money = money;
+}
+
+bool td_tower_slot(const TdEngine* engine, uint8_t slot,
+                   int16_t* x, int16_t* y, bool* occupied) {
+    const GameState* game = &engine->game;
+    if (slot >= game->tower_slot_count) return false;
+
+    *x = game->tower_slots[slot].x;
+    *y = game->tower_slots[slot].y;
+    *occupied = game->tower_slots[slot].occupied;
+    return true;
+}
+
+void td_draw(const TdEngine* engine) {
+    MapBackground background;
+    if (map_blob_background(engine->game.map_index, &background)) {
+        for (int y = 0; y < MATRIX_HEIGHT; y++) {
+            map_background_panel_row(&background, y, frames[frame_index][y]);
+        }
+    }
+    game_draw(&engine->game);
+}
+
+// ============================================================================
+// Array views
+// ============================================================================
+
+static void td_view(TdArray* out, void* data, char kind, uint8_t item_size, uint32_t count) {
+    out->data = data;
+    out->kind = kind;
+    out->item_size = item_size;
+    out->ndim = 1;
+    out->shape[0] = count;
+}
+
+bool td_array(TdEngine* engine, TdArrayId id, TdArray* out) {
+    EnemyStore* enemies = &engine->game.enemies;
+    TowerStore* towers = &engine->game.towers;
+    memset(out, 0, sizeof(*out));
+
+    switch (id) {
+        case TD_ENEMY_X:          td_view(out, enemies->x, 'f', 4, MAX_ENEMIES); break;
+        case TD_ENEMY_Y:          td_view(out, enemies->y, 'f', 4, MAX_ENEMIES); break;
+        case TD_ENEMY_PROGRESS:   td_view(out, enemies->progress, 'f', 4, MAX_ENEMIES); break;
+        case TD_ENEMY_SPEED:      td_view(out, enemies->speed, 'f', 4, MAX_ENEMIES); break;
+        case TD_ENEMY_HEALTH:     td_view(out, enemies->health, 'i', 2, MAX_ENEMIES); break;
+        case TD_ENEMY_TYPE:       td_view(out, enemies->type, 'u', 1, MAX_ENEMIES); break;
+        case TD_ENEMY_FLAGS:      td_view(out, enemies->flags, 'u', 1, MAX_ENEMIES); break;
+        case TD_ENEMY_ALIVE:
+            td_view(out, enemies->pool.alive, 'u', 4, MASK_WORDS(MAX_ENEMIES));
+            break;
+        case TD_ENEMY_ORDER:
+            td_view(out, engine->game.enemy_order, 'u', sizeof(EnemyIndex), MAX_ENEMIES);
+            break;
+        case TD_TOWER_X:          td_view(out, towers->x, 'f', 4, MAX_TOWERS); break;
+        case TD_TOWER_Y:          td_view(out, towers->y, 'f', 4, MAX_TOWERS); break;
+        case TD_TOWER_READY_TICK: td_view(out, towers->ready_tick, 'u', 4, MAX_TOWERS); break;
+        case TD_TOWER_TYPE:       td_view(out, towers->type, 'u', 1, MAX_TOWERS); break;
+        case TD_TOWER_ALIVE:
+            td_view(out, towers->pool.alive, 'u', 4, MASK_WORDS(MAX_TOWERS));
+            break;
+        case TD_FRAMEBUFFER:
+            static_assert(sizeof(Color) == 3, "framebuffer view assumes packed RGB");
+            td_view(out, frames[frame_index], 'u', 1, MATRIX_ROWS);
+            out->ndim = 3;
+            out->shape[1] = MATRIX_COLS;
+            out->shape[2] = 3;
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
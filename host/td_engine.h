@@ -0,0 +1,102 @@
+// td_engine.h - C ABI to the game core for the Python bindings
+//
+// Built as a shared library by `pio run -e pylib` and loaded by
+// gam4/td_engine.py through ctypes. Each TdEngine owns one game and its
+// wave manager; any number can run side by side. Arrays are handed out as
+// raw views into the live GameState (td_array), so Python reads them
+// without copying. The views stay valid until td_destroy(). The
+// framebuffer is the host matrix driver's single buffer, shared by every
+// engine, and td_draw() renders into it.
+//
+// Bump TD_ABI_VERSION whenever a function, TdStatus or TdArrayId changes.
+#ifndef TD_ENGINE_H
+#define TD_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TD_ABI_VERSION  1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TdEngine TdEngine;
+
+typedef struct {
+    uint32_t tick;
+    uint32_t money;
+    uint32_t score;
+    uint16_t wave;              // Current wave, 0-based
+    uint16_t enemy_count;
+    uint8_t  lives;
+    uint8_t  tower_count;
+    uint8_t  projectile_count;
+    uint8_t  tower_slot_count;
+    uint8_t  map_index;
+    uint8_t  total_waves;       // Hand-written waves; endless goes on past them
+    bool     wave_active;
+    bool     wave_complete;     // Everything spawned and gone
+    bool     endless;
+} TdStatus;
+
+typedef enum {
+    TD_ENEMY_X = 0,
+    TD_ENEMY_Y,
+    TD_ENEMY_PROGRESS,
+    TD_ENEMY_SPEED,
+    TD_ENEMY_HEALTH,
+    TD_ENEMY_TYPE,
+    TD_ENEMY_FLAGS,
+    TD_ENEMY_ALIVE,             // Bit mask, 32 slots per word
+    TD_ENEMY_ORDER,             // Live slots by progress; first enemy_count valid
+    TD_TOWER_X,
+    TD_TOWER_Y,
+    TD_TOWER_READY_TICK,
+    TD_TOWER_TYPE,
+    TD_TOWER_ALIVE,
+    TD_FRAMEBUFFER,             // [row][col][r, g, b]
+    TD_ARRAY_COUNT
+} TdArrayId;
+
+typedef struct {
+    void*    data;
+    char     kind;              // numpy kind: 'f' float, 'i' signed, 'u' unsigned
+    uint8_t  item_size;         // Bytes per element
+    uint8_t  ndim;
+    uint32_t shape[3];
+} TdArray;
+
+uint32_t  td_abi_version(void);
+
+// NULL if the map does not load
+TdEngine* td_create(uint8_t map_index);
+void      td_destroy(TdEngine* engine);
+
+// Run up to `ticks` fixed ticks (waves spawn as they do on the device).
+// With auto_waves on, the next wave starts as soon as one completes, and
+// endless waves follow the hand-written ones. Stops early when the lives
+// run out. Returns the ticks run.
+uint32_t  td_step(TdEngine* engine, uint32_t ticks);
+void      td_set_auto_waves(TdEngine* engine, bool enabled);
+void      td_status(const TdEngine* engine, TdStatus* status);
+
+// Actions, applied before the next tick as player input would be
+bool      td_place_tower(TdEngine* engine, uint8_t slot, uint8_t tower_type);
+bool      td_start_wave(TdEngine* engine, uint16_t wave);
+void      td_set_endless(TdEngine* engine, uint32_t seed);
+void      td_spawn_enemy(TdEngine* engine, uint8_t enemy_type);
+void      td_set_money(TdEngine* engine, uint32_t money);
+bool      td_tower_slot(const TdEngine* engine, uint8_t slot,
+                        int16_t* x, int16_t* y, bool* occupied);
+
+// Map background plus the game, into the shared framebuffer
+void      td_draw(const TdEngine* engine);
+
+bool      td_array(TdEngine* engine, TdArrayId id, TdArray* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TD_ENGINE_H
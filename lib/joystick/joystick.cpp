@@ -13,6 +13,10 @@
 
 volatile bool joystick_flag = false;
 
+// Readings at rest; sticks rarely sit exactly at CENTER
+static uint16_t center_x = CENTER;
+static uint16_t center_y = CENTER;
+
 void joystick_isr() {
     hw_clear_bits(&timer0_hw->intr, 1 << 0);
 
@@ -43,13 +47,32 @@ void init_joystick(void){
     timer0_hw->alarm[0] = target;    
 }
 
+void joystick_calibrate(uint16_t* x, uint16_t* y) {
+    uint32_t sum_x = 0;
+    uint32_t sum_y = 0;
+    for (int i = 0; i < 16; i++) {
+        adc_select_input(0);
+        sum_x += adc_read();
+        adc_select_input(1);
+        sum_y += adc_read();
+    }
+    joystick_set_center(sum_x / 16, sum_y / 16);
+    *x = center_x;
+    *y = center_y;
+}
+
+void joystick_set_center(uint16_t x, uint16_t y) {
+    center_x = (x > ADC_MAX) ? CENTER : x;
+    center_y = (y > ADC_MAX) ? CENTER : y;
+}
+
 JoystickDirection sample_js_x(void){
     adc_select_input(0);
     uint16_t value = adc_read();
 
     int deadzone = (ADC_MAX / 2) * DEADZONE_PERCENT / 100;
-    if (value > CENTER + deadzone) return right;   // right
-    else if (value < CENTER - deadzone) return left;  // left
+    if (value > center_x + deadzone) return right;   // right
+    else if (value < center_x - deadzone) return left;  // left
     else return center;
 }
 
@@ -58,8 +81,8 @@ JoystickDirection sample_js_y(void){
     uint16_t value = adc_read();
 
     int deadzone = (ADC_MAX / 2) * DEADZONE_PERCENT / 100;
-    if (value > CENTER + deadzone) return up;   // up
-    else if (value < CENTER - deadzone) return down;  // down
+    if (value > center_y + deadzone) return up;   // up
+    else if (value < center_y - deadzone) return down;  // down
     else return center;
 }
 
@@ -1,6 +1,8 @@
 #ifndef JOYSTICK_HH
 #define JOYSTICK_HH
 
+#include <stdint.h>
+
 extern volatile bool joystick_flag;
 
 enum JoystickDirection {
@@ -17,6 +19,18 @@ enum JoystickDirection {
 
 void init_joystick(void);
 
+/**
+ * @brief average the stick's resting position and use it as center
+ *
+ * @param x, y receive the measured center, for saving
+ */
+void joystick_calibrate(uint16_t* x, uint16_t* y);
+
+/**
+ * @brief use a previously measured resting position as center
+ */
+void joystick_set_center(uint16_t x, uint16_t y);
+
 /**
  * @brief return 1 if right, -1 if left, 0 if neither
  * 
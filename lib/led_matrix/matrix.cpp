@@ -8,14 +8,30 @@
 #include "../pins/pin-definitions.hh"
 
 
-#define MATRIX_ROWS 32
-#define MATRIX_COLS 64
 #define GAMMA 2.9
 
+// Plane 0's on-time per row; each higher plane doubles it. Scaled by the
+// scan ratio so a frame takes as long on every panel: a 1/32-scan panel
+// keeps the refresh rate of a 1/16-scan one at half the brightness.
+#ifndef MATRIX_PLANE_US
+#define MATRIX_PLANE_US (192 / MATRIX_SCAN)
+#endif
+
+// An idle task step only starts with this much of a row's on-time left.
+// Steps must be shorter, or that row stays lit too long.
+#define MATRIX_IDLE_SLICE_US 40
+
 Color frames[2][MATRIX_ROWS][MATRIX_COLS];
 int frame_index = 0;
 
 static uint8_t gamma_lut[256];
+static uint8_t brightness = 100;  // Percent, folded into gamma_lut
+static MatrixIdleTask idle_task = NULL;
+
+// Address lines, least significant first, and each row's output bits on them
+static const uint8_t row_address_pins[5] = {A, B, C, D, E};
+static uint32_t row_address_mask;
+static uint32_t row_address[MATRIX_SCAN];
 
 static inline void my_gpio_put(uint pin, bool val) {
     if (val) sio_hw->gpio_set = 1u << pin;
@@ -23,13 +39,21 @@ static inline void my_gpio_put(uint pin, bool val) {
 }
 
 static inline void set_row_pins(int row) {
-    uint32_t pin_mask = (1u << A) | (1u << B) | (1u << C) | (1u << D);
-    uint32_t pin_values = (((row >> 0) & 1) << A) |
-                          (((row >> 1) & 1) << B) |
-                          (((row >> 2) & 1) << C) |
-                          (((row >> 3) & 1) << D);
+    sio_hw->gpio_out = (sio_hw->gpio_out & ~row_address_mask) | row_address[row];
+}
+
+static void init_row_address() {
+    row_address_mask = 0;
+    for (int bit = 0; bit < MATRIX_ADDRESS_BITS; bit++) {
+        row_address_mask |= 1u << row_address_pins[bit];
+    }
 
-    sio_hw->gpio_out = (sio_hw->gpio_out & ~pin_mask) | pin_values;
+    for (int row = 0; row < MATRIX_SCAN; row++) {
+        row_address[row] = 0;
+        for (int bit = 0; bit < MATRIX_ADDRESS_BITS; bit++) {
+            if ((row >> bit) & 1) row_address[row] |= 1u << row_address_pins[bit];
+        }
+    }
 }
 
 static inline void pulse_pin(int pin, int loops) {
@@ -65,13 +89,19 @@ void init_framebuffers(Color color) {
 
 void init_gamma_lut() {
     for (int i = 0; i < 256; i++) {
-        gamma_lut[i] = (uint8_t)(pow(i / 255.0, GAMMA) * 255.0);
+        gamma_lut[i] = (uint8_t)(pow(i / 255.0, GAMMA) * 255.0 * brightness / 100);
     }
 }
 
+void matrix_set_brightness(uint8_t percent) {
+    brightness = (percent > 100) ? 100 : percent;
+    init_gamma_lut();
+}
+
 
 void init_matrix() {
     init_matrix_pins();
+    init_row_address();
     init_framebuffers(GRASS);
     init_gamma_lut();
 }
@@ -81,14 +111,12 @@ void swap_frames() {
 }
 
 void reset_row_sel() {
-    for (int row_sel = A; row_sel <= D; row_sel++) {
-        my_gpio_put(row_sel, 0);
-    }
+    sio_hw->gpio_clr = row_address_mask;
 }
 
 void set_rgb_pins(int row, int col, int plane) {
     Color top = frames[!frame_index][row][col];
-    Color bottom = frames[!frame_index][row+16][col];
+    Color bottom = frames[!frame_index][row + MATRIX_SCAN][col];
 
     uint8_t top_r = gamma_lut[top.r];
     uint8_t top_g = gamma_lut[top.g];
@@ -107,11 +135,29 @@ void set_rgb_pins(int row, int col, int plane) {
     my_gpio_put(B2, ((bottom_b >> plane) & 0x1));
 }
 
+void matrix_blank() {
+    sio_hw->gpio_set = (1u << OE);
+}
+
+void matrix_set_idle_task(MatrixIdleTask task) {
+    idle_task = task;
+}
+
+// Keep the latched row lit for `us`, running the idle task meanwhile
+static inline void row_on_time(uint32_t us) {
+    uint32_t end = time_us_32() + us;
+    while (idle_task != NULL && (int32_t)(end - time_us_32()) > MATRIX_IDLE_SLICE_US) {
+        if (!idle_task()) break;
+    }
+    int32_t left = (int32_t)(end - time_us_32());
+    if (left > 0) busy_wait_us_32((uint32_t)left);
+}
+
 void render_frame() {
     reset_row_sel();
 
     for (int plane = 5; plane >= 0; plane--) {
-        for (int row = 0; row <  MATRIX_ROWS / 2; row++) {
+        for (int row = 0; row < MATRIX_SCAN; row++) {
             sio_hw->gpio_set = (1u << OE);
             sio_hw->gpio_set = (1u << 25);
             
@@ -126,7 +172,7 @@ void render_frame() {
             sio_hw->gpio_clr = (1u << OE);
             sio_hw->gpio_clr = (1u << 25);
             
-            sleep_us(12 * (1 << plane));
+            row_on_time((uint32_t)MATRIX_PLANE_US << plane);
         }
     }
 }
@@ -2,9 +2,7 @@
 #define MATRIX_H
 
 #include "color.hh"
-
-#define MATRIX_ROWS 32
-#define MATRIX_COLS 64
+#include "panel.hh"
 
 // External access to framebuffers for optimization
 extern Color frames[2][MATRIX_ROWS][MATRIX_COLS];
@@ -12,8 +10,9 @@ extern int frame_index;
 
 /*  NOTES:
 
-    Row select; DCBA (meaning D = 8, C = 4, etc.)
+    Row select; EDCBA (meaning E = 16, D = 8, C = 4, etc.)
         - This means 1011 = Row 11, 1001 = Row 9, etc 
+        - Only the lines MATRIX_SCAN needs are driven (panel.hh)
 
 */
 
@@ -22,6 +21,11 @@ extern int frame_index;
  */
 void init_matrix();
 
+/**
+ * @brief scales every color by 'percent' (0-100) on output
+ */
+void matrix_set_brightness(uint8_t percent);
+
 /**
  * @brief swaps framebuffers for double buffering
  */
@@ -32,6 +36,25 @@ void swap_frames();
  */
 void render_frame();
 
+/**
+ * @brief turns the panel off until render_frame() lights the next row
+ *
+ * For when the refresh loop is stopped part-way (core 1 parked for a flash
+ * write): the last latched row would otherwise stay lit the whole time.
+ * Safe to call from the other core.
+ */
+void matrix_blank();
+
+/**
+ * @brief work to run while rows are lit, in place of sleeping
+ *
+ * render_frame() calls the task repeatedly while a row's on-time has more
+ * than MATRIX_IDLE_SLICE_US left. Each call should do one short piece of
+ * work and return false when there is nothing left to do. NULL for none.
+ */
+typedef bool (*MatrixIdleTask)();
+void matrix_set_idle_task(MatrixIdleTask task);
+
 /**
  * @brief adds predefined path to framebuffer
  * 
@@ -0,0 +1,54 @@
+// panel.hh - LED panel geometry, chosen at build time
+//
+// HUB75 panels light two rows at a time, MATRIX_SCAN rows apart: row `r`
+// through R1/G1/B1 and row `r + MATRIX_SCAN` through R2/G2/B2. The row
+// address is log2(MATRIX_SCAN) bits on A, B, C, D and E. Chained panels
+// are driven as one wider panel.
+//
+// Pick a preset in build_flags (-DMATRIX_PANEL=MATRIX_PANEL_64X64), or set
+// MATRIX_COLS, MATRIX_ROWS and MATRIX_SCAN yourself. Framebuffers, the
+// refresh loop and the game's MATRIX_WIDTH/HEIGHT all follow. The map
+// compiler takes the panel from the same flags and builds in only the maps
+// no larger than it, drawn with black around them. The built-in maps are
+// 64x32 apart from the 32x16 "Small".
+#ifndef PANEL_HH
+#define PANEL_HH
+
+#define MATRIX_PANEL_64X32      0   // 1/16 scan, the board's panel
+#define MATRIX_PANEL_64X64      1   // 1/32 scan, uses E
+#define MATRIX_PANEL_128X32     2   // Two 64x32 panels chained, 1/16 scan
+#define MATRIX_PANEL_32X16      3   // 1/8 scan, A to C only
+
+#ifndef MATRIX_PANEL
+#define MATRIX_PANEL            MATRIX_PANEL_64X32
+#endif
+
+#ifndef MATRIX_COLS
+#if MATRIX_PANEL == MATRIX_PANEL_64X64
+#define MATRIX_COLS             64
+#define MATRIX_ROWS             64
+#define MATRIX_SCAN             32
+#elif MATRIX_PANEL == MATRIX_PANEL_128X32
+#define MATRIX_COLS             128
+#define MATRIX_ROWS             32
+#define MATRIX_SCAN             16
+#elif MATRIX_PANEL == MATRIX_PANEL_32X16
+#define MATRIX_COLS             32
+#define MATRIX_ROWS             16
+#define MATRIX_SCAN             8
+#else
+#define MATRIX_COLS             64
+#define MATRIX_ROWS             32
+#define MATRIX_SCAN             16
+#endif
+#endif
+
+// Row address lines in use
+#define MATRIX_ADDRESS_BITS     (MATRIX_SCAN == 32 ? 5 : MATRIX_SCAN == 16 ? 4 : 3)
+
+static_assert(MATRIX_SCAN == 8 || MATRIX_SCAN == 16 || MATRIX_SCAN == 32,
+              "MATRIX_SCAN must be 8, 16 or 32");
+static_assert(MATRIX_ROWS == 2 * MATRIX_SCAN, "each address lights one row in each half");
+static_assert(MATRIX_COLS > 0 && MATRIX_COLS <= 255, "pixel coordinates are 8-bit");
+
+#endif // PANEL_HH
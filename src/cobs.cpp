@@ -0,0 +1,39 @@
+// cobs.cpp - COBS framing for the USB serial protocols
+#include "cobs.hh"
+
+uint32_t cobs_frame(uint8_t* out, const uint8_t* in, uint32_t size) {
+    uint8_t* start = out;
+    *out++ = 0x00;
+
+    uint8_t* code = out++;
+    uint8_t run = 1;
+    for (uint32_t i = 0; i < size; i++) {
+        if (in[i] == 0) {
+            *code = run;
+            code = out++;
+            run = 1;
+            continue;
+        }
+        *out++ = in[i];
+        if (++run == 0xFF) {
+            *code = run;
+            code = out++;
+            run = 1;
+        }
+    }
+    *code = run;
+    *out++ = 0x00;
+    return (uint32_t)(out - start);
+}
+
+uint32_t cobs_decode(const uint8_t* in, uint32_t size, uint8_t* out, uint32_t capacity) {
+    uint32_t n = 0;
+    uint32_t i = 0;
+    while (i < size) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > size || n + code > capacity) return 0;
+        for (int k = 1; k < code; k++) out[n++] = in[i++];
+        if (code != 0xFF && i < size) out[n++] = 0;
+    }
+    return n;
+}
@@ -0,0 +1,24 @@
+// cobs.hh - COBS framing for the USB serial protocols
+//
+// The frame stream and telemetry share the port with console text, so each
+// packet is COBS-encoded (no 0x00 inside) and sent between 0x00 delimiters.
+// A receiver resynchronises on the next 0x00 after any garbage.
+#ifndef COBS_HH
+#define COBS_HH
+
+#include <stdint.h>
+
+// Largest framed size of a `size`-byte packet, delimiters included
+#define COBS_FRAMED_SIZE(size)  ((size) + (size) / 254 + 3)
+
+// COBS-encode `size` bytes at `in` to `out`, between 0x00 delimiters.
+// Returns the framed size. `out` may overlap `in` if it starts at least
+// COBS_FRAMED_SIZE(size) - size bytes before it: the encoding grows by one
+// byte per 254, so the write position never passes the read position.
+uint32_t cobs_frame(uint8_t* out, const uint8_t* in, uint32_t size);
+
+// Decode one packet (without its delimiters) into `out`. Returns the
+// decoded size, or 0 if it is malformed or larger than `capacity`.
+uint32_t cobs_decode(const uint8_t* in, uint32_t size, uint8_t* out, uint32_t capacity);
+
+#endif // COBS_HH
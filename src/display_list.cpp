@@ -0,0 +1,538 @@
+// display_list.cpp - Draw command recording, sorting, culling and execution
+#include "display_list.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "matrix.hh"
+#include "sprites.hh"
+
+// Helper function to convert game TowerType to hardware HardwareTowerType
+static HardwareTowerType game_to_hardware_tower(TowerType game_type) {
+    switch (game_type) {
+        case TOWER_MACHINE_GUN: return MACHINE_GUN;
+        case TOWER_CANNON:      return CANNON;
+        case TOWER_SNIPER:      return SNIPER;
+        case TOWER_RADAR:       return RADAR;
+        case TOWER_BLANK:
+        default:                return BLANK;
+    }
+}
+
+static const Color* sprite_pixels(uint8_t sprite) {
+    if (sprite == DRAW_SPRITE_SLOT) return get_sprite_tower_slot();
+    return get_sprite(game_to_hardware_tower((TowerType)(sprite - DRAW_SPRITE_TOWER(0))));
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+void display_list_clear(DisplayList* list) {
+    list->count = 0;
+    list->pixel_count = 0;
+    list->culled = 0;
+    list->overflow = 0;
+}
+
+static DrawCommand* add_command(DisplayList* list, DrawOp op, DrawLayer layer) {
+    if (list->count >= DISPLAY_LIST_MAX_COMMANDS) {
+        list->overflow++;
+        return NULL;
+    }
+    DrawCommand* command = &list->commands[list->count++];
+    *command = DrawCommand();
+    command->op = (uint8_t)op;
+    command->layer = (uint8_t)layer;
+    return command;
+}
+
+void display_list_sprite(DisplayList* list, DrawLayer layer, uint8_t sprite,
+                         int x, int y, uint8_t shade) {
+    DrawCommand* command = add_command(list, DRAW_SPRITE, layer);
+    if (command == NULL) return;
+    command->sprite = sprite;
+    command->shade = shade;
+    command->x = (int16_t)x;
+    command->y = (int16_t)y;
+}
+
+void display_list_pixel(DisplayList* list, DrawLayer layer, int x, int y, Color color) {
+    if (x < 0 || x >= MATRIX_WIDTH || y < 0 || y >= MATRIX_HEIGHT) return;
+    if (list->pixel_count >= DISPLAY_LIST_MAX_PIXELS) {
+        list->overflow++;
+        return;
+    }
+
+    // Extend the last command if it is this layer's batch and has room
+    DrawCommand* last = list->count > 0 ? &list->commands[list->count - 1] : NULL;
+    if (last == NULL || last->op != DRAW_PIXELS || last->layer != layer ||
+        last->b >= DISPLAY_LIST_PIXEL_BATCH) {
+        last = add_command(list, DRAW_PIXELS, layer);
+        if (last == NULL) return;
+        last->a = (int16_t)list->pixel_count;
+    }
+
+    DrawPixel* pixel = &list->pixels[list->pixel_count++];
+    pixel->x = (uint8_t)x;
+    pixel->y = (uint8_t)y;
+    pixel->color = color;
+    last->b++;
+}
+
+void display_list_line(DisplayList* list, DrawLayer layer, int x0, int y0, int x1, int y1,
+                       Color color) {
+    DrawCommand* command = add_command(list, DRAW_LINE, layer);
+    if (command == NULL) return;
+    command->x = (int16_t)x0;
+    command->y = (int16_t)y0;
+    command->a = (int16_t)x1;
+    command->b = (int16_t)y1;
+    command->color = color;
+}
+
+void display_list_circle(DisplayList* list, DrawLayer layer, int cx, int cy, int radius,
+                         Color color) {
+    DrawCommand* command = add_command(list, DRAW_CIRCLE, layer);
+    if (command == NULL) return;
+    command->x = (int16_t)cx;
+    command->y = (int16_t)cy;
+    command->a = (int16_t)radius;
+    command->color = color;
+}
+
+void display_list_rect(DisplayList* list, DrawLayer layer, int x, int y, int width, int height,
+                       Color color) {
+    DrawCommand* command = add_command(list, DRAW_RECT, layer);
+    if (command == NULL) return;
+    command->x = (int16_t)x;
+    command->y = (int16_t)y;
+    command->a = (int16_t)width;
+    command->b = (int16_t)height;
+    command->color = color;
+}
+
+// ============================================================================
+// SORTING AND CULLING
+// ============================================================================
+
+// Box (inclusive) that holds every pixel the command can draw; false if
+// it draws nothing
+static bool command_bounds(const DrawCommand* command, const DisplayList* list,
+                           int* x0, int* y0, int* x1, int* y1) {
+    *x0 = command->x;
+    *y0 = command->y;
+
+    switch (command->op) {
+        case DRAW_SPRITE:
+            *x1 = *x0 + DRAW_SPRITE_SIZE - 1;
+            *y1 = *y0 + DRAW_SPRITE_SIZE - 1;
+            return true;
+        case DRAW_PIXELS: {
+            if (command->b <= 0) return false;
+            const DrawPixel* pixel = &list->pixels[command->a];
+            *x0 = *x1 = pixel->x;
+            *y0 = *y1 = pixel->y;
+            for (int n = 1; n < command->b; n++) {
+                pixel++;
+                if (pixel->x < *x0) *x0 = pixel->x;
+                if (pixel->x > *x1) *x1 = pixel->x;
+                if (pixel->y < *y0) *y0 = pixel->y;
+                if (pixel->y > *y1) *y1 = pixel->y;
+            }
+            return true;
+        }
+        case DRAW_LINE:
+            *x1 = command->a;
+            *y1 = command->b;
+            if (*x1 < *x0) { int t = *x0; *x0 = *x1; *x1 = t; }
+            if (*y1 < *y0) { int t = *y0; *y0 = *y1; *y1 = t; }
+            return true;
+        case DRAW_CIRCLE:
+            if (command->a < 0) return false;
+            *x1 = *x0 + command->a;
+            *y1 = *y0 + command->a;
+            *x0 -= command->a;
+            *y0 -= command->a;
+            return true;
+        case DRAW_RECT:
+            if (command->a <= 0 || command->b <= 0) return false;
+            *x1 = *x0 + command->a - 1;
+            *y1 = *y0 + command->b - 1;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Whether any pixel of the command can land on the panel
+static bool on_panel(const DrawCommand* command, const DisplayList* list) {
+    int x0, y0, x1, y1;
+    if (!command_bounds(command, list, &x0, &y0, &x1, &y1)) return false;
+    return x1 >= 0 && x0 < MATRIX_WIDTH && y1 >= 0 && y0 < MATRIX_HEIGHT;
+}
+
+// An opaque sprite drawn later at the same spot hides every pixel of this one
+static bool covered_later(const DisplayList* list, uint16_t index) {
+    const DrawCommand* command = &list->commands[index];
+    for (uint16_t i = index + 1; i < list->count; i++) {
+        const DrawCommand* later = &list->commands[i];
+        if (later->op == DRAW_SPRITE && later->x == command->x && later->y == command->y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sort scratch, kept off core 0's 2 KB stack. Only one core builds display
+// lists.
+static DrawCommand sorted[DISPLAY_LIST_MAX_COMMANDS];
+
+void display_list_finish(DisplayList* list) {
+    // Stable counting sort by layer
+    uint16_t start[DRAW_LAYER_COUNT + 1] = {0};
+    for (uint16_t i = 0; i < list->count; i++) {
+        start[list->commands[i].layer + 1]++;
+    }
+    for (int layer = 0; layer < DRAW_LAYER_COUNT; layer++) {
+        start[layer + 1] += start[layer];
+    }
+
+    for (uint16_t i = 0; i < list->count; i++) {
+        sorted[start[list->commands[i].layer]++] = list->commands[i];
+    }
+    memcpy(list->commands, sorted, list->count * sizeof(DrawCommand));
+
+    // Cull in place, keeping the order
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < list->count; i++) {
+        const DrawCommand* command = &list->commands[i];
+        bool visible = on_panel(command, list) &&
+                       !(command->op == DRAW_SPRITE && covered_later(list, i));
+        if (visible) {
+            list->commands[kept++] = *command;
+        } else {
+            list->culled++;
+        }
+    }
+    list->count = kept;
+}
+
+void display_list_copy(DisplayList* to, const DisplayList* from) {
+    to->count = from->count;
+    to->pixel_count = from->pixel_count;
+    to->culled = from->culled;
+    to->overflow = from->overflow;
+    memcpy(to->commands, from->commands, from->count * sizeof(DrawCommand));
+    memcpy(to->pixels, from->pixels, from->pixel_count * sizeof(DrawPixel));
+}
+
+// ============================================================================
+// EXECUTION
+// ============================================================================
+
+// Where a command may write: the panel, or only its damaged pixels. The
+// executors are instantiated per clip, so the full-frame path pays for no
+// damage tests.
+struct PanelClip {
+    bool touches(int, int, int, int) const { return true; }
+    bool allows(int, int) const { return true; }
+};
+
+struct DamageClip {
+    const DisplayDamage* damage;
+
+    bool touches(int x0, int y0, int x1, int y1) const {
+        return display_damage_touches(damage, x0, y0, x1, y1);
+    }
+    bool allows(int x, int y) const {
+        return (damage->rows[y][x >> 5] >> (x & 31)) & 1;
+    }
+};
+
+template <typename Clip>
+static inline void put_clipped(Color (*frame)[MATRIX_COLS], const Clip& clip,
+                               int x, int y, Color color) {
+    if (x >= 0 && x < MATRIX_WIDTH && y >= 0 && y < MATRIX_HEIGHT && clip.allows(x, y)) {
+        frame[y][x] = color;
+    }
+}
+
+template <typename Clip>
+static void execute_sprite(Color (*frame)[MATRIX_COLS], const Clip& clip,
+                           const DrawCommand* command) {
+    const Color* sprite = sprite_pixels(command->sprite);
+
+    // Clip to the panel once, then copy rows
+    int dx0 = command->x < 0 ? -command->x : 0;
+    int dy0 = command->y < 0 ? -command->y : 0;
+    int dx1 = MATRIX_WIDTH - command->x;
+    int dy1 = MATRIX_HEIGHT - command->y;
+    if (dx1 > DRAW_SPRITE_SIZE) dx1 = DRAW_SPRITE_SIZE;
+    if (dy1 > DRAW_SPRITE_SIZE) dy1 = DRAW_SPRITE_SIZE;
+
+    for (int dy = dy0; dy < dy1; dy++) {
+        int y = command->y + dy;
+        Color* row = &frame[y][command->x];
+        const Color* source = &sprite[dy * DRAW_SPRITE_SIZE];
+        for (int dx = dx0; dx < dx1; dx++) {
+            if (!clip.allows(command->x + dx, y)) continue;
+            if (command->shade > 1) {
+                row[dx] = Color(source[dx].r / command->shade,
+                                source[dx].g / command->shade,
+                                source[dx].b / command->shade);
+            } else {
+                row[dx] = source[dx];
+            }
+        }
+    }
+}
+
+template <typename Clip>
+static void execute_pixels(Color (*frame)[MATRIX_COLS], const Clip& clip,
+                           const DisplayList* list, const DrawCommand* command) {
+    // On the panel already: clipped when recorded
+    const DrawPixel* pixel = &list->pixels[command->a];
+    for (int n = 0; n < command->b; n++, pixel++) {
+        if (clip.allows(pixel->x, pixel->y)) {
+            frame[pixel->y][pixel->x] = pixel->color;
+        }
+    }
+}
+
+template <typename Clip>
+static void execute_line(Color (*frame)[MATRIX_COLS], const Clip& clip,
+                         const DrawCommand* command) {
+    int x0 = command->x, y0 = command->y;
+    int x1 = command->a, y1 = command->b;
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    int err = dx - dy;
+
+    while (true) {
+        put_clipped(frame, clip, x0, y0, command->color);
+        if (x0 == x1 && y0 == y1) break;
+
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+// Midpoint circle, one pixel wide
+template <typename Clip>
+static void execute_circle(Color (*frame)[MATRIX_COLS], const Clip& clip,
+                           const DrawCommand* command) {
+    int cx = command->x, cy = command->y;
+    int x = command->a;
+    int y = 0;
+    int err = 0;
+
+    while (x >= y) {
+        put_clipped(frame, clip, cx + x, cy + y, command->color);
+        put_clipped(frame, clip, cx + y, cy + x, command->color);
+        put_clipped(frame, clip, cx - y, cy + x, command->color);
+        put_clipped(frame, clip, cx - x, cy + y, command->color);
+        put_clipped(frame, clip, cx - x, cy - y, command->color);
+        put_clipped(frame, clip, cx - y, cy - x, command->color);
+        put_clipped(frame, clip, cx + y, cy - x, command->color);
+        put_clipped(frame, clip, cx + x, cy - y, command->color);
+
+        if (err <= 0) {
+            y += 1;
+            err += 2 * y + 1;
+        }
+        if (err > 0) {
+            x -= 1;
+            err -= 2 * x + 1;
+        }
+    }
+}
+
+template <typename Clip>
+static void execute_rect(Color (*frame)[MATRIX_COLS], const Clip& clip,
+                         const DrawCommand* command) {
+    int x0 = command->x, y0 = command->y;
+    int x1 = x0 + command->a - 1, y1 = y0 + command->b - 1;
+
+    for (int x = x0; x <= x1; x++) {
+        put_clipped(frame, clip, x, y0, command->color);
+        put_clipped(frame, clip, x, y1, command->color);
+    }
+    for (int y = y0 + 1; y < y1; y++) {
+        put_clipped(frame, clip, x0, y, command->color);
+        put_clipped(frame, clip, x1, y, command->color);
+    }
+}
+
+template <typename Clip>
+static void execute_commands(const DisplayList* list, uint16_t first, uint16_t end,
+                             Color (*frame)[MATRIX_COLS], const Clip& clip) {
+    for (uint16_t i = first; i < end; i++) {
+        const DrawCommand* command = &list->commands[i];
+
+        // Skip shapes wholly outside the clip; pixels are tested one by one
+        int x0, y0, x1, y1;
+        if (command->op != DRAW_PIXELS &&
+            (!command_bounds(command, list, &x0, &y0, &x1, &y1) ||
+             !clip.touches(x0, y0, x1, y1))) {
+            continue;
+        }
+
+        switch (command->op) {
+            case DRAW_SPRITE: execute_sprite(frame, clip, command); break;
+            case DRAW_PIXELS: execute_pixels(frame, clip, list, command); break;
+            case DRAW_LINE:   execute_line(frame, clip, command); break;
+            case DRAW_CIRCLE: execute_circle(frame, clip, command); break;
+            case DRAW_RECT:   execute_rect(frame, clip, command); break;
+        }
+    }
+}
+
+void display_list_execute(const DisplayList* list, uint16_t first, uint16_t end) {
+    execute_commands(list, first, end, frames[frame_index], PanelClip());
+}
+
+void display_list_execute_to(const DisplayList* list, uint16_t first, uint16_t end,
+                             Color (*target)[MATRIX_WIDTH]) {
+    execute_commands(list, first, end, target, PanelClip());
+}
+
+void display_list_execute_damaged(const DisplayList* list, uint16_t first, uint16_t end,
+                                  const DisplayDamage* damage) {
+    DamageClip clip = {damage};
+    execute_commands(list, first, end, frames[frame_index], clip);
+}
+
+// ============================================================================
+// DAMAGE
+// ============================================================================
+
+void display_damage_clear(DisplayDamage* damage) {
+    memset(damage->rows, 0, sizeof(damage->rows));
+}
+
+// Bits [x0, x1] of one row's words
+static void mark_span(uint32_t* words, int x0, int x1) {
+    for (int w = x0 >> 5; w <= (x1 >> 5); w++) {
+        int lo = (w == (x0 >> 5)) ? (x0 & 31) : 0;
+        int hi = (w == (x1 >> 5)) ? (x1 & 31) : 31;
+        uint32_t bits = (hi == 31 ? 0xFFFFFFFFu : ((1u << (hi + 1)) - 1)) & ~((1u << lo) - 1);
+        words[w] |= bits;
+    }
+}
+
+static bool clip_box(int* x0, int* y0, int* x1, int* y1) {
+    if (*x0 < 0) *x0 = 0;
+    if (*y0 < 0) *y0 = 0;
+    if (*x1 >= MATRIX_WIDTH) *x1 = MATRIX_WIDTH - 1;
+    if (*y1 >= MATRIX_HEIGHT) *y1 = MATRIX_HEIGHT - 1;
+    return *x0 <= *x1 && *y0 <= *y1;
+}
+
+void display_damage_add_rect(DisplayDamage* damage, int x0, int y0, int x1, int y1) {
+    if (!clip_box(&x0, &y0, &x1, &y1)) return;
+    for (int y = y0; y <= y1; y++) {
+        mark_span(damage->rows[y], x0, x1);
+    }
+}
+
+void display_damage_add(DisplayDamage* damage, const DisplayDamage* other) {
+    for (int y = 0; y < MATRIX_HEIGHT; y++) {
+        for (int w = 0; w < DISPLAY_DAMAGE_WORDS; w++) {
+            damage->rows[y][w] |= other->rows[y][w];
+        }
+    }
+}
+
+bool display_damage_touches(const DisplayDamage* damage, int x0, int y0, int x1, int y1) {
+    if (!clip_box(&x0, &y0, &x1, &y1)) return false;
+
+    uint32_t span[DISPLAY_DAMAGE_WORDS] = {0};
+    mark_span(span, x0, x1);
+    for (int y = y0; y <= y1; y++) {
+        for (int w = 0; w < DISPLAY_DAMAGE_WORDS; w++) {
+            if (damage->rows[y][w] & span[w]) return true;
+        }
+    }
+    return false;
+}
+
+uint32_t display_damage_area(const DisplayDamage* damage) {
+    uint32_t area = 0;
+    for (int y = 0; y < MATRIX_HEIGHT; y++) {
+        for (int w = 0; w < DISPLAY_DAMAGE_WORDS; w++) {
+            area += (uint32_t)__builtin_popcount(damage->rows[y][w]);
+        }
+    }
+    return area;
+}
+
+static void add_command_bounds(DisplayDamage* damage, const DisplayList* list,
+                               const DrawCommand* command) {
+    int x0, y0, x1, y1;
+    if (command_bounds(command, list, &x0, &y0, &x1, &y1)) {
+        display_damage_add_rect(damage, x0, y0, x1, y1);
+    }
+}
+
+static bool same_command(const DrawCommand* a, const DrawCommand* b) {
+    return a->op == b->op && a->layer == b->layer && a->sprite == b->sprite &&
+           a->shade == b->shade && a->x == b->x && a->y == b->y &&
+           a->a == b->a && a->b == b->b && a->color.r == b->color.r &&
+           a->color.g == b->color.g && a->color.b == b->color.b;
+}
+
+// Index of the first non-pixel command at or after `i`
+static uint16_t next_shape(const DisplayList* list, uint16_t i) {
+    while (i < list->count && list->commands[i].op == DRAW_PIXELS) i++;
+    return i;
+}
+
+void display_damage_add_commands(DisplayDamage* damage, const DisplayList* before,
+                                 const DisplayList* after) {
+    uint16_t i = next_shape(before, 0);
+    uint16_t j = next_shape(after, 0);
+
+    while (i < before->count || j < after->count) {
+        const DrawCommand* old_command = (i < before->count) ? &before->commands[i] : NULL;
+        const DrawCommand* new_command = (j < after->count) ? &after->commands[j] : NULL;
+
+        bool same = old_command != NULL && new_command != NULL &&
+                    same_command(old_command, new_command);
+        if (!same) {
+            if (old_command != NULL) add_command_bounds(damage, before, old_command);
+            if (new_command != NULL) add_command_bounds(damage, after, new_command);
+        }
+
+        if (old_command != NULL) i = next_shape(before, i + 1);
+        if (new_command != NULL) j = next_shape(after, j + 1);
+    }
+}
+
+void display_damage_add_pixels(DisplayDamage* damage, const DisplayList* list,
+                               uint16_t first, uint16_t end) {
+    for (uint16_t i = first; i < end; i++) {
+        const DrawPixel* pixel = &list->pixels[i];
+        damage->rows[pixel->y][pixel->x >> 5] |= 1u << (pixel->x & 31);
+    }
+}
+
+void display_damage_restore_row(const DisplayDamage* damage, int y, const Color* from, Color* to) {
+    for (int w = 0; w < DISPLAY_DAMAGE_WORDS; w++) {
+        uint32_t bits = damage->rows[y][w];
+        while (bits != 0) {
+            int x = (w << 5) + __builtin_ctz(bits);
+            to[x] = from[x];
+            bits &= bits - 1;
+        }
+    }
+}
@@ -0,0 +1,140 @@
+// display_list.h - Retained draw commands for one frame
+//
+// Drawing is recorded as compact commands (sprite, pixel batch, line,
+// circle, rectangle outline), each on a layer, instead of writing pixels at
+// once. display_list_finish() sorts the commands by layer, keeping their
+// order within a layer, and culls what cannot show: commands entirely off
+// the panel and sprites covered by an opaque sprite drawn later (a slot
+// under its tower). display_list_execute() is then the only code that
+// writes game pixels, clipping each command once rather than per pixel.
+//
+// A list is plain data with no pointers, so it can be copied between cores
+// or recorded and compared.
+//
+// DisplayDamage marks the pixels that differ between two lists: the bounds
+// of every shape that changed (old and new) and every pixel of both lists'
+// pixel batches. Restoring just those pixels from the background and
+// redrawing the list clipped to them (display_list_execute_damaged) turns
+// the old frame into the new one.
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include "game_types.h"
+
+#define DRAW_SPRITE_SIZE            4       // Sprites are 4x4 and opaque
+#define DISPLAY_LIST_PIXEL_BATCH    64      // Most pixels merged into one command
+#define DISPLAY_LIST_MAX_PIXELS     (MAX_ENEMIES + MAX_PROJECTILES)
+
+// Per tower: slot, range circle, sprite and sweep; plus pixel batches and
+// the overlay
+#define DISPLAY_LIST_MAX_COMMANDS   (MAX_TOWERS * 4 + \
+                                     DISPLAY_LIST_MAX_PIXELS / DISPLAY_LIST_PIXEL_BATCH + 8)
+
+typedef enum {
+    DRAW_SPRITE = 0,    // x, y top-left; sprite id, shade
+    DRAW_PIXELS,        // a = first pixel, b = count, in DisplayList.pixels
+    DRAW_LINE,          // x, y to a, b
+    DRAW_CIRCLE,        // Outline: x, y centre, a = radius
+    DRAW_RECT           // Outline: x, y top-left, a = width, b = height
+} DrawOp;
+
+// Bottom to top
+typedef enum {
+    DRAW_LAYER_SLOTS = 0,
+    DRAW_LAYER_RANGES,          // Radar coverage circles
+    DRAW_LAYER_TOWERS,
+    DRAW_LAYER_SWEEPS,          // Radar sweep lines
+    DRAW_LAYER_ENEMIES,
+    DRAW_LAYER_PROJECTILES,
+    DRAW_LAYER_OVERLAY,         // Placement cursor and range
+    DRAW_LAYER_COUNT
+} DrawLayer;
+
+// Sprite ids: the tower slot, then one per TowerType
+#define DRAW_SPRITE_SLOT            0
+#define DRAW_SPRITE_TOWER(type)     (1 + (type))
+
+typedef struct {
+    uint8_t  op;        // DrawOp
+    uint8_t  layer;     // DrawLayer
+    uint8_t  sprite;    // DRAW_SPRITE: sprite id
+    uint8_t  shade;     // DRAW_SPRITE: each channel divided by this (1 = as is)
+    int16_t  x, y;
+    int16_t  a, b;
+    Color    color;     // DRAW_LINE, DRAW_CIRCLE, DRAW_RECT
+} DrawCommand;
+
+typedef struct {
+    uint8_t  x, y;
+    Color    color;
+} DrawPixel;
+
+typedef struct {
+    uint16_t    count;
+    uint16_t    pixel_count;
+    uint16_t    culled;         // Commands dropped by display_list_finish()
+    uint16_t    overflow;       // Commands or pixels dropped for lack of room
+    DrawCommand commands[DISPLAY_LIST_MAX_COMMANDS];
+    DrawPixel   pixels[DISPLAY_LIST_MAX_PIXELS];
+} DisplayList;
+
+void display_list_clear(DisplayList* list);
+
+// Recording. Pixels off the panel are dropped here; consecutive pixels on
+// one layer share a DRAW_PIXELS command.
+void display_list_sprite(DisplayList* list, DrawLayer layer, uint8_t sprite,
+                         int x, int y, uint8_t shade);
+void display_list_pixel(DisplayList* list, DrawLayer layer, int x, int y, Color color);
+void display_list_line(DisplayList* list, DrawLayer layer, int x0, int y0, int x1, int y1,
+                       Color color);
+void display_list_circle(DisplayList* list, DrawLayer layer, int cx, int cy, int radius,
+                         Color color);
+void display_list_rect(DisplayList* list, DrawLayer layer, int x, int y, int width, int height,
+                       Color color);
+
+// Sort by layer and cull; call once, after the last command is recorded
+void display_list_finish(DisplayList* list);
+
+// Copy only the used part of a list
+void display_list_copy(DisplayList* to, const DisplayList* from);
+
+// Draw commands [first, end) into the active framebuffer
+void display_list_execute(const DisplayList* list, uint16_t first, uint16_t end);
+// ... or into any panel-sized buffer
+void display_list_execute_to(const DisplayList* list, uint16_t first, uint16_t end,
+                             Color (*target)[MATRIX_WIDTH]);
+
+// ============================================================================
+// Damage
+// ============================================================================
+
+// One bit per pixel, so overlapping rectangles merge for free
+#define DISPLAY_DAMAGE_WORDS        ((MATRIX_WIDTH + 31) / 32)
+
+typedef struct {
+    uint32_t rows[MATRIX_HEIGHT][DISPLAY_DAMAGE_WORDS];
+} DisplayDamage;
+
+void display_damage_clear(DisplayDamage* damage);
+void display_damage_add(DisplayDamage* damage, const DisplayDamage* other);
+// Inclusive corners, clipped to the panel
+void display_damage_add_rect(DisplayDamage* damage, int x0, int y0, int x1, int y1);
+bool display_damage_touches(const DisplayDamage* damage, int x0, int y0, int x1, int y1);
+uint32_t display_damage_area(const DisplayDamage* damage);
+
+// The shapes that differ between `before` and `after`, compared in order
+// and ignoring pixel batches: both bounds of each differing pair
+void display_damage_add_commands(DisplayDamage* damage, const DisplayList* before,
+                                 const DisplayList* after);
+// Entries [first, end) of list->pixels
+void display_damage_add_pixels(DisplayDamage* damage, const DisplayList* list,
+                               uint16_t first, uint16_t end);
+
+// Copy row `y`'s damaged pixels from `from` to `to`
+void display_damage_restore_row(const DisplayDamage* damage, int y, const Color* from, Color* to);
+
+// display_list_execute(), writing only damaged pixels
+void display_list_execute_damaged(const DisplayList* list, uint16_t first, uint16_t end,
+                                  const DisplayDamage* damage);
+
+#endif // DISPLAY_LIST_H
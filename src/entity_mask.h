@@ -0,0 +1,39 @@
+// entity_mask.h - One-bit-per-slot liveness masks for fixed-size entity arrays
+#ifndef ENTITY_MASK_H
+#define ENTITY_MASK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MASK_WORDS(n)       (((n) + 31) / 32)
+
+static inline bool mask_test(const uint32_t* mask, int i) {
+    return (mask[i >> 5] >> (i & 31)) & 1u;
+}
+
+static inline void mask_set(uint32_t* mask, int i) {
+    mask[i >> 5] |= 1u << (i & 31);
+}
+
+static inline void mask_clear(uint32_t* mask, int i) {
+    mask[i >> 5] &= ~(1u << (i & 31));
+}
+
+// Index of the next set bit at or after `from`, or -1 if there is none.
+// Iterate with: for (int i = mask_next(m, N, 0); i >= 0; i = mask_next(m, N, i + 1))
+static inline int mask_next(const uint32_t* mask, int count, int from) {
+    int word = from >> 5;
+    int words = MASK_WORDS(count);
+    if (word >= words) return -1;
+
+    uint32_t bits = mask[word] & (~0u << (from & 31));
+    while (bits == 0) {
+        if (++word >= words) return -1;
+        bits = mask[word];
+    }
+
+    int i = (word << 5) + __builtin_ctz(bits);
+    return (i < count) ? i : -1;
+}
+
+#endif // ENTITY_MASK_H
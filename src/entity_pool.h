@@ -0,0 +1,101 @@
+// entity_pool.h - Fixed-capacity slot pools with generation-checked handles
+#ifndef ENTITY_POOL_H
+#define ENTITY_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "entity_mask.h"
+
+// A handle packs a slot index (low 16 bits) with the slot's generation at
+// the time it was handed out (high 16 bits). Freeing a slot bumps its
+// generation, so a handle to a despawned entity stops resolving even after
+// the slot is reused. Generations skip 0, which keeps HANDLE_NONE invalid.
+typedef uint32_t EntityHandle;
+
+#define HANDLE_NONE         0u
+
+// Slots never move. alloc/free are O(1) through a LIFO free list, and the
+// alive mask supports ordered iteration with mask_next().
+template <uint16_t N>
+struct EntityPool {
+    uint32_t alive[MASK_WORDS(N)];
+    uint16_t generation[N];
+    uint16_t free_list[N];
+    uint16_t free_count;
+};
+
+template <uint16_t N>
+inline void pool_init(EntityPool<N>* pool) {
+    for (int w = 0; w < MASK_WORDS(N); w++) {
+        pool->alive[w] = 0;
+    }
+    // Stack top is slot 0, so a fresh pool hands out slots in order
+    for (uint16_t i = 0; i < N; i++) {
+        pool->generation[i] = 1;
+        pool->free_list[i] = (uint16_t)(N - 1 - i);
+    }
+    pool->free_count = N;
+}
+
+// Returns the allocated slot index, or -1 when the pool is full
+template <uint16_t N>
+inline int pool_alloc(EntityPool<N>* pool) {
+    if (pool->free_count == 0) return -1;
+
+    uint16_t index = pool->free_list[--pool->free_count];
+    mask_set(pool->alive, index);
+    return index;
+}
+
+template <uint16_t N>
+inline void pool_free(EntityPool<N>* pool, int index) {
+    if (!mask_test(pool->alive, index)) return;
+
+    mask_clear(pool->alive, index);
+    if (++pool->generation[index] == 0) {
+        pool->generation[index] = 1;
+    }
+    pool->free_list[pool->free_count++] = (uint16_t)index;
+}
+
+// Rebuilds the free list from the alive mask, for callers that marked
+// slots alive directly (restoring a snapshot). Lowest free slot on top.
+template <uint16_t N>
+inline void pool_rebuild_free_list(EntityPool<N>* pool) {
+    pool->free_count = 0;
+    for (int i = N - 1; i >= 0; i--) {
+        if (!mask_test(pool->alive, i)) {
+            pool->free_list[pool->free_count++] = (uint16_t)i;
+        }
+    }
+}
+
+template <uint16_t N>
+inline bool pool_is_alive(const EntityPool<N>* pool, int index) {
+    return mask_test(pool->alive, index);
+}
+
+template <uint16_t N>
+inline EntityHandle pool_handle(const EntityPool<N>* pool, int index) {
+    return ((EntityHandle)pool->generation[index] << 16) | (EntityHandle)index;
+}
+
+// Slot index for a handle, or -1 if it is HANDLE_NONE or stale
+template <uint16_t N>
+inline int pool_resolve(const EntityPool<N>* pool, EntityHandle handle) {
+    uint16_t index = (uint16_t)(handle & 0xFFFFu);
+    uint16_t generation = (uint16_t)(handle >> 16);
+
+    if (index >= N) return -1;
+    if (pool->generation[index] != generation) return -1;
+    if (!mask_test(pool->alive, index)) return -1;
+    return index;
+}
+
+template <uint16_t N>
+inline int pool_count(const EntityPool<N>* pool) {
+    return N - pool->free_count;
+}
+
+#endif // ENTITY_POOL_H
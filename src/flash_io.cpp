@@ -0,0 +1,84 @@
+// flash_io.cpp - RAM-resident flash erase/program and DMA-sniffer crc
+#include "flash_io.hh"
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+
+static FlashParkHook park_hook = NULL;
+
+void flash_io_set_park_hook(FlashParkHook hook) {
+    park_hook = hook;
+}
+
+const uint8_t* flash_io_read(uint32_t offset) {
+    return (const uint8_t*)(XIP_BASE + offset);
+}
+
+// Runs from RAM: flash is not readable until these return
+static void __no_inline_not_in_flash_func(flash_io_erase_locked)(uint32_t offset) {
+    flash_range_erase(offset, FLASH_SECTOR_SIZE);
+}
+
+static void __no_inline_not_in_flash_func(flash_io_program_locked)(uint32_t offset,
+                                                                   const uint8_t* data,
+                                                                   uint32_t size) {
+    flash_range_program(offset, data, size);
+}
+
+// Park core 1 (if it is running yet) and this core's interrupts around a
+// flash operation
+static uint32_t flash_io_lock(bool* core1_parked) {
+    *core1_parked = multicore_lockout_victim_is_initialized(1);
+    if (*core1_parked) {
+        multicore_lockout_start_blocking();
+        if (park_hook != NULL) park_hook();
+    }
+    return save_and_disable_interrupts();
+}
+
+static void flash_io_unlock(uint32_t irq_state, bool core1_parked) {
+    restore_interrupts(irq_state);
+    if (core1_parked) multicore_lockout_end_blocking();
+}
+
+uint32_t flash_io_erase(uint32_t offset) {
+    uint32_t start = time_us_32();
+    bool core1_parked;
+    uint32_t irq_state = flash_io_lock(&core1_parked);
+    flash_io_erase_locked(offset);
+    flash_io_unlock(irq_state, core1_parked);
+    return time_us_32() - start;
+}
+
+uint32_t flash_io_program(uint32_t offset, const uint8_t* data, uint32_t size) {
+    uint32_t start = time_us_32();
+    bool core1_parked;
+    uint32_t irq_state = flash_io_lock(&core1_parked);
+    flash_io_program_locked(offset, data, size);
+    flash_io_unlock(irq_state, core1_parked);
+    return time_us_32() - start;
+}
+
+uint32_t flash_io_crc32(const uint8_t* data, uint32_t size) {
+    static uint8_t sink;
+    int channel = dma_claim_unused_channel(true);
+
+    // Stream the bytes into a dummy sink; the sniffer sees every one
+    dma_channel_config config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_sniff_enable(&config, true);
+
+    dma_sniffer_set_data_accumulator(0xFFFFFFFFu);
+    dma_sniffer_enable(channel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32, true);
+    dma_channel_configure(channel, &config, &sink, data, size, true);
+    dma_channel_wait_for_finish_blocking(channel);
+
+    uint32_t crc = dma_sniffer_get_data_accumulator();
+    dma_sniffer_disable();
+    dma_channel_unclaim(channel);
+    return crc;
+}
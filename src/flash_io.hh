@@ -0,0 +1,41 @@
+// flash_io.hh - Erasing and programming the on-board flash at run time
+//
+// While a sector is erased or a page programmed, flash cannot be read, so
+// nothing may execute from XIP on either core. These helpers run from RAM
+// with interrupts off and, once it runs, core 1 parked through multicore
+// lockout (core 1 must call multicore_lockout_victim_init()). Each returns
+// the stall in microseconds so callers can report it.
+#ifndef FLASH_IO_HH
+#define FLASH_IO_HH
+
+#include <stdint.h>
+#include "hardware/flash.h"
+
+// Layout of the reserved sectors at the end of flash. Snapshots alternate
+// between two sectors; the second sits below the settings store so that
+// stays where earlier builds put it.
+#define FLASH_SNAPSHOT_OFFSET   (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define FLASH_KV_OFFSET         (PICO_FLASH_SIZE_BYTES - 3 * FLASH_SECTOR_SIZE)  // 2 sectors
+#define FLASH_SNAPSHOT_OFFSET_2 (PICO_FLASH_SIZE_BYTES - 4 * FLASH_SECTOR_SIZE)
+
+// Run on core 0 each time core 1 has just been parked, before flash goes
+// offline. Core 1 may be stopped mid-way through lighting a panel row, so
+// this is where the panel is blanked. NULL for none.
+typedef void (*FlashParkHook)();
+void flash_io_set_park_hook(FlashParkHook hook);
+
+// Memory-mapped view of a flash offset
+const uint8_t* flash_io_read(uint32_t offset);
+
+// Erase one sector (offset sector-aligned)
+uint32_t flash_io_erase(uint32_t offset);
+
+// Program whole pages (offset and size FLASH_PAGE_SIZE multiples) that
+// have been erased since they were last written
+uint32_t flash_io_program(uint32_t offset, const uint8_t* data, uint32_t size);
+
+// CRC-32/MPEG-2 (poly 0x04C11DB7, init 0xFFFFFFFF, no reflection), computed
+// by the DMA sniffer. Works on RAM and on XIP flash alike.
+uint32_t flash_io_crc32(const uint8_t* data, uint32_t size);
+
+#endif // FLASH_IO_HH
@@ -0,0 +1,228 @@
+// frame_stream.cpp - Live framebuffer streaming over USB CDC
+#include "frame_stream.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "flash_io.hh"
+#include "cobs.hh"
+
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#include "tusb.h"
+#endif
+
+#define FRAME_PIXELS (MATRIX_ROWS * MATRIX_COLS)
+
+// Fill runs shorter than this are cheaper as literals
+#define FRAME_STREAM_MIN_FILL   3
+
+// The packet is built FRAME_STREAM_COBS_SLACK bytes into the buffer and
+// COBS-framed in place towards the front
+#define FRAME_STREAM_COBS_SLACK (COBS_FRAMED_SIZE(FRAME_STREAM_MAX_PACKET) - FRAME_STREAM_MAX_PACKET)
+
+static uint8_t  wire[FRAME_STREAM_COBS_SLACK + FRAME_STREAM_MAX_PACKET];
+static uint32_t wire_size;          // Framed bytes of the pending packet
+static uint32_t wire_sent;          // Of those, handed to USB so far
+
+static Color    last_sent[FRAME_PIXELS];
+static bool     have_base;          // last_sent is what the decoder holds
+static uint16_t sequence;
+static uint32_t frames_since_key;
+
+static bool     usb_available;
+static uint8_t  rate_hz;
+static uint32_t next_capture_us;
+static FrameStreamStats stats;
+
+void frame_stream_init(uint8_t rate) {
+#if LIB_PICO_STDIO_USB
+    usb_available = true;
+#else
+    usb_available = false;
+    if (rate > 0) printf("Frame stream: this build has no USB stdio, streaming off\n");
+#endif
+    frame_stream_set_rate(rate);
+}
+
+void frame_stream_set_rate(uint8_t rate) {
+    rate_hz = usb_available ? rate : 0;
+    next_capture_us = time_us_32();
+    have_base = false;
+}
+
+uint8_t frame_stream_rate() {
+    return rate_hz;
+}
+
+bool frame_stream_due() {
+    return rate_hz != 0 && (int32_t)(time_us_32() - next_capture_us) >= 0;
+}
+
+bool frame_stream_sending() {
+    return wire_sent > 0 && wire_sent < wire_size;
+}
+
+const FrameStreamStats* frame_stream_stats() {
+    return &stats;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+static inline uint8_t* put_varint(uint8_t* p, uint32_t value) {
+    while (value >= 0x80) {
+        *p++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *p++ = (uint8_t)value;
+    return p;
+}
+
+static inline uint8_t* put_color(uint8_t* p, Color c) {
+    p[0] = c.r;
+    p[1] = c.g;
+    p[2] = c.b;
+    return p + 3;
+}
+
+static inline bool same_color(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// Spans for every pixel that differs from `base` (or from black on a
+// keyframe, which the decoder clears to first)
+static uint8_t* encode_spans(uint8_t* p, const Color* pixels, bool keyframe) {
+    const Color black = {0, 0, 0};
+    uint32_t skip = 0;
+    int i = 0;
+
+    while (i < FRAME_PIXELS) {
+        Color reference = keyframe ? black : last_sent[i];
+        if (same_color(pixels[i], reference)) {
+            skip++;
+            i++;
+            continue;
+        }
+
+        // Extent of this run of changed pixels
+        int end = i + 1;
+        while (end < FRAME_PIXELS &&
+               !same_color(pixels[end], keyframe ? black : last_sent[end])) {
+            end++;
+        }
+
+        // Split it into fills (a repeated colour) and literals
+        while (i < end) {
+            int fill = i + 1;
+            while (fill < end && same_color(pixels[fill], pixels[i])) fill++;
+
+            int count;
+            if (fill - i >= FRAME_STREAM_MIN_FILL) {
+                count = fill - i;
+                p = put_varint(p, skip);
+                p = put_varint(p, ((uint32_t)count << 1) | 1);
+                p = put_color(p, pixels[i]);
+            } else {
+                // Literal up to the next fill worth taking
+                int stop = i + 1;
+                while (stop < end) {
+                    int run = stop + 1;
+                    while (run < end && run - stop < FRAME_STREAM_MIN_FILL &&
+                           same_color(pixels[run], pixels[stop])) {
+                        run++;
+                    }
+                    if (run - stop >= FRAME_STREAM_MIN_FILL) break;
+                    stop++;
+                }
+                count = stop - i;
+                p = put_varint(p, skip);
+                p = put_varint(p, (uint32_t)count << 1);
+                for (int k = i; k < stop; k++) p = put_color(p, pixels[k]);
+            }
+            skip = 0;
+            i += count;
+        }
+    }
+    return p;
+}
+
+bool frame_stream_capture(const Color* pixels, uint32_t tick) {
+    if (rate_hz == 0) return false;
+
+    uint32_t now = time_us_32();
+    if ((int32_t)(now - next_capture_us) < 0) return false;
+    if (wire_sent < wire_size) {
+        stats.skipped++;
+        return false;
+    }
+    next_capture_us += 1000000u / rate_hz;
+    if ((int32_t)(now - next_capture_us) > 0) next_capture_us = now;  // Fell behind
+
+    bool keyframe = !have_base || frames_since_key >= FRAME_STREAM_KEYFRAME_INTERVAL;
+    uint16_t base = sequence;
+    sequence++;
+
+    uint8_t* packet = wire + FRAME_STREAM_COBS_SLACK;
+    uint8_t* p = packet;
+    *p++ = keyframe ? FRAME_STREAM_KEYFRAME : FRAME_STREAM_DELTA;
+    *p++ = MATRIX_COLS;
+    *p++ = MATRIX_ROWS;
+    *p++ = 0;
+    *p++ = (uint8_t)sequence;
+    *p++ = (uint8_t)(sequence >> 8);
+    *p++ = (uint8_t)base;
+    *p++ = (uint8_t)(base >> 8);
+    for (int shift = 0; shift < 32; shift += 8) *p++ = (uint8_t)(tick >> shift);
+
+    p = encode_spans(p, pixels, keyframe);
+
+    uint32_t crc = flash_io_crc32(packet, (uint32_t)(p - packet));
+    for (int shift = 0; shift < 32; shift += 8) *p++ = (uint8_t)(crc >> shift);
+
+    wire_size = cobs_frame(wire, packet, (uint32_t)(p - packet));
+    wire_sent = 0;
+
+    memcpy(last_sent, pixels, sizeof(last_sent));
+    have_base = true;
+    frames_since_key = keyframe ? 1 : frames_since_key + 1;
+    if (keyframe) stats.keyframes++;
+    stats.last_packet = wire_size;
+    stats.capture_us = time_us_32() - now;
+    return true;
+}
+
+// ============================================================================
+// SENDING
+// ============================================================================
+
+void frame_stream_pump_until(absolute_time_t deadline) {
+#if LIB_PICO_STDIO_USB
+    while (wire_sent < wire_size && !time_reached(deadline)) {
+        if (!stdio_usb_connected()) {
+            // Nobody listening: drop it, and start over from a keyframe
+            stats.dropped++;
+            wire_sent = wire_size;
+            have_base = false;
+            break;
+        }
+
+        uint32_t room = tud_cdc_write_available();
+        if (room == 0) {
+            sleep_until(absolute_time_min(delayed_by_us(get_absolute_time(), 250), deadline));
+            continue;
+        }
+
+        uint32_t chunk = wire_size - wire_sent;
+        if (chunk > room) chunk = room;
+        stdio_usb.out_chars((const char*)wire + wire_sent, (int)chunk);
+        wire_sent += chunk;
+        if (wire_sent == wire_size) {
+            stats.frames++;
+            stats.bytes += wire_size;
+        }
+    }
+#endif
+    sleep_until(deadline);
+}
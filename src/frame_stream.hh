@@ -0,0 +1,82 @@
+// frame_stream.hh - Live framebuffer streaming over USB CDC
+//
+// At a configurable rate the finished frame is compared with the last frame
+// sent, and only the changed pixels go out, as run-length spans. Every
+// FRAME_STREAM_KEYFRAME_INTERVAL-th frame (and the first one) is a keyframe
+// coded against black, so a decoder that joins late or loses a packet
+// resyncs. gam4/frame_stream.py decodes the stream to PNGs or a window.
+//
+// Packet, little-endian, before framing:
+//   type u8 ('K' keyframe, 'D' delta), width u8, height u8, reserved u8,
+//   sequence u16, base u16 (sequence the delta applies to), tick u32,
+//   then spans until the crc:
+//     varint skip (unchanged pixels, raster order), varint count << 1 | fill,
+//     then one RGB triple if fill (count copies) else count triples
+//   crc u32: CRC-32/MPEG-2 of everything before it (flash_io_crc32)
+// Each packet is COBS-encoded and sent between two 0x00 bytes, so console
+// text on the same port lands in chunks of its own. Text printed while a
+// packet is still in flight corrupts that packet; its crc rejects it and
+// the decoder waits for the next keyframe.
+//
+// Capturing is a compare and copy of one frame. The bytes are written by
+// frame_stream_pump_until() in the idle time at the end of the main loop,
+// only as fast as the CDC FIFO drains, so USB never stalls the game. A
+// frame that comes due while the previous one is still in flight is skipped.
+#ifndef FRAME_STREAM_HH
+#define FRAME_STREAM_HH
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/time.h"
+#include "color.hh"
+#include "matrix.hh"
+
+// Rate used until one is saved under KV_KEY_FRAME_STREAM_HZ. Off by default,
+// since the packets are binary noise in a plain serial monitor.
+#ifndef FRAME_STREAM_DEFAULT_HZ
+#define FRAME_STREAM_DEFAULT_HZ         0
+#endif
+
+#define FRAME_STREAM_KEYFRAME_INTERVAL  64
+#define FRAME_STREAM_KEYFRAME           'K'
+#define FRAME_STREAM_DELTA              'D'
+#define FRAME_STREAM_HEADER_SIZE        12
+
+// Worst case: every other pixel changed, each a span of skip, count and
+// one triple (5 bytes)
+#define FRAME_STREAM_MAX_PACKET (FRAME_STREAM_HEADER_SIZE + MATRIX_ROWS * MATRIX_COLS * 5 + 4)
+
+typedef struct {
+    uint32_t frames;            // Packets fully handed to USB
+    uint32_t keyframes;
+    uint32_t skipped;           // Frames due while a packet was in flight
+    uint32_t dropped;           // Packets abandoned (host not connected)
+    uint32_t bytes;             // Framed bytes sent
+    uint32_t last_packet;       // Framed size of the last packet
+    uint32_t capture_us;        // Compare, encode and frame time of the last capture
+} FrameStreamStats;
+
+// Off if the build has no USB stdio. rate_hz 0 = off.
+void frame_stream_init(uint8_t rate_hz);
+void frame_stream_set_rate(uint8_t rate_hz);
+uint8_t frame_stream_rate();
+
+// Offer the finished frame (MATRIX_ROWS x MATRIX_COLS). Returns true if it
+// was taken; false if streaming is off, the frame is not due yet, or the
+// last packet is still being sent.
+bool frame_stream_capture(const Color* pixels, uint32_t tick);
+
+// Feed the pending packet to USB until it is sent or `deadline` passes,
+// then sleep out the rest. Use in place of the main loop's sleep.
+void frame_stream_pump_until(absolute_time_t deadline);
+
+// A frame would be captured now, if the last packet is out. Lets the
+// caller skip copying a frame it would not take.
+bool frame_stream_due();
+
+// A packet is partly written; anything else sent now would land inside it
+bool frame_stream_sending();
+
+const FrameStreamStats* frame_stream_stats();
+
+#endif // FRAME_STREAM_HH
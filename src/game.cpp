@@ -1,175 +1,26 @@
 // game.cpp - Core game implementation with IMPROVED RADAR
 #include "game_types.h"
+#include "targeting.h"
+#include "map_blob.h"
+#include "render_snapshot.h"
 
 #include <math.h>
 #include <string.h>
 #include <stdio.h>
 
-#include "matrix.hh"
-#include "sprites.hh"
-
-// Helper function to convert game TowerType to hardware HardwareTowerType
-static HardwareTowerType game_to_hardware_tower(TowerType game_type) {
-    switch (game_type) {
-        case TOWER_MACHINE_GUN: return MACHINE_GUN;
-        case TOWER_CANNON:      return CANNON;
-        case TOWER_SNIPER:      return SNIPER;
-        case TOWER_RADAR:       return RADAR;
-        case TOWER_BLANK:
-        default:                return BLANK;
-    }
-}
-
-void tower_draw(const Tower* tower) {
-    // For radar towers, draw range circle FIRST (under everything)
-    if (tower->is_radar) {
-        int radius = (int)(tower->range);
-        int cx = (int)tower->x;
-        int cy = (int)tower->y;
-        
-        // Draw green circle outline using midpoint circle algorithm
-        Color circle_color = {0, 120, 0};  // Green border
-        
-        int x = radius;
-        int y = 0;
-        int err = 0;
-        
-        while (x >= y) {
-            // Draw 8 symmetric points (single pixel outline)
-            int points[8][2] = {
-                {cx + x, cy + y}, {cx + y, cy + x},
-                {cx - y, cy + x}, {cx - x, cy + y},
-                {cx - x, cy - y}, {cx - y, cy - x},
-                {cx + y, cy - x}, {cx + x, cy - y}
-            };
-            
-            for (int i = 0; i < 8; i++) {
-                int px = points[i][0];
-                int py = points[i][1];
-                if (px >= 0 && px < MATRIX_WIDTH && py >= 0 && py < MATRIX_HEIGHT) {
-                    set_pixel(px, py, circle_color);
-                }
-            }
-            
-            if (err <= 0) {
-                y += 1;
-                err += 2 * y + 1;
-            }
-            
-            if (err > 0) {
-                x -= 1;
-                err -= 2 * x + 1;
-            }
-        }
-    }
-    
-    // Get the appropriate sprite based on tower type
-    HardwareTowerType hw_type = game_to_hardware_tower(tower->type);
-    const Color* sprite = get_sprite(hw_type);
-    
-    int base_x = (int)tower->x - 2;  // Center the 4x4 sprite
-    int base_y = (int)tower->y - 2;
-    
-    // Draw the 4x4 tower sprite
-    for (int dy = 0; dy < 4; dy++) {
-        for (int dx = 0; dx < 4; dx++) {
-            int px = base_x + dx;
-            int py = base_y + dy;
-            if (px >= 0 && px < MATRIX_WIDTH && py >= 0 && py < MATRIX_HEIGHT) {
-                Color pixel_color = sprite[dy * 4 + dx];
-                set_pixel(px, py, pixel_color);
-            }
-        }
-    }
-    
-    // Draw radar sweep line AFTER sprite (on top)
-    if (tower->is_radar) {
-        int cx = (int)tower->x;
-        int cy = (int)tower->y;
-        int sweep_length = (int)(tower->range) - 1;  // Stay inside circle
-        int end_x = cx + (int)(cosf(tower->radar_angle) * sweep_length);
-        int end_y = cy + (int)(sinf(tower->radar_angle) * sweep_length);
-        
-        // Draw sweep line in green
-        matrix_draw_line(cx, cy, end_x, end_y, Color(0, 200, 0));
-    }
-}
-
 void game_draw(const GameState* game) {
-    // Draw tower slots using sprite
-    const Color* slot_sprite = get_sprite_tower_slot();
-    
-    for (int i = 0; i < game->tower_slot_count; i++) {
-        int x = game->tower_slots[i].x;
-        int y = game->tower_slots[i].y;
-        
-        // Draw 4x4 tower slot sprite centered on slot position
-        for (int dy = 0; dy < 4; dy++) {
-            for (int dx = 0; dx < 4; dx++) {
-                int px = x + dx - 2;  // Center the sprite
-                int py = y + dy - 2;
-                if (px >= 0 && px < MATRIX_WIDTH && py >= 0 && py < MATRIX_HEIGHT) {
-                    // If slot is occupied, darken the sprite
-                    Color slot_color = slot_sprite[dy * 4 + dx];
-                    if (game->tower_slots[i].occupied) {
-                        slot_color.r /= 3;
-                        slot_color.g /= 3;
-                        slot_color.b /= 3;
-                    }
-                    set_pixel(px, py, slot_color);
-                }
-            }
-        }
-    }
-
-    // Draw towers
-    for (int i = 0; i < game->tower_count; i++) {
-        tower_draw(&game->towers[i]);
-    }
-
-    // Draw enemies
-    for (int i = 0; i < game->enemy_count; i++) {
-        enemy_draw(&game->enemies[i]);
-    }
-
-    // Draw projectiles
-    for (int i = 0; i < game->projectile_count; i++) {
-        projectile_draw(&game->projectiles[i]);
-    }
-}
-
-// Helper function to draw a line (needed for radar sweep)
-void matrix_draw_line(int x0, int y0, int x1, int y1, Color color) {
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-    
-    while (true) {
-        if (x0 >= 0 && x0 < MATRIX_WIDTH && y0 >= 0 && y0 < MATRIX_HEIGHT) {
-            set_pixel(x0, y0, color);
-        }
-        
-        if (x0 == x1 && y0 == y1) break;
-        
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
-    }
+    // Not reentrant. The device composes frames through a RenderExchange instead.
+    static RenderSnapshot snapshot;
+    snapshot.has_scenery = false;   // May be another game than last time
+    render_snapshot_capture(&snapshot, game, NULL);
+    render_snapshot_draw(&snapshot);
 }
 
 // ============================================================================
 // ENEMY STATS TABLE
 // ============================================================================
 
-const EnemyStats ENEMY_STATS_TABLE[] = {
+EnemyStats ENEMY_STATS_TABLE[] = {
     // ENEMY_SCOUT
     {
         .health = 3,
@@ -201,7 +52,8 @@ const EnemyStats ENEMY_STATS_TABLE[] = {
         .damage = 2,
         .invisible = false,
         .splits_on_death = true,
-        .split_count = 2
+        .split_count = 2,
+        .split_type = ENEMY_SCOUT
     },
     // ENEMY_GHOST
     {
@@ -220,7 +72,7 @@ const EnemyStats ENEMY_STATS_TABLE[] = {
 // TOWER STATS TABLE
 // ============================================================================
 
-const TowerStats TOWER_STATS_TABLE[] = {
+TowerStats TOWER_STATS_TABLE[] = {
     // TOWER_MACHINE_GUN
     {
         .cost = 50,
@@ -289,87 +141,101 @@ bool is_in_range(float x1, float y1, float x2, float y2, float range) {
     return distance_squared(x1, y1, x2, y2) <= range * range;
 }
 
+uint32_t seconds_to_ticks(float seconds) {
+    return (uint32_t)(seconds * SIM_TICK_HZ + 0.5f);
+}
+
 // ============================================================================
 // ENEMY IMPLEMENTATION
 // ============================================================================
 
-void enemy_init(Enemy* enemy, EnemyType type, float start_x, float start_y) {
+void enemy_init(EnemyStore* enemies, EnemyIndex index, EnemyType type) {
     const EnemyStats* stats = &ENEMY_STATS_TABLE[type];
 
-    enemy->x = start_x;
-    enemy->y = start_y;
-    enemy->speed = stats->speed;
-    enemy->health = stats->health;
-    enemy->max_health = stats->health;
-    enemy->type = type;
-    enemy->color = stats->color;
-    enemy->path_index = 0;
-    enemy->path_progress = 0.0f;
-    enemy->alive = true;
-    enemy->invisible = stats->invisible;
-    enemy->revealed = !stats->invisible;
-}
-
-void enemy_update(Enemy* enemy, float dt, GameState* game) {
-    if (!enemy->alive) return;
-
-    if (enemy->path_index + 1 >= game->path_length) {
-        // Reached end of path
-        enemy->alive = false;
-        const EnemyStats* stats = &ENEMY_STATS_TABLE[enemy->type];
-        if (game->lives > stats->damage) {
-            game->lives -= stats->damage;
-        } else {
-            game->lives = 0;
-        }
-        return;
-    }
-
-    // Current and next waypoint
-    int16_t x1 = game->path[enemy->path_index].x;
-    int16_t y1 = game->path[enemy->path_index].y;
-    int16_t x2 = game->path[enemy->path_index + 1].x;
-    int16_t y2 = game->path[enemy->path_index + 1].y;
+    enemies->x[index] = 0.0f;
+    enemies->y[index] = 0.0f;
+    enemies->progress[index] = 0.0f;
+    enemies->speed[index] = stats->speed;
+    enemies->health[index] = (int16_t)stats->health;
+    enemies->type[index] = (uint8_t)type;
+    enemies->segment[index] = 0;
+    enemies->flags[index] = stats->invisible ? ENEMY_FLAG_INVISIBLE : 0;
+}
 
-    float dx = (float)(x2 - x1);
-    float dy = (float)(y2 - y1);
-    float segment_length = sqrtf(dx * dx + dy * dy);
-    if (segment_length == 0.0f) segment_length = 0.0001f;
+void enemies_update(GameState* game, float dt) {
+    EnemyStore* enemies = &game->enemies;
+    const PathGeometry* geom = &game->path_geometry;
 
-    float vx = dx / segment_length;
-    float vy = dy / segment_length;
+    // Position is derived purely from progress along the precomputed path.
+    // Advance every slot in one straight-line pass (free slots have zero
+    // speed) so the loop has no branches and only touches two arrays.
+    for (int i = 0; i < MAX_ENEMIES; i++) {
+        enemies->progress[i] += enemies->speed[i] * dt;
+    }
 
-    float move_dist = enemy->speed * dt;
-    enemy->x += vx * move_dist;
-    enemy->y += vy * move_dist;
-    enemy->path_progress += move_dist;
+    for (int i = mask_next(enemies->pool.alive, MAX_ENEMIES, 0); i >= 0;
+         i = mask_next(enemies->pool.alive, MAX_ENEMIES, i + 1)) {
+        if (enemies->progress[i] >= geom->total_length) {
+            enemy_reach_exit(game, (EnemyIndex)i);
+            continue;
+        }
 
-    float dist_to_next = distance(enemy->x, enemy->y, x2, y2);
-    if (dist_to_next < 0.5f) {
-        enemy->path_index++;
+        path_point_at(geom, game->path, enemies->progress[i],
+                      &enemies->segment[i], &enemies->x[i], &enemies->y[i]);
+        spatial_grid_update(&game->enemy_grid, (EnemyIndex)i, enemies->x[i], enemies->y[i]);
     }
+}
 
-    if (enemy->health <= 0) {
-        enemy->alive = false;
+void enemy_reach_exit(GameState* game, EnemyIndex index) {
+    const EnemyStats* stats = &ENEMY_STATS_TABLE[game->enemies.type[index]];
+    if (game->lives > stats->damage) {
+        game->lives -= stats->damage;
+    } else {
+        game->lives = 0;
     }
+    enemy_despawn(game, index);
 }
 
-void enemy_draw(const Enemy* enemy) {
-    if (!enemy->alive) return;
+void enemy_despawn(GameState* game, EnemyIndex index) {
+    EnemyStore* enemies = &game->enemies;
+    if (!pool_is_alive(&enemies->pool, index)) return;
 
-    int x = (int)enemy->x;
-    int y = (int)enemy->y;
+    pool_free(&enemies->pool, index);
+    enemies->speed[index] = 0.0f;
+    spatial_grid_remove(&game->enemy_grid, index);
 
-    if (x < 0 || x >= MATRIX_WIDTH || y < 0 || y >= MATRIX_HEIGHT) {
-        return;
+    for (int k = 0; k < game->enemy_count; k++) {
+        if (game->enemy_order[k] == index) {
+            memmove(&game->enemy_order[k], &game->enemy_order[k + 1],
+                    (game->enemy_count - k - 1) * sizeof(EnemyIndex));
+            break;
+        }
     }
+    game->enemy_count--;
+}
 
-    // Ghost enemies are barely visible
-    if (enemy->invisible && !enemy->revealed) {
-        Color ghost_color = {enemy->color.r / 8, enemy->color.g / 8, enemy->color.b / 4};
-        set_pixel(x, y, ghost_color);
-    } else {
-        set_pixel(x, y, enemy->color);
+void enemy_apply_damage(GameState* game, EnemyIndex index, int damage) {
+    EnemyStore* enemies = &game->enemies;
+    if (!pool_is_alive(&enemies->pool, index)) return;
+
+    enemies->health[index] -= damage;
+    if (enemies->health[index] > 0) return;
+
+    const EnemyStats* stats = &ENEMY_STATS_TABLE[enemies->type[index]];
+    float progress = enemies->progress[index];
+
+    game->money += stats->reward;
+    game->score += stats->reward * 10;
+    GAME_LOG("KILL! +$%d +%d score\n", stats->reward, stats->reward * 10);
+    enemy_despawn(game, index);
+
+    // Children appear where the parent died, spaced back along the path
+    if (stats->splits_on_death) {
+        for (int i = 0; i < stats->split_count; i++) {
+            float child_progress = progress - (float)i;
+            if (child_progress < 0.0f) child_progress = 0.0f;
+            game_spawn_enemy_at(game, stats->split_type, child_progress);
+        }
     }
 }
 
@@ -377,259 +243,430 @@ void enemy_draw(const Enemy* enemy) {
 // TOWER IMPLEMENTATION
 // ============================================================================
 
-void tower_init(Tower* tower, TowerType type, int16_t x, int16_t y) {
-    const TowerStats* stats = &TOWER_STATS_TABLE[type];
+void tower_init(TowerStore* towers, uint8_t index, TowerType type, int16_t x, int16_t y) {
+    towers->x[index] = (float)x;
+    towers->y[index] = (float)y;
+    towers->type[index] = (uint8_t)type;
+    towers->ready_tick[index] = 0;
+    towers->coverage_count[index] = 0;
+}
 
-    tower->x = (float)x;
-    tower->y = (float)y;
-    tower->type = type;
-    tower->color = stats->color;
+void tower_compute_coverage(GameState* game, uint8_t index) {
+    TowerStore* towers = &game->towers;
+    ProgressInterval* coverage = towers->coverage[index];
+    uint8_t count = 0;
+
+    const PathGeometry* geom = &game->path_geometry;
+    float range = TOWER_STATS_TABLE[towers->type[index]].range;
+    float r_sq = range * range;
+
+    for (int s = 0; s < geom->segment_count; s++) {
+        float segment_start = geom->cumulative[s];
+        float length = geom->cumulative[s + 1] - segment_start;
+        float fx = (float)game->path[s].x - towers->x[index];
+        float fy = (float)game->path[s].y - towers->y[index];
+
+        // Solve |A + d*U - T|^2 = r^2 for distance d along the unit
+        // direction U, with d in [0, length]
+        float b = fx * geom->dir_x[s] + fy * geom->dir_y[s];
+        float c = fx * fx + fy * fy - r_sq;
+        float disc = b * b - c;
+        if (disc < 0.0f) continue;
+
+        float root = sqrtf(disc);
+        float d0 = -b - root;
+        float d1 = -b + root;
+        if (d0 < 0.0f) d0 = 0.0f;
+        if (d1 > length) d1 = length;
+        if (d0 > d1) continue;
+
+        float start = segment_start + d0;
+        float end = segment_start + d1;
+
+        // Join with the previous stretch when the path stays in range across
+        // a waypoint. If we run out of room, widen the last interval instead:
+        // targeting re-checks the real distance, so over-covering is safe.
+        if (count > 0) {
+            ProgressInterval* last = &coverage[count - 1];
+            if (start <= last->end + 0.001f || count == MAX_COVERAGE_INTERVALS) {
+                last->end = end;
+                continue;
+            }
+        }
 
-    tower->damage = stats->damage;
-    tower->range = stats->range;
-    tower->fire_rate = stats->fire_rate;
-    tower->projectile_speed = stats->projectile_speed;
-    tower->splash_radius = stats->splash_radius;
+        coverage[count].start = start;
+        coverage[count].end = end;
+        count++;
+    }
 
-    tower->time_since_shot = 0.0f;
-    tower->target_index = -1;
+    towers->coverage_count[index] = count;
+}
 
-    tower->can_see_invisible = stats->can_see_invisible;
-    tower->is_radar = stats->is_radar;
-    tower->radar_angle = 0.0f;
+// False if no shot was fired: the target cannot be reached, or every
+// projectile is in flight
+static bool tower_shoot(GameState* game, const TowerStats* stats,
+                        uint8_t index, EnemyIndex target_index) {
+    const TowerStore* towers = &game->towers;
+
+    return projectile_spawn(game,
+                     towers->x[index],
+                     towers->y[index],
+                     pool_handle(&game->enemies.pool, target_index),
+                     stats->damage,
+                     stats->projectile_speed,
+                     stats->splash_radius);
 }
 
-void tower_shoot(Tower* tower, uint8_t target_index, GameState* game) {
-    // Find free projectile slot
-    if (game->projectile_count >= MAX_PROJECTILES) return;
-
-    Projectile* proj = &game->projectiles[game->projectile_count];
-
-    Color proj_color = Color{255, 255, 0};  // Yellow projectiles
-    
-    // Store POINTER to enemy (via target position) instead of index
-    Enemy* target = &game->enemies[target_index];
-    
-    projectile_init(proj,
-                    tower->x,
-                    tower->y,
-                    target->x,  // Target X position
-                    target->y,  // Target Y position
-                    tower->damage,
-                    tower->projectile_speed,
-                    proj_color,
-                    tower->splash_radius);
+#define TICKS_NEVER         0xFFFFFFFFu
 
-    game->projectile_count++;
+// Radars act on hidden enemies; other towers on the ones they can see
+static inline bool tower_wants(const TowerStats* stats, uint8_t enemy_flags) {
+    bool hidden = (enemy_flags == ENEMY_FLAG_INVISIBLE);
+    if (stats->is_radar) return hidden;
+    return !hidden || stats->can_see_invisible;
 }
 
-void tower_update(Tower* tower, float dt, GameState* game) {
-    if (tower->is_radar) {
-        tower->radar_angle += 2.0f * dt;  // 2 rad/s
-        if (tower->radar_angle > 2.0f * 3.14159f) {
-            tower->radar_angle -= 2.0f * 3.14159f;
-        }
+// Ticks until an enemy enters the tower's coverage (0 if already inside),
+// or TICKS_NEVER if it is past every covered stretch
+static uint32_t tower_arrival_ticks(const GameState* game, uint8_t index, EnemyIndex enemy) {
+    const TowerStore* towers = &game->towers;
+    float progress = game->enemies.progress[enemy];
+    float speed = game->enemies.speed[enemy];
+
+    for (int k = 0; k < towers->coverage_count[index]; k++) {
+        const ProgressInterval* iv = &towers->coverage[index][k];
+        if (progress > iv->end) continue;
+        if (progress >= iv->start) return 0;
+        if (speed <= 0.0f) return TICKS_NEVER;
+        return (uint32_t)ceilf((iv->start - progress) / speed * SIM_TICK_HZ);
+    }
 
-        // Reveal invisible enemies in range
-        for (int i = 0; i < game->enemy_count; i++) {
-            Enemy* enemy = &game->enemies[i];
-            if (!enemy->alive) continue;
-            if (!enemy->invisible) continue;
+    return TICKS_NEVER;
+}
 
-            if (is_in_range(tower->x, tower->y, enemy->x, enemy->y, tower->range)) {
-                enemy->revealed = true;
-            }
-        }
+// Arm the tower's timer for the earliest moment it could have something to
+// do, or let it sleep until a spawn or reveal wakes it (towers_notice_enemy)
+static void tower_schedule(GameState* game, uint8_t index) {
+    const TowerStore* towers = &game->towers;
+    const TowerStats* stats = &TOWER_STATS_TABLE[towers->type[index]];
 
-        return;
-    }
+    uint32_t soonest = TICKS_NEVER;
+    for (int k = 0; k < game->enemy_count; k++) {
+        EnemyIndex e = game->enemy_order[k];
+        if (!tower_wants(stats, game->enemies.flags[e])) continue;
 
-    tower->time_since_shot += dt;
+        uint32_t arrival = tower_arrival_ticks(game, index, e);
+        if (arrival < soonest) soonest = arrival;
+    }
 
-    if (tower->time_since_shot < tower->fire_rate) {
+    if (soonest == TICKS_NEVER) {
+        timer_cancel(&game->timers, TIMER_TOWER(index));
         return;
     }
 
-    int best_index = -1;
-    float best_progress = -1.0f;
+    // Never re-arm for the tick being processed
+    uint32_t wake = game->tick + (soonest > 0 ? soonest : 1);
+    if (wake < towers->ready_tick[index]) wake = towers->ready_tick[index];
+    timer_arm(&game->timers, TIMER_TOWER(index), wake);
+}
 
-    for (int i = 0; i < game->enemy_count; i++) {
-        Enemy* e = &game->enemies[i];
-        if (!e->alive) continue;
-        if (e->invisible && !tower->can_see_invisible && !e->revealed) continue;
+void towers_notice_enemy(GameState* game, EnemyIndex enemy_index) {
+    const TowerStore* towers = &game->towers;
+    uint8_t flags = game->enemies.flags[enemy_index];
 
-        if (is_in_range(tower->x, tower->y, e->x, e->y, tower->range)) {
-            if (e->path_progress > best_progress) {
-                best_progress = e->path_progress;
-                best_index = i;
-            }
+    for (int i = mask_next(towers->pool.alive, MAX_TOWERS, 0); i >= 0;
+         i = mask_next(towers->pool.alive, MAX_TOWERS, i + 1)) {
+        if (!tower_wants(&TOWER_STATS_TABLE[towers->type[i]], flags)) continue;
+
+        uint32_t arrival = tower_arrival_ticks(game, (uint8_t)i, enemy_index);
+        if (arrival == TICKS_NEVER) continue;
+
+        uint32_t wake = game->tick + arrival;
+        if (wake < towers->ready_tick[i]) wake = towers->ready_tick[i];
+
+        uint16_t timer = TIMER_TOWER(i);
+        if (!timer_is_armed(&game->timers, timer) || game->timers.due[timer] > wake) {
+            timer_arm(&game->timers, timer, wake);
         }
     }
+}
 
-    if (best_index != -1) {
-        tower->time_since_shot = 0.0f;
-        tower_shoot(tower, (uint8_t)best_index, game);
+// First position in enemy_order whose progress is >= / > the given value
+static inline int enemy_order_lower_bound(const GameState* game, float progress) {
+    int lo = 0;
+    int hi = game->enemy_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (game->enemies.progress[game->enemy_order[mid]] < progress) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
     }
+    return lo;
 }
 
-void draw_tower_range(int16_t x, int16_t y, float range) {
-    // Draw a circle showing the tower's range
-    // Using midpoint circle algorithm
-    int cx = x;
-    int cy = y;
-    int radius = (int)range;
-    
-    int dx = radius;
-    int dy = 0;
-    int err = 0;
-    
-    Color range_color = {80, 80, 80};  // Gray range indicator
-    
-    while (dx >= dy) {
-        // Draw 8 symmetric points
-        int points[8][2] = {
-            {cx + dx, cy + dy}, {cx + dy, cy + dx},
-            {cx - dy, cy + dx}, {cx - dx, cy + dy},
-            {cx - dx, cy - dy}, {cx - dy, cy - dx},
-            {cx + dy, cy - dx}, {cx + dx, cy - dy}
-        };
-        
-        for (int i = 0; i < 8; i++) {
-            int px = points[i][0];
-            int py = points[i][1];
-            if (px >= 0 && px < MATRIX_WIDTH && py >= 0 && py < MATRIX_HEIGHT) {
-                set_pixel(px, py, range_color);
-            }
-        }
-        
-        if (err <= 0) {
-            dy += 1;
-            err += 2 * dy + 1;
-        }
-        
-        if (err > 0) {
-            dx -= 1;
-            err -= 2 * dx + 1;
+static inline int enemy_order_upper_bound(const GameState* game, float progress) {
+    int lo = 0;
+    int hi = game->enemy_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (game->enemies.progress[game->enemy_order[mid]] <= progress) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
+    return lo;
 }
 
-// ============================================================================
-// PROJECTILE IMPLEMENTATION - FIXED VERSION
-// ============================================================================
+// kSeesInvisible is fixed per batch, so the test folds away for camo towers
+template <bool kSeesInvisible>
+static inline bool tower_can_target(uint8_t enemy_flags) {
+    return kSeesInvisible || enemy_flags != ENEMY_FLAG_INVISIBLE;
+}
 
-void projectile_init(Projectile* proj, float x, float y, 
-                     float target_x, float target_y,
-                     uint8_t damage, float speed, Color color, uint8_t splash) {
-    proj->x = x;
-    proj->y = y;
-    proj->target_x = target_x;  // Store target position
-    proj->target_y = target_y;
-    proj->damage = damage;
-    proj->speed = speed;
-    proj->color = color;
-    proj->splash_radius = splash;
-    proj->active = true;
-    
-    // Calculate direction to target
-    float dx = target_x - x;
-    float dy = target_y - y;
-    float dist = sqrtf(dx * dx + dy * dy);
-    
-    if (dist > 0.0f) {
-        proj->vx = (dx / dist) * speed;
-        proj->vy = (dy / dist) * speed;
+// Pick a target from the enemies inside the tower's coverage intervals,
+// using the progress-ordered enemy list, passing over those in `tried`.
+// Returns the enemy slot or -1.
+template <typename Policy, bool kSeesInvisible>
+static int tower_find_target(const GameState* game, uint8_t index, float range,
+                             const uint32_t* tried) {
+    const TowerStore* towers = &game->towers;
+    const EnemyStore* enemies = &game->enemies;
+    const ProgressInterval* coverage = towers->coverage[index];
+    int coverage_count = towers->coverage_count[index];
+    float tx = towers->x[index];
+    float ty = towers->y[index];
+
+    if constexpr (Policy::kScan == SCAN_FROM_END) {
+        for (int k = coverage_count - 1; k >= 0; k--) {
+            for (int pos = enemy_order_upper_bound(game, coverage[k].end) - 1; pos >= 0; pos--) {
+                int i = game->enemy_order[pos];
+                if (enemies->progress[i] < coverage[k].start) break;
+                if (!tower_can_target<kSeesInvisible>(enemies->flags[i])) continue;
+                if (mask_test(tried, i)) continue;
+                if (is_in_range(tx, ty, enemies->x[i], enemies->y[i], range)) return i;
+            }
+        }
+        return -1;
+    } else if constexpr (Policy::kScan == SCAN_FROM_START) {
+        for (int k = 0; k < coverage_count; k++) {
+            for (int pos = enemy_order_lower_bound(game, coverage[k].start);
+                 pos < game->enemy_count; pos++) {
+                int i = game->enemy_order[pos];
+                if (enemies->progress[i] > coverage[k].end) break;
+                if (!tower_can_target<kSeesInvisible>(enemies->flags[i])) continue;
+                if (mask_test(tried, i)) continue;
+                if (is_in_range(tx, ty, enemies->x[i], enemies->y[i], range)) return i;
+            }
+        }
+        return -1;
     } else {
-        proj->vx = 0.0f;
-        proj->vy = 0.0f;
+        // Score everything in range; walking from the end of the path makes
+        // ties go to the enemy furthest along
+        int best_index = -1;
+        float best_score = 0.0f;
+        for (int k = coverage_count - 1; k >= 0; k--) {
+            for (int pos = enemy_order_upper_bound(game, coverage[k].end) - 1; pos >= 0; pos--) {
+                int i = game->enemy_order[pos];
+                if (enemies->progress[i] < coverage[k].start) break;
+                if (!tower_can_target<kSeesInvisible>(enemies->flags[i])) continue;
+                if (mask_test(tried, i)) continue;
+                if (!is_in_range(tx, ty, enemies->x[i], enemies->y[i], range)) continue;
+
+                float score = Policy::score(enemies, i, tx, ty);
+                if (best_index == -1 || score > best_score) {
+                    best_index = i;
+                    best_score = score;
+                }
+            }
+        }
+        return best_index;
     }
 }
 
-bool projectile_update(Projectile* proj, float dt, GameState* game) {
-    if (!proj->active) return true;
-
-    // Move projectile
-    proj->x += proj->vx * dt;
-    proj->y += proj->vy * dt;
-
-    // Check if projectile hit any enemy
-    Enemy* hit_enemy = NULL;
-    int hit_index = -1;
-    float closest_dist = 1.0f;  // Hit radius
-    
-    for (int i = 0; i < game->enemy_count; i++) {
-        Enemy* e = &game->enemies[i];
-        if (!e->alive) continue;
-        
-        float dist = distance(proj->x, proj->y, e->x, e->y);
-        if (dist < closest_dist) {
-            closest_dist = dist;
-            hit_enemy = e;
-            hit_index = i;
+template <typename Policy, bool kSeesInvisible>
+static void towers_fire_batch_as(GameState* game, const TowerStats* stats,
+                                 const uint8_t* batch, int count) {
+    TowerStore* towers = &game->towers;
+    uint32_t cooldown = seconds_to_ticks(stats->fire_rate);
+
+    for (int b = 0; b < count; b++) {
+        uint8_t index = batch[b];
+
+        // A target the shot cannot reach (it leaves the path first) is
+        // passed over for the next one. With every projectile in flight no
+        // shot can fire, so the tower just tries again later.
+        uint32_t tried[MASK_WORDS(MAX_ENEMIES)] = {0};
+        bool fired = false;
+        while (!fired && game->projectile_count < MAX_PROJECTILES) {
+            int target = tower_find_target<Policy, kSeesInvisible>(game, index, stats->range,
+                                                                   tried);
+            if (target < 0) break;
+            fired = tower_shoot(game, stats, index, (EnemyIndex)target);
+            mask_set(tried, target);
         }
-    }
 
-    // If we hit an enemy
-    if (hit_enemy != NULL) {
-        // Damage the target
-        hit_enemy->health -= proj->damage;
-        
-        printf("HIT! Enemy %d took %d damage (HP: %d/%d)\n", 
-               hit_index, proj->damage, hit_enemy->health, hit_enemy->max_health);
-        
-        if (hit_enemy->health <= 0) {
-            hit_enemy->alive = false;
-            const EnemyStats* stats = &ENEMY_STATS_TABLE[hit_enemy->type];
-            game->money += stats->reward;
-            game->score += stats->reward * 10;
-            printf("KILL! +$%d +%d score\n", stats->reward, stats->reward * 10);
+        // The cooldown only starts with a shot
+        if (fired) {
+            towers->ready_tick[index] = game->tick + cooldown;
+            timer_arm(&game->timers, TIMER_TOWER(index), towers->ready_tick[index]);
+        } else {
+            tower_schedule(game, index);
         }
+    }
+}
 
-        // Splash damage
-        if (proj->splash_radius > 0) {
-            float splash_r = (float)proj->splash_radius;
-            for (int i = 0; i < game->enemy_count; i++) {
-                if (i == hit_index) continue;  // Already damaged
-                Enemy* e = &game->enemies[i];
-                if (!e->alive) continue;
-                
-                if (distance(proj->x, proj->y, e->x, e->y) <= splash_r) {
-                    e->health -= proj->damage;
-                    printf("SPLASH! Enemy %d took %d damage\n", i, proj->damage);
-                    
-                    if (e->health <= 0) {
-                        e->alive = false;
-                        const EnemyStats* stats = &ENEMY_STATS_TABLE[e->type];
-                        game->money += stats->reward;
-                        game->score += stats->reward * 10;
-                    }
-                }
+// Shooting towers of one type whose timers fired this tick
+template <typename Policy>
+static void towers_fire_batch(GameState* game, TowerType type, const uint8_t* batch, int count) {
+    const TowerStats* stats = &TOWER_STATS_TABLE[type];
+
+    if (stats->can_see_invisible) {
+        towers_fire_batch_as<Policy, true>(game, stats, batch, count);
+    } else {
+        towers_fire_batch_as<Policy, false>(game, stats, batch, count);
+    }
+}
+
+// Radars whose timers fired this tick: reveal invisible enemies in range
+static void radars_update_batch(GameState* game, TowerType type, const uint8_t* batch, int count) {
+    const TowerStore* towers = &game->towers;
+    EnemyStore* enemies = &game->enemies;
+    float range = TOWER_STATS_TABLE[type].range;
+
+    for (int b = 0; b < count; b++) {
+        uint8_t index = batch[b];
+        float tx = towers->x[index];
+        float ty = towers->y[index];
+
+        EnemyIndex* candidates = game->grid_hits;
+        uint16_t n = spatial_grid_query(&game->enemy_grid, tx, ty,
+                                        range, candidates, MAX_ENEMIES);
+        for (int c = 0; c < n; c++) {
+            int i = candidates[c];
+            if (enemies->flags[i] != ENEMY_FLAG_INVISIBLE) continue;
+
+            if (is_in_range(tx, ty, enemies->x[i], enemies->y[i], range)) {
+                enemies->flags[i] |= ENEMY_FLAG_REVEALED;
+                towers_notice_enemy(game, (EnemyIndex)i);
             }
         }
 
-        proj->active = false;
-        return true;
+        tower_schedule(game, index);
     }
+}
+
+typedef void (*TowerBatchFn)(GameState* game, TowerType type, const uint8_t* batch, int count);
+
+// Behaviour and targeting policy (targeting.h) per tower type. Each entry is
+// its own instantiation, so a new type never adds branches to the others.
+static const TowerBatchFn TOWER_BATCH_TABLE[GAME_TOWER_TYPE_COUNT] = {
+    towers_fire_batch<TOWER_MACHINE_GUN_TARGETING>,
+    towers_fire_batch<TOWER_CANNON_TARGETING>,
+    towers_fire_batch<TOWER_SNIPER_TARGETING>,
+    radars_update_batch                 // TOWER_RADAR
+};
+
+// Every policy is compiled in every build, whichever ones the table picks,
+// so a choice made with build flags cannot have rotted. The optimizer
+// drops the unused ones.
+template void towers_fire_batch<TargetFirst>(GameState*, TowerType, const uint8_t*, int);
+template void towers_fire_batch<TargetLast>(GameState*, TowerType, const uint8_t*, int);
+template void towers_fire_batch<TargetStrongest>(GameState*, TowerType, const uint8_t*, int);
+template void towers_fire_batch<TargetClosest>(GameState*, TowerType, const uint8_t*, int);
+template void towers_fire_batch<TargetCamoPriority>(GameState*, TowerType, const uint8_t*, int);
 
-    // Check if projectile is out of bounds
-    if (proj->x < -5 || proj->x > MATRIX_WIDTH + 5 ||
-        proj->y < -5 || proj->y > MATRIX_HEIGHT + 5) {
-        proj->active = false;
-        return true;
+// ============================================================================
+// PROJECTILE IMPLEMENTATION
+// ============================================================================
+
+bool projectile_spawn(GameState* game, float x, float y, EntityHandle target,
+                      uint8_t damage, float speed, uint8_t splash) {
+    ProjectileStore* projs = &game->projectiles;
+    const EnemyStore* enemies = &game->enemies;
+
+    int target_index = pool_resolve(&enemies->pool, target);
+    if (target_index < 0) return false;
+
+    // Enemies move deterministically along the path, so solve where the
+    // shot meets the target now and schedule the impact for that time
+    float flight_time, impact_x, impact_y;
+    if (!path_intercept(&game->path_geometry, game->path,
+                        enemies->progress[target_index], enemies->speed[target_index],
+                        x, y, speed, &flight_time, &impact_x, &impact_y)) {
+        return false;  // Target escapes before the shot could land
     }
 
+    // Find free projectile slot
+    int index = pool_alloc(&projs->pool);
+    if (index < 0) return false;
+
+    projs->origin_x[index] = x;
+    projs->origin_y[index] = y;
+    projs->impact_x[index] = impact_x;
+    projs->impact_y[index] = impact_y;
+    uint32_t flight_ticks = seconds_to_ticks(flight_time);
+    projs->launch_tick[index] = game->tick;
+    projs->impact_tick[index] = game->tick + (flight_ticks > 0 ? flight_ticks : 1);
+    projs->target[index] = target;
+    projs->damage[index] = damage;
+    projs->splash_radius[index] = splash;
+    timer_arm(&game->timers, TIMER_PROJECTILE(index), projs->impact_tick[index]);
+
+    game->projectile_count++;
     return true;
 }
 
-void projectile_draw(const Projectile* proj) {
-    if (!proj->active) return;
-
-    int x = (int)proj->x;
-    int y = (int)proj->y;
+static void projectile_despawn(GameState* game, uint8_t index) {
+    timer_cancel(&game->timers, TIMER_PROJECTILE(index));
+    pool_free(&game->projectiles.pool, index);
+    game->projectile_count--;
+}
 
-    if (x >= 0 && x < MATRIX_WIDTH && y >= 0 && y < MATRIX_HEIGHT) {
-        set_pixel(x, y, proj->color);
+// Resolves a projectile when its impact timer fires
+void projectile_impact(GameState* game, uint8_t index) {
+    ProjectileStore* projs = &game->projectiles;
+    const EnemyStore* enemies = &game->enemies;
+
+    uint8_t damage = projs->damage[index];
+    float px = projs->impact_x[index];
+    float py = projs->impact_y[index];
+
+    // The target is where we predicted unless it died in the meantime, in
+    // which case the stale handle no longer resolves and the shot lands on
+    // empty path.
+    int hit_index = pool_resolve(&enemies->pool, projs->target[index]);
+    if (hit_index >= 0) {
+        px = enemies->x[hit_index];
+        py = enemies->y[hit_index];
+
+        GAME_LOG("HIT! Enemy %d took %d damage (HP: %d/%d)\n", 
+                 hit_index, damage, enemies->health[hit_index] - damage,
+                 ENEMY_STATS_TABLE[enemies->type[hit_index]].health);
+        enemy_apply_damage(game, (EnemyIndex)hit_index, damage);
+    }
+
+    // Splash damage
+    if (projs->splash_radius[index] > 0) {
+        float splash_r = (float)projs->splash_radius[index];
+        EnemyIndex* candidates = game->grid_hits;
+        uint16_t n = spatial_grid_query(&game->enemy_grid, px, py, splash_r,
+                                        candidates, MAX_ENEMIES);
+        for (int c = 0; c < n; c++) {
+            int i = candidates[c];
+            if (i == hit_index) continue;  // Already damaged
+            if (!pool_is_alive(&enemies->pool, i)) continue;
+
+            if (is_in_range(px, py, enemies->x[i], enemies->y[i], splash_r)) {
+                GAME_LOG("SPLASH! Enemy %d took %d damage\n", i, damage);
+                enemy_apply_damage(game, (EnemyIndex)i, damage);
+            }
+        }
     }
+
+    projectile_despawn(game, index);
 }
 
 // ============================================================================
@@ -637,49 +674,78 @@ void projectile_draw(const Projectile* proj) {
 // ============================================================================
 
 void game_init(GameState* game) {
-    // Zero-initialize all fields properly
+    // Zero-initialize all fields properly (free enemy slots keep zero speed)
+    memset(&game->enemies, 0, sizeof(game->enemies));
+    memset(&game->towers, 0, sizeof(game->towers));
+    memset(&game->projectiles, 0, sizeof(game->projectiles));
+    pool_init(&game->enemies.pool);
+    pool_init(&game->towers.pool);
+    pool_init(&game->projectiles.pool);
+    timer_queue_init(&game->timers);
     game->enemy_count = 0;
     game->tower_count = 0;
     game->projectile_count = 0;
     game->path_length = 0;
     game->tower_slot_count = 0;
+    spatial_grid_clear(&game->enemy_grid);
+    game_scenery_changed(game);     // Not reset, so a restart never reuses a revision
 
     game->money = 200;
     game->lives = 20;
     game->score = 0;
     game->game_time = 0.0f;
+    game->tick = 0;
+    game->tick_accumulator = 0.0f;
     game->wave_number = 0;
     game->total_waves = 6;
-
-    // Initialize simple path (right to left)
-    game->path[0] = {63, 15};
-    game->path[1] = {50, 15};
-    game->path[2] = {50, 25};
-    game->path[3] = {30, 25};
-    game->path[4] = {30, 10};
-    game->path[5] = {15, 10};
-    game->path[6] = {15, 20};
-    game->path[7] = {0, 20};
-    game->path_length = 8;
-
-    // Initialize tower slots
-    game->tower_slots[0] = {55, 8, false};
-    game->tower_slots[1] = {55, 22, false};
-    game->tower_slots[2] = {38, 18, false};
-    game->tower_slots[3] = {20, 6, false};
-    game->tower_slots[4] = {20, 28, false};
-    game->tower_slot_count = 5;
+    game->selected_tower = TOWER_MACHINE_GUN;
+
+    // Path, arc-length table and tower slots come from the default map blob,
+    // or failing that the first map that fits this build's panel
+    for (uint8_t m = 0; m < MAP_COUNT; m++) {
+        if (map_blob_load(game, m)) {
+            if (m != 0) printf("ERROR: Default map unusable, playing map %d instead\n", m);
+            return;
+        }
+    }
+    printf("ERROR: No map fits the %dx%d panel, rebuild the map blobs for it\n",
+           MATRIX_WIDTH, MATRIX_HEIGHT);
 }
 
 void game_spawn_enemy(GameState* game, EnemyType type) {
-    if (game->enemy_count >= MAX_ENEMIES) return;
+    game_spawn_enemy_at(game, type, 0.0f);
+}
 
-    Enemy* enemy = &game->enemies[game->enemy_count];
-    int16_t start_x = game->path[0].x;
-    int16_t start_y = game->path[0].y;
-    enemy_init(enemy, type, (float)start_x, (float)start_y);
+void game_spawn_enemy_at(GameState* game, EnemyType type, float progress) {
+    EnemyStore* enemies = &game->enemies;
+
+    int index = pool_alloc(&enemies->pool);
+    if (index < 0) return;
+
+    enemy_init(enemies, (EnemyIndex)index, type);
+    enemies->progress[index] = progress;
+    enemies->segment[index] = path_segment_at(&game->path_geometry, progress);
+    path_point_at(&game->path_geometry, game->path, progress,
+                  &enemies->segment[index], &enemies->x[index], &enemies->y[index]);
+    spatial_grid_insert(&game->enemy_grid, (EnemyIndex)index, enemies->x[index], enemies->y[index]);
+
+    // Keep enemy_order sorted: binary search for the insertion point
+    int pos = 0;
+    int hi = game->enemy_count;
+    while (pos < hi) {
+        int mid = (pos + hi) / 2;
+        if (enemies->progress[game->enemy_order[mid]] < progress) {
+            pos = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&game->enemy_order[pos + 1], &game->enemy_order[pos],
+            (game->enemy_count - pos) * sizeof(EnemyIndex));
+    game->enemy_order[pos] = (EnemyIndex)index;
 
     game->enemy_count++;
+    towers_notice_enemy(game, (EnemyIndex)index);
 }
 
 bool game_place_tower(GameState* game, TowerType type, int16_t x, int16_t y) {
@@ -702,59 +768,97 @@ bool game_place_tower(GameState* game, TowerType type, int16_t x, int16_t y) {
         return false;
     }
 
-    Tower* tower = &game->towers[game->tower_count];
-    tower_init(tower, type, x, y);
+    int index = pool_alloc(&game->towers.pool);
+    if (index < 0) return false;
+
+    tower_init(&game->towers, (uint8_t)index, type, x, y);
+    tower_compute_coverage(game, (uint8_t)index);
+
+    // First shot after one cooldown, as if the tower had just fired
+    game->towers.ready_tick[index] = game->tick + seconds_to_ticks(stats->fire_rate);
+    tower_schedule(game, (uint8_t)index);
 
     game->tower_slots[slot_index].occupied = true;
     game->tower_count++;
     game->money -= stats->cost;
+    game_scenery_changed(game);
     return true;
 }
 
-void game_update(GameState* game, float dt) {
-    game->game_time += dt;
+void game_scenery_changed(GameState* game) {
+    game->scenery_revision++;
+}
 
-    // Update towers (they shoot projectiles)
-    for (int i = 0; i < game->tower_count; i++) {
-        tower_update(&game->towers[i], dt, game);
+void game_retune(GameState* game) {
+    for (int i = mask_next(game->towers.pool.alive, MAX_TOWERS, 0); i >= 0;
+         i = mask_next(game->towers.pool.alive, MAX_TOWERS, i + 1)) {
+        tower_compute_coverage(game, (uint8_t)i);
+        tower_schedule(game, (uint8_t)i);
     }
+    game_scenery_changed(game);     // Radar ranges
+}
 
-    // Update projectiles (they move and check for hits)
-    for (int i = 0; i < game->projectile_count; i++) {
-        Projectile* proj = &game->projectiles[i];
-        if (!proj->active) continue;
-        projectile_update(proj, dt, game);
+void game_update(GameState* game, float dt) {
+    // Run as many fixed ticks as the elapsed real time covers
+    game->tick_accumulator += dt;
+    while (game->tick_accumulator >= SIM_DT) {
+        game->tick_accumulator -= SIM_DT;
+        game_step(game);
     }
+}
 
-    // Remove inactive projectiles
-    int write_index = 0;
-    for (int i = 0; i < game->projectile_count; i++) {
-        if (game->projectiles[i].active) {
-            if (write_index != i) {
-                game->projectiles[write_index] = game->projectiles[i];
+void game_step(GameState* game) {
+    game->tick++;
+    game->game_time = game->tick * SIM_DT;
+
+    game_step_timers(game);
+    enemies_update(game, SIM_DT);
+    game_step_order(game);
+}
+
+void game_step_timers(GameState* game) {
+    // Wake only the towers and projectiles that have something due: towers
+    // whose cooldown ended or whose next enemy arrives, and impacts. Impacts
+    // land first; due towers are grouped by type and run as one batch per
+    // type. A reveal or split can wake towers for this same tick, so repeat
+    // until nothing is due.
+    for (;;) {
+        uint8_t batch[GAME_TOWER_TYPE_COUNT][MAX_TOWERS];
+        uint8_t batch_count[GAME_TOWER_TYPE_COUNT] = {0};
+        bool woke = false;
+
+        int timer;
+        while ((timer = timer_pop_due(&game->timers, game->tick)) >= 0) {
+            if (timer < MAX_TOWERS) {
+                uint8_t type = game->towers.type[timer];
+                batch[type][batch_count[type]++] = (uint8_t)timer;
+                woke = true;
+            } else {
+                projectile_impact(game, (uint8_t)(timer - MAX_TOWERS));
             }
-            write_index++;
         }
-    }
-    game->projectile_count = write_index;
+        if (!woke) break;
 
-    // Update enemies (they move along path)
-    for (int i = 0; i < game->enemy_count; i++) {
-        Enemy* e = &game->enemies[i];
-        if (!e->alive) continue;
-        enemy_update(e, dt, game);
+        for (int t = 0; t < GAME_TOWER_TYPE_COUNT; t++) {
+            if (batch_count[t] > 0) {
+                TOWER_BATCH_TABLE[t](game, (TowerType)t, batch[t], batch_count[t]);
+            }
+        }
     }
+}
 
-    // Remove dead enemies
-    write_index = 0;
-    for (int i = 0; i < game->enemy_count; i++) {
-        Enemy* e = &game->enemies[i];
-        if (e->alive) {
-            if (write_index != i) {
-                game->enemies[write_index] = *e;
-            }
-            write_index++;
+void game_step_order(GameState* game) {
+    // Restore the progress order. Enemies rarely overtake each other, so
+    // insertion sort is ~linear here.
+    const float* progress = game->enemies.progress;
+    for (int k = 1; k < game->enemy_count; k++) {
+        EnemyIndex idx = game->enemy_order[k];
+        float p = progress[idx];
+        int j = k - 1;
+        while (j >= 0 && progress[game->enemy_order[j]] > p) {
+            game->enemy_order[j + 1] = game->enemy_order[j];
+            j--;
         }
+        game->enemy_order[j + 1] = idx;
     }
-    game->enemy_count = write_index;
-}
\ No newline at end of file
+}
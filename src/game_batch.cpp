@@ -0,0 +1,202 @@
+// game_batch.cpp - Lockstep stepping of many independent games
+#include "game_batch.h"
+
+#include <string.h>
+
+#if GAME_BATCH_AVX2
+#include <immintrin.h>
+#endif
+
+void game_batch_init(GameBatch* batch, GameState* const* games, uint16_t count, bool vector) {
+    memset(batch, 0, sizeof(*batch));
+    if (count > GAME_BATCH_MAX_LANES) count = GAME_BATCH_MAX_LANES;
+
+    for (uint16_t lane = 0; lane < count; lane++) {
+        batch->games[lane] = games[lane];
+    }
+    batch->count = count;
+    batch->vector = vector && GAME_BATCH_AVX2;
+}
+
+// ============================================================================
+// Control state across lanes
+// ============================================================================
+
+static void batch_advance_ticks(GameBatch* batch) {
+    for (uint16_t lane = 0; lane < batch->count; lane++) {
+        GameState* game = batch->games[lane];
+        game->tick++;
+        game->game_time = game->tick * SIM_DT;
+        batch->tick[lane] = game->tick;
+        batch->next_due[lane] = timer_next_due(&game->timers);
+    }
+}
+
+// Bit per lane whose earliest timer is due (next_due <= tick)
+static uint64_t batch_due_lanes(const GameBatch* batch) {
+    uint64_t mask = 0;
+    uint16_t lane = 0;
+
+#if GAME_BATCH_AVX2
+    if (batch->vector) {
+        // Unsigned a <= b is max(a, b) == b
+        for (; lane + 8 <= batch->count; lane += 8) {
+            __m256i due = _mm256_loadu_si256((const __m256i*)&batch->next_due[lane]);
+            __m256i tick = _mm256_loadu_si256((const __m256i*)&batch->tick[lane]);
+            __m256i ready = _mm256_cmpeq_epi32(_mm256_max_epu32(due, tick), tick);
+            mask |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(ready)) << lane;
+        }
+    }
+#endif
+
+    for (; lane < batch->count; lane++) {
+        if (batch->next_due[lane] <= batch->tick[lane]) mask |= 1ull << lane;
+    }
+    return mask;
+}
+
+// ============================================================================
+// Enemy movement
+// ============================================================================
+
+#if GAME_BATCH_AVX2
+static constexpr int log2_of(int n) {
+    return n > 1 ? 1 + log2_of(n / 2) : 0;
+}
+
+// Grid rows are a power of two cells wide, as every panel width is
+#define GRID_COLS_SHIFT     log2_of(GRID_COLS)
+static_assert((1 << GRID_COLS_SHIFT) == GRID_COLS, "cell = row * GRID_COLS + col uses a shift");
+
+// enemies_update() 8 slots at a time. Progress advances in every slot as in
+// the scalar pass; positions, segments and grid cells are computed for the
+// live slots of a block, then the block's exits and grid moves are applied
+// in ascending slot order, the order enemies_update() applies them in.
+static void batch_move_enemies(GameState* game) {
+    EnemyStore* enemies = &game->enemies;
+    const PathGeometry* geom = &game->path_geometry;
+
+    if (geom->segment_count == 0) {
+        enemies_update(game, SIM_DT);
+        return;
+    }
+
+    const __m256 dt = _mm256_set1_ps(SIM_DT);
+    const __m256 total_length = _mm256_set1_ps(geom->total_length);
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i last_segment = _mm256_set1_epi32(geom->segment_count - 1);
+    const __m256i max_col = _mm256_set1_epi32(GRID_COLS - 1);
+    const __m256i max_row = _mm256_set1_epi32(GRID_ROWS - 1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (int i = 0; i < MAX_ENEMIES; i += 8) {
+        __m256 progress = _mm256_add_ps(_mm256_loadu_ps(&enemies->progress[i]),
+                                        _mm256_mul_ps(_mm256_loadu_ps(&enemies->speed[i]), dt));
+        _mm256_storeu_ps(&enemies->progress[i], progress);
+
+        uint32_t alive = (enemies->pool.alive[i >> 5] >> (i & 31)) & 0xFF;
+        if (alive == 0) continue;
+
+        uint32_t exits = alive &
+            (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(progress, total_length, _CMP_GE_OQ));
+        uint32_t moving = alive & ~exits;
+
+        alignas(32) int32_t cells[8];
+        alignas(32) int32_t segments[8];
+        alignas(32) float xs[8];
+        alignas(32) float ys[8];
+
+        if (moving != 0) {
+            __m256i on = _mm256_cmpeq_epi32(
+                _mm256_and_si256(_mm256_set1_epi32((int)moving), lane_bits), lane_bits);
+            __m256 on_ps = _mm256_castsi256_ps(on);
+
+            // Walk segments forward while the next waypoint has been passed
+            __m256i segment = _mm256_and_si256(on, _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i*)&enemies->segment[i])));
+            for (;;) {
+                __m256 more = _mm256_castsi256_ps(
+                    _mm256_and_si256(on, _mm256_cmpgt_epi32(last_segment, segment)));
+                __m256 next_start = _mm256_mask_i32gather_ps(_mm256_setzero_ps(),
+                                                             geom->cumulative + 1,
+                                                             segment, more, 4);
+                __m256 advance = _mm256_and_ps(more,
+                                               _mm256_cmp_ps(progress, next_start, _CMP_GE_OQ));
+                if (_mm256_testz_ps(advance, advance)) break;
+                segment = _mm256_sub_epi32(segment, _mm256_castps_si256(advance));
+            }
+
+            __m256 start = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), geom->cumulative,
+                                                    segment, on_ps, 4);
+            __m256 dir_x = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), geom->dir_x,
+                                                    segment, on_ps, 4);
+            __m256 dir_y = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), geom->dir_y,
+                                                    segment, on_ps, 4);
+            __m256i waypoint = _mm256_mask_i32gather_epi32(zero, (const int*)game->path,
+                                                           segment, on, 4);
+            __m256 wx = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(waypoint, 16), 16));
+            __m256 wy = _mm256_cvtepi32_ps(_mm256_srai_epi32(waypoint, 16));
+
+            __m256 along = _mm256_sub_ps(progress, start);
+            __m256 x = _mm256_add_ps(wx, _mm256_mul_ps(dir_x, along));
+            __m256 y = _mm256_add_ps(wy, _mm256_mul_ps(dir_y, along));
+            _mm256_maskstore_ps(&enemies->x[i], on, x);
+            _mm256_maskstore_ps(&enemies->y[i], on, y);
+
+            // Grid bucket as grid_cell_of() computes it: truncate, shift,
+            // then clamp (negative coordinates land in column/row 0)
+            __m256i col = _mm256_srai_epi32(_mm256_cvttps_epi32(x), GRID_CELL_SHIFT);
+            __m256i row = _mm256_srai_epi32(_mm256_cvttps_epi32(y), GRID_CELL_SHIFT);
+            col = _mm256_min_epi32(_mm256_max_epi32(col, zero), max_col);
+            row = _mm256_min_epi32(_mm256_max_epi32(row, zero), max_row);
+            __m256i cell = _mm256_add_epi32(_mm256_slli_epi32(row, GRID_COLS_SHIFT), col);
+
+            _mm256_store_si256((__m256i*)cells, cell);
+            _mm256_store_si256((__m256i*)segments, segment);
+            _mm256_store_ps(xs, x);
+            _mm256_store_ps(ys, y);
+        }
+
+        for (uint32_t bits = alive; bits != 0; bits &= bits - 1) {
+            int lane = __builtin_ctz(bits);
+            EnemyIndex index = (EnemyIndex)(i + lane);
+
+            if (exits & (1u << lane)) {
+                enemy_reach_exit(game, index);
+                continue;
+            }
+            enemies->segment[index] = (uint8_t)segments[lane];
+            if (cells[lane] != game->enemy_grid.cell[index]) {
+                spatial_grid_update(&game->enemy_grid, index, xs[lane], ys[lane]);
+            }
+        }
+    }
+}
+#endif
+
+// ============================================================================
+// Step
+// ============================================================================
+
+void game_batch_step(GameBatch* batch) {
+    batch_advance_ticks(batch);
+
+    batch->due_mask = batch_due_lanes(batch);
+    for (uint64_t bits = batch->due_mask; bits != 0; bits &= bits - 1) {
+        game_step_timers(batch->games[__builtin_ctzll(bits)]);
+    }
+
+    for (uint16_t lane = 0; lane < batch->count; lane++) {
+#if GAME_BATCH_AVX2
+        if (batch->vector) {
+            batch_move_enemies(batch->games[lane]);
+            continue;
+        }
+#endif
+        enemies_update(batch->games[lane], SIM_DT);
+    }
+
+    for (uint16_t lane = 0; lane < batch->count; lane++) {
+        game_step_order(batch->games[lane]);
+    }
+}
@@ -0,0 +1,48 @@
+// game_batch.h - Lockstep stepping of many independent games
+//
+// A GameBatch advances N games (lanes) together, one tick at a time and one
+// phase of game_step() at a time across every lane, and leaves each game
+// bit-identical to calling game_step() on it alone. Per-lane control state
+// (tick, earliest timer) is lane-major, so finding the games with a tower
+// cooldown or impact due this tick is one vector compare per 8 lanes; the
+// rest skip the timer phase. Entity stores stay in each GameState, where
+// slots are contiguous: enemy movement, end-of-path tests and grid cell
+// range tests run 8 slots at a time with AVX2 when the build targets it
+// (-march=native on the host), and through enemies_update() otherwise.
+// The vector path does the same float operations in the same order (no
+// FMA), so both paths agree bit for bit.
+//
+// Callers drive waves and input per lane between steps, exactly as they
+// would around game_step().
+#ifndef GAME_BATCH_H
+#define GAME_BATCH_H
+
+#include "game_types.h"
+
+#define GAME_BATCH_MAX_LANES  64
+
+#if defined(__AVX2__) && (MAX_ENEMIES % 8 == 0)
+#define GAME_BATCH_AVX2       1
+#else
+#define GAME_BATCH_AVX2       0
+#endif
+
+typedef struct {
+    GameState* games[GAME_BATCH_MAX_LANES];
+    uint16_t   count;
+    bool       vector;                          // Use the AVX2 kernels
+
+    // Lane-major control state, refreshed every step
+    uint32_t   tick[GAME_BATCH_MAX_LANES];
+    uint32_t   next_due[GAME_BATCH_MAX_LANES];  // timer_next_due() per lane
+    uint64_t   due_mask;                        // Lanes that ran timers last step
+} GameBatch;
+
+// Group existing games into a batch (count <= GAME_BATCH_MAX_LANES). The
+// AVX2 kernels are used when the build has them unless `vector` is false.
+void game_batch_init(GameBatch* batch, GameState* const* games, uint16_t count, bool vector);
+
+// game_step() on every lane
+void game_batch_step(GameBatch* batch);
+
+#endif // GAME_BATCH_H
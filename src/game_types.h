@@ -5,17 +5,49 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "entity_pool.h"
+
 // Use the same Color type as the LED matrix library
 #include "color.hh"   // from lib/led_matrix/color.hh via PlatformIO's include paths
-
-// Configuration constants
-#define MAX_ENEMIES         50
+#include "panel.hh"
+
+// Configuration constants. Entity capacities can be overridden from
+// build_flags (e.g. -DMAX_ENEMIES=50 to match the original footprint).
+#ifndef MAX_ENEMIES
+#define MAX_ENEMIES         384     // Endless mode sustains 300+ on screen
+#endif
+#ifndef MAX_TOWERS
 #define MAX_TOWERS          10
+#endif
+#ifndef MAX_PROJECTILES
 #define MAX_PROJECTILES     30
+#endif
 #define MAX_PATH_WAYPOINTS  20
+#define MAX_COVERAGE_INTERVALS 8
+
+// The panel (lib/led_matrix/panel.hh); maps may be smaller
+#define MATRIX_WIDTH        MATRIX_COLS
+#define MATRIX_HEIGHT       MATRIX_ROWS
+
+// The simulation advances in fixed ticks; game_update() consumes real time
+// in SIM_DT steps so all scheduling can use integer tick counts.
+#define SIM_TICK_HZ         60
+#define SIM_DT              (1.0f / SIM_TICK_HZ)
+
+// Per-event gameplay chatter (kills, hits, spawns). Host tools that run many
+// games at once build with -DGAME_QUIET so threads do not contend on stdout.
+#ifdef GAME_QUIET
+#define GAME_LOG(...)       do { if (0) printf(__VA_ARGS__); } while (0)
+#else
+#define GAME_LOG(...)       printf(__VA_ARGS__)
+#endif
 
-#define MATRIX_WIDTH        64
-#define MATRIX_HEIGHT       32
+static_assert(MAX_ENEMIES < 0xFFFF, "enemy slots must fit EnemyIndex with GRID_NONE spare");
+static_assert(MAX_TOWERS <= 255 && MAX_PROJECTILES <= 255, "tower and projectile slots are uint8_t");
+
+// Enemy slot index. 16 bits so capacity is not tied to the byte-sized
+// counters used for towers and projectiles.
+typedef uint16_t EnemyIndex;
 
 // Global framebuffer (implemented in main.cpp)
 extern Color framebuffer[MATRIX_HEIGHT][MATRIX_WIDTH];
@@ -40,29 +72,30 @@ typedef struct {
     bool     invisible;
     bool     splits_on_death;
     uint8_t  split_count;
+    EnemyType split_type;
 } EnemyStats;
 
-// External declaration of enemy stats table (defined in game.cpp)
-extern const EnemyStats ENEMY_STATS_TABLE[];
-
-typedef struct {
-    float     x;
-    float     y;
-    float     speed;
-
-    int       health;
-    int       max_health;
-
-    EnemyType type;
-    Color     color;
+// External declaration of enemy stats table (defined in game.cpp). Kept in
+// RAM so it can be tuned live (telemetry.hh); see game_retune().
+extern EnemyStats ENEMY_STATS_TABLE[];
 
-    uint8_t   path_index;
-    float     path_progress;
+#define ENEMY_FLAG_INVISIBLE  0x01
+#define ENEMY_FLAG_REVEALED   0x02
 
-    bool      alive;
-    bool      invisible;
-    bool      revealed;
-} Enemy;
+// Structure-of-arrays enemy storage. A slot keeps its index for the enemy's
+// whole lifetime and `pool` hands out slots and handles. Per-type constants
+// (max health, colour, reward) are looked up in ENEMY_STATS_TABLE.
+typedef struct {
+    float     x[MAX_ENEMIES];
+    float     y[MAX_ENEMIES];
+    float     progress[MAX_ENEMIES];   // Distance travelled along the path
+    float     speed[MAX_ENEMIES];      // Zero in free slots
+    int16_t   health[MAX_ENEMIES];
+    uint8_t   type[MAX_ENEMIES];       // EnemyType
+    uint8_t   segment[MAX_ENEMIES];    // Path segment containing progress
+    uint8_t   flags[MAX_ENEMIES];      // ENEMY_FLAG_*
+    EntityPool<MAX_ENEMIES> pool;
+} EnemyStore;
 
 // ============================================================================
 // Tower system (game-level)
@@ -76,6 +109,8 @@ typedef enum {
     TOWER_BLANK  // No tower selected / invalid
 } TowerType;
 
+#define GAME_TOWER_TYPE_COUNT TOWER_BLANK
+
 typedef struct {
     uint8_t   cost;
     uint8_t   damage;
@@ -88,47 +123,50 @@ typedef struct {
     uint8_t   splash_radius;    // 0 = no splash
 } TowerStats;
 
-// External declaration of tower stats table (defined in game.cpp)
-extern const TowerStats TOWER_STATS_TABLE[];
+// External declaration of tower stats table (defined in game.cpp), in RAM
+// like ENEMY_STATS_TABLE
+extern TowerStats TOWER_STATS_TABLE[];
 
+// A stretch of the path, in path_progress units, that lies inside a range
 typedef struct {
-    float     x;
-    float     y;
+    float     start;
+    float     end;
+} ProgressInterval;
 
-    TowerType type;
-    Color     color;
+// Structure-of-arrays tower storage; stats come from TOWER_STATS_TABLE.
+typedef struct {
+    float     x[MAX_TOWERS];
+    float     y[MAX_TOWERS];
+    uint32_t  ready_tick[MAX_TOWERS];  // Cooldown ends (may fire from here on)
+    uint8_t   type[MAX_TOWERS];        // TowerType
 
-    uint8_t   damage;
-    float     range;
-    float     fire_rate;
-    float     projectile_speed;
-    uint8_t   splash_radius;
+    // Path stretches inside each tower's range, sorted and disjoint.
+    // Computed once at placement (see tower_compute_coverage).
+    ProgressInterval coverage[MAX_TOWERS][MAX_COVERAGE_INTERVALS];
+    uint8_t   coverage_count[MAX_TOWERS];
 
-    float     time_since_shot;
-    int8_t    target_index;
-
-    bool      can_see_invisible;
-    bool      is_radar;
-    float     radar_angle;
-} Tower;
+    EntityPool<MAX_TOWERS> pool;
+} TowerStore;
 
 // ============================================================================
-// Projectile system - FIXED VERSION
+// Projectile system
 // ============================================================================
 
+// Structure-of-arrays projectile storage with stable slots. The intercept
+// is solved when a shot is fired, so a projectile is just a scheduled
+// impact; its on-screen position is interpolated from origin to impact.
 typedef struct {
-    float     x;
-    float     y;
-    float     vx;          // Velocity X (direction * speed)
-    float     vy;          // Velocity Y (direction * speed)
-    float     target_x;    // Target position when fired
-    float     target_y;    // Target position when fired
-    uint8_t   damage;
-    float     speed;
-    Color     color;
-    uint8_t   splash_radius;  // 0 = no splash
-    bool      active;
-} Projectile;
+    float     origin_x[MAX_PROJECTILES];
+    float     origin_y[MAX_PROJECTILES];
+    float     impact_x[MAX_PROJECTILES];
+    float     impact_y[MAX_PROJECTILES];
+    uint32_t  launch_tick[MAX_PROJECTILES];
+    uint32_t  impact_tick[MAX_PROJECTILES];
+    EntityHandle target[MAX_PROJECTILES];     // Enemy aimed at, may go stale
+    uint8_t   damage[MAX_PROJECTILES];
+    uint8_t   splash_radius[MAX_PROJECTILES];  // 0 = no splash
+    EntityPool<MAX_PROJECTILES> pool;
+} ProjectileStore;
 
 // ============================================================================
 // Map & tower slots
@@ -145,30 +183,91 @@ typedef struct {
     bool    occupied;
 } TowerSlot;
 
+// Arc-length table for the path, built once per map (path_geometry.cpp).
+// Segment i runs from path[i] to path[i + 1].
+typedef struct {
+    float   cumulative[MAX_PATH_WAYPOINTS];  // path_progress at each waypoint
+    float   dir_x[MAX_PATH_WAYPOINTS];       // Unit direction of each segment
+    float   dir_y[MAX_PATH_WAYPOINTS];
+    float   total_length;
+    uint8_t segment_count;
+} PathGeometry;
+
 // ============================================================================
-// Game state
+// Spatial index (uniform grid over the playfield)
 // ============================================================================
 
+// 8x8-pixel buckets: 8 columns x 4 rows on the 64x32 field
+#define GRID_CELL_SHIFT     3
+#define GRID_CELL_SIZE      (1 << GRID_CELL_SHIFT)
+#define GRID_COLS           (MATRIX_WIDTH / GRID_CELL_SIZE)
+#define GRID_ROWS           (MATRIX_HEIGHT / GRID_CELL_SIZE)
+#define GRID_CELL_COUNT     (GRID_COLS * GRID_ROWS)
+#define GRID_NONE           0xFFFF  // No enemy (list terminator)
+#define GRID_NO_CELL        0xFF    // Enemy not in the grid
+
+// Intrusive doubly-linked list per bucket, indexed by enemy slot.
+// Entries only relink when an enemy crosses into a different bucket.
 typedef struct {
-    Enemy      enemies[MAX_ENEMIES];
-    uint8_t    enemy_count;
+    EnemyIndex head[GRID_CELL_COUNT];
+    EnemyIndex next[MAX_ENEMIES];
+    EnemyIndex prev[MAX_ENEMIES];
+    uint8_t    cell[MAX_ENEMIES];   // GRID_NO_CELL = not in the grid
+} SpatialGrid;
+
+// ============================================================================
+// Timer queue (wakes entities only when something is due)
+// ============================================================================
+
+// One fixed timer per tower and per projectile slot, so re-arming is an
+// in-place key change and the heap can never overflow.
+#define TIMER_TOWER(i)      (i)
+#define TIMER_PROJECTILE(i) (MAX_TOWERS + (i))
+#define MAX_TIMERS          (MAX_TOWERS + MAX_PROJECTILES)
+#define TIMER_UNARMED       0xFFFF
+#define TIMER_NEVER         0xFFFFFFFFu
 
-    Tower      towers[MAX_TOWERS];
+typedef struct {
+    uint32_t  due[MAX_TIMERS];    // Tick each armed timer fires on
+    uint16_t  heap[MAX_TIMERS];   // Timer ids, min-heap on due
+    uint16_t  pos[MAX_TIMERS];    // Heap position per timer, or TIMER_UNARMED
+    uint16_t  count;
+} TimerQueue;
+
+// ============================================================================
+// Game state
+// ============================================================================
+
+typedef struct {
+    EnemyStore enemies;
+    uint16_t   enemy_count;               // Live enemies
+    SpatialGrid enemy_grid;
+    EnemyIndex enemy_order[MAX_ENEMIES];  // Live enemy slots, ascending progress
+    EnemyIndex grid_hits[MAX_ENEMIES];    // spatial_grid_query() results, kept off
+                                          // the stack (core 0's is 2 KB)
+
+    TowerStore towers;
     uint8_t    tower_count;
 
-    Projectile projectiles[MAX_PROJECTILES];
-    uint8_t    projectile_count;
+    ProjectileStore projectiles;
+    uint8_t    projectile_count;          // Live projectiles
 
     PathPoint  path[MAX_PATH_WAYPOINTS];
     uint8_t    path_length;
+    PathGeometry path_geometry;
 
     TowerSlot  tower_slots[MAX_TOWERS];
     uint8_t    tower_slot_count;
+    uint8_t    map_index;                 // MAP_BLOBS entry in use
+    uint16_t   scenery_revision;          // Changes whenever slots or towers look different
 
-    uint16_t   money;
+    uint32_t   money;
     uint8_t    lives;
-    uint16_t   score;
-    float      game_time;
+    uint32_t   score;
+    float      game_time;                 // tick * SIM_DT, for display
+    uint32_t   tick;
+    float      tick_accumulator;          // Real time not yet simulated
+    TimerQueue timers;
 
     uint8_t    wave_number;
     uint8_t    total_waves;
@@ -181,44 +280,86 @@ typedef struct {
 // Function prototypes (implemented in game.cpp)
 // ============================================================================
 
-// Enemy functions
-void enemy_init(Enemy* enemy, EnemyType type, float start_x, float start_y);
-void enemy_update(Enemy* enemy, float dt, GameState* game);
-void enemy_draw(const Enemy* enemy);
+// Enemy functions (entities are addressed by their stable slot index)
+void enemy_init(EnemyStore* enemies, EnemyIndex index, EnemyType type);
+void enemies_update(GameState* game, float dt);
+void enemy_apply_damage(GameState* game, EnemyIndex index, int damage);
+void enemy_despawn(GameState* game, EnemyIndex index);
+void enemy_reach_exit(GameState* game, EnemyIndex index);  // Costs lives, then despawns
 
 // Tower functions
-void tower_init(Tower* tower, TowerType type, int16_t x, int16_t y);
-void tower_update(Tower* tower, float dt, GameState* game);
-void tower_draw(const Tower* tower);
-void draw_tower_range(int16_t x, int16_t y, float range);
-
-// Projectile functions - FIXED VERSION
-void projectile_init(Projectile* proj,
-                     float x,
-                     float y,
-                     float target_x,      // Changed from target_idx
-                     float target_y,      // Added target_y
-                     uint8_t damage,
-                     float speed,
-                     Color color,
-                     uint8_t splash);
-bool projectile_update(Projectile* proj, float dt, GameState* game);
-void projectile_draw(const Projectile* proj);
+void tower_init(TowerStore* towers, uint8_t index, TowerType type, int16_t x, int16_t y);
+void towers_notice_enemy(GameState* game, EnemyIndex enemy_index);
+void tower_compute_coverage(GameState* game, uint8_t index);
+
+// Projectile functions
+bool projectile_spawn(GameState* game,
+                      float x,
+                      float y,
+                      EntityHandle target,
+                      uint8_t damage,
+                      float speed,
+                      uint8_t splash);
+void projectile_impact(GameState* game, uint8_t index);
 
 // Game functions
 void game_init(GameState* game);
 void game_update(GameState* game, float dt);
+void game_step(GameState* game);
+// The phases of game_step() after the tick advances, in order (enemies_update
+// runs between them); game_batch.cpp interleaves them across games
+void game_step_timers(GameState* game);
+void game_step_order(GameState* game);
+// Slots, towers, enemies and projectiles over the current framebuffer
+// contents (implemented with render_snapshot.h)
 void game_draw(const GameState* game);
 bool game_place_tower(GameState* game, TowerType type, int16_t x, int16_t y);
+// Slots, towers or their ranges changed: renderers caching them must redraw
+void game_scenery_changed(GameState* game);
+// Recompute what placed towers derive from TOWER_STATS_TABLE (coverage,
+// wake-up timers) after the table was edited. Enemies already on the path
+// keep the health and speed they spawned with.
+void game_retune(GameState* game);
 void game_spawn_enemy(GameState* game, EnemyType type);
+void game_spawn_enemy_at(GameState* game, EnemyType type, float progress);
 void game_start_wave(GameState* game);
 
+// Path geometry (implemented in path_geometry.cpp)
+void path_geometry_build(PathGeometry* geom, const PathPoint* path, uint8_t path_length);
+uint8_t path_segment_at(const PathGeometry* geom, float progress);
+// Advances *segment forward until it contains `progress`, then writes the
+// point on the path. Cheap when the hint is already close (enemy motion).
+void path_point_at(const PathGeometry* geom, const PathPoint* path, float progress,
+                   uint8_t* segment, float* x, float* y);
+bool path_intercept(const PathGeometry* geom, const PathPoint* path,
+                    float progress, float enemy_speed,
+                    float sx, float sy, float shot_speed,
+                    float* time, float* x, float* y);
+
+// Timer queue (implemented in timer_queue.cpp)
+void timer_queue_init(TimerQueue* q);
+void timer_arm(TimerQueue* q, uint16_t id, uint32_t tick);
+void timer_cancel(TimerQueue* q, uint16_t id);
+bool timer_is_armed(const TimerQueue* q, uint16_t id);
+// Tick the earliest armed timer is due on, TIMER_NEVER when none is armed
+uint32_t timer_next_due(const TimerQueue* q);
+// Pops the earliest timer due at or before `now`; -1 when none is due
+int timer_pop_due(TimerQueue* q, uint32_t now);
+
+// Spatial index (implemented in spatial_grid.cpp)
+void spatial_grid_clear(SpatialGrid* grid);
+void spatial_grid_insert(SpatialGrid* grid, EnemyIndex index, float x, float y);
+void spatial_grid_remove(SpatialGrid* grid, EnemyIndex index);
+void spatial_grid_update(SpatialGrid* grid, EnemyIndex index, float x, float y);
+// Collects enemy indices from every bucket overlapping the circle's bounding
+// box, in bucket order. Candidates still need an exact range test.
+uint16_t spatial_grid_query(const SpatialGrid* grid, float x, float y, float radius,
+                            EnemyIndex* out, uint16_t max_out);
+
 // Utility
+uint32_t seconds_to_ticks(float seconds);
 float distance_squared(float x1, float y1, float x2, float y2);
 float distance(float x1, float y1, float x2, float y2);
 bool is_in_range(float x1, float y1, float x2, float y2, float range);
 
-// Line drawing utility for visual effects (e.g., radar sweep)
-void matrix_draw_line(int x0, int y0, int x1, int y1, Color color);
-
 #endif // GAME_TYPES_H
\ No newline at end of file
@@ -0,0 +1,224 @@
+// kv_store.cpp - Log-structured key-value store over two flash sectors
+#include "kv_store.hh"
+#include "flash_io.hh"
+
+#include <stdio.h>
+#include <string.h>
+
+#define KV_SECTOR_HEADER_SIZE   8   // magic u32, sequence u32
+#define KV_COMMIT_HEADER_SIZE   8   // tag u16, length u16, crc u32
+#define KV_ENTRY_OVERHEAD       2   // key u8, length u8
+
+// A full rewrite (sector header + one commit of every key) fits one page, so
+// neither a commit nor a compaction programs more than a page
+static_assert(KV_SECTOR_HEADER_SIZE + KV_COMMIT_HEADER_SIZE +
+              KV_KEY_COUNT * (KV_ENTRY_OVERHEAD + KV_MAX_VALUE) <= FLASH_PAGE_SIZE,
+              "KV store outgrew a flash page");
+
+static uint8_t __attribute__((aligned(4))) kv_page[FLASH_PAGE_SIZE];
+
+static inline uint32_t kv_sector_offset(uint8_t sector) {
+    return FLASH_KV_OFFSET + sector * FLASH_SECTOR_SIZE;
+}
+
+static inline uint32_t page_round_up(uint32_t offset) {
+    return (offset + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+}
+
+static inline uint16_t read_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t read_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void write_u16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void write_u32(uint8_t* p, uint32_t value) {
+    write_u16(p, (uint16_t)value);
+    write_u16(p + 2, (uint16_t)(value >> 16));
+}
+
+// Payload length of the valid commit at `offset`, or -1
+static int kv_commit_at(const uint8_t* sector, uint32_t offset) {
+    if (offset + KV_COMMIT_HEADER_SIZE > FLASH_SECTOR_SIZE) return -1;
+
+    const uint8_t* header = sector + offset;
+    uint16_t length = read_u16(header + 2);
+    if (read_u16(header) != KV_COMMIT_TAG ||
+        offset + KV_COMMIT_HEADER_SIZE + length > FLASH_SECTOR_SIZE) {
+        return -1;
+    }
+    if (flash_io_crc32(header + KV_COMMIT_HEADER_SIZE, length) != read_u32(header + 4)) {
+        return -1;
+    }
+    return length;
+}
+
+// A sector is live once its first commit (written with the header) is intact
+static bool kv_sector_valid(uint8_t sector) {
+    const uint8_t* data = flash_io_read(kv_sector_offset(sector));
+    return read_u32(data) == KV_SECTOR_MAGIC && kv_commit_at(data, KV_SECTOR_HEADER_SIZE) >= 0;
+}
+
+static void kv_apply(KvStore* kv, const uint8_t* payload, int length) {
+    int pos = 0;
+    while (pos + KV_ENTRY_OVERHEAD <= length) {
+        uint8_t key = payload[pos];
+        uint8_t value_length = payload[pos + 1];
+        pos += KV_ENTRY_OVERHEAD;
+        if (pos + value_length > length) break;
+
+        // Keys this build does not know are dropped at the next compaction
+        if (key < KV_KEY_COUNT && value_length <= KV_MAX_VALUE) {
+            KvEntry* entry = &kv->entries[key];
+            entry->present = true;
+            entry->length = value_length;
+            memcpy(entry->value, payload + pos, value_length);
+        }
+        pos += value_length;
+    }
+}
+
+// Append {key, length, value} for every entry selected by `all` or dirty
+static uint32_t kv_build_payload(const KvStore* kv, uint8_t* out, bool all) {
+    uint32_t size = 0;
+    for (int key = 0; key < KV_KEY_COUNT; key++) {
+        const KvEntry* entry = &kv->entries[key];
+        if (!entry->present || !(all || entry->dirty)) continue;
+
+        out[size++] = (uint8_t)key;
+        out[size++] = entry->length;
+        memcpy(out + size, entry->value, entry->length);
+        size += entry->length;
+    }
+    return size;
+}
+
+static void kv_write_commit_header(uint8_t* header, uint32_t payload_size) {
+    write_u16(header, KV_COMMIT_TAG);
+    write_u16(header + 2, (uint16_t)payload_size);
+    write_u32(header + 4, flash_io_crc32(header + KV_COMMIT_HEADER_SIZE, payload_size));
+}
+
+// Rewrite every key into the other sector. Returns the stall.
+static uint32_t kv_compact(KvStore* kv) {
+    uint8_t target = (uint8_t)(kv->active ^ 1);
+    uint32_t sequence = kv->sequence + 1;
+
+    memset(kv_page, 0xFF, sizeof(kv_page));
+    write_u32(kv_page, KV_SECTOR_MAGIC);
+    write_u32(kv_page + 4, sequence);
+    uint8_t* commit = kv_page + KV_SECTOR_HEADER_SIZE;
+    uint32_t payload_size = kv_build_payload(kv, commit + KV_COMMIT_HEADER_SIZE, true);
+    kv_write_commit_header(commit, payload_size);
+
+    uint32_t stall = flash_io_erase(kv_sector_offset(target));
+    stall += flash_io_program(kv_sector_offset(target), kv_page, FLASH_PAGE_SIZE);
+
+    kv->active = target;
+    kv->sequence = sequence;
+    kv->write_offset = FLASH_PAGE_SIZE;
+    kv->needs_compaction = false;
+    kv->compactions++;
+    return stall;
+}
+
+void kv_init(KvStore* kv) {
+    memset(kv, 0, sizeof(*kv));
+
+    bool valid[2] = {kv_sector_valid(0), kv_sector_valid(1)};
+    if (!valid[0] && !valid[1]) {
+        // First boot (or both sectors damaged): start an empty log in sector 0
+        kv->active = 1;
+        uint32_t stall = kv_compact(kv);
+        printf("Settings store formatted (%lu us)\n", (unsigned long)stall);
+        return;
+    }
+
+    uint32_t sequence[2] = {
+        read_u32(flash_io_read(kv_sector_offset(0)) + 4),
+        read_u32(flash_io_read(kv_sector_offset(1)) + 4)
+    };
+    if (valid[0] && valid[1]) {
+        kv->active = ((int32_t)(sequence[1] - sequence[0]) > 0) ? 1 : 0;
+    } else {
+        kv->active = valid[1] ? 1 : 0;
+    }
+    kv->sequence = sequence[kv->active];
+
+    // Replay commits until the first one that is missing or torn
+    const uint8_t* sector = flash_io_read(kv_sector_offset(kv->active));
+    uint32_t offset = KV_SECTOR_HEADER_SIZE;
+    int length;
+    while ((length = kv_commit_at(sector, offset)) >= 0) {
+        kv_apply(kv, sector + offset + KV_COMMIT_HEADER_SIZE, length);
+        offset = page_round_up(offset + KV_COMMIT_HEADER_SIZE + length);
+    }
+    kv->write_offset = offset;
+
+    // Anything but erased flash in the page the next commit would use means
+    // a torn write; it cannot be programmed again until the sector is erased
+    for (uint32_t i = offset; i < FLASH_SECTOR_SIZE && i < offset + FLASH_PAGE_SIZE; i++) {
+        if (sector[i] != 0xFF) kv->needs_compaction = true;
+    }
+}
+
+bool kv_get(const KvStore* kv, KvKey key, void* value, uint8_t length) {
+    const KvEntry* entry = &kv->entries[key];
+    if (!entry->present || entry->length != length) return false;
+
+    memcpy(value, entry->value, length);
+    return true;
+}
+
+void kv_set(KvStore* kv, KvKey key, const void* value, uint8_t length) {
+    if (length > KV_MAX_VALUE) return;
+
+    KvEntry* entry = &kv->entries[key];
+    if (entry->present && entry->length == length && memcmp(entry->value, value, length) == 0) {
+        return;  // Unchanged: no flash write
+    }
+    entry->present = true;
+    entry->dirty = true;
+    entry->length = length;
+    memcpy(entry->value, value, length);
+}
+
+uint32_t kv_commit(KvStore* kv) {
+    bool dirty = false;
+    for (int key = 0; key < KV_KEY_COUNT; key++) {
+        dirty |= kv->entries[key].dirty;
+    }
+    if (!dirty) return 0;
+
+    uint32_t stall;
+    bool compacted = false;
+    if (kv->needs_compaction || kv->write_offset + FLASH_PAGE_SIZE > FLASH_SECTOR_SIZE) {
+        stall = kv_compact(kv);
+        compacted = true;
+    } else {
+        memset(kv_page, 0xFF, sizeof(kv_page));
+        uint32_t payload_size = kv_build_payload(kv, kv_page + KV_COMMIT_HEADER_SIZE, false);
+        kv_write_commit_header(kv_page, payload_size);
+
+        stall = flash_io_program(kv_sector_offset(kv->active) + kv->write_offset,
+                                 kv_page, FLASH_PAGE_SIZE);
+        kv->write_offset += FLASH_PAGE_SIZE;
+    }
+
+    for (int key = 0; key < KV_KEY_COUNT; key++) {
+        kv->entries[key].dirty = false;
+    }
+    kv->commits++;
+    if (stall > kv->worst_stall_us) kv->worst_stall_us = stall;
+
+    printf("Settings committed%s: flash stall %lu us (worst %lu us)\n",
+           compacted ? " with compaction" : "",
+           (unsigned long)stall, (unsigned long)kv->worst_stall_us);
+    return stall;
+}
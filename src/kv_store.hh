@@ -0,0 +1,68 @@
+// kv_store.hh - Persistent settings: a log-structured key-value store
+//
+// Two flash sectors (FLASH_KV_OFFSET) take turns holding the log. A sector
+// starts with {magic, sequence}; the sector with the higher sequence is the
+// live one. Commits are appended on page boundaries as
+//   tag u16, payload length u16, payload crc u32, then {key u8, length u8,
+//   value} for every key changed since the last commit
+// so a commit torn by power loss fails its crc and is ignored along with
+// everything after it. When the live sector fills, every key is rewritten
+// as the first commit of the other sector (compaction); the old sector
+// stays valid until the new one is complete, and the alternation spreads
+// erases over both sectors.
+//
+// kv_set() only updates the RAM copy. Flash is written by kv_commit(),
+// which stalls both cores (see flash_io.hh), so call it at safe points.
+#ifndef KV_STORE_HH
+#define KV_STORE_HH
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define KV_SECTOR_MAGIC     0x564B4454u  // "TDKV"
+#define KV_COMMIT_TAG       0x4B43       // "CK"
+#define KV_MAX_VALUE        24
+#define KV_HIGH_SCORE_COUNT 5
+
+typedef enum {
+    KV_KEY_HIGH_SCORES = 0,   // uint32_t[KV_HIGH_SCORE_COUNT], best first
+    KV_KEY_VOLUME,            // uint8_t buzzer duty, percent
+    KV_KEY_BRIGHTNESS,        // uint8_t matrix brightness, percent
+    KV_KEY_JOYSTICK_CENTER,   // uint16_t x, y: ADC readings at rest
+    KV_KEY_FRAME_STREAM_HZ,   // uint8_t frames per second streamed over USB, 0 = off
+    KV_KEY_COUNT
+} KvKey;
+
+typedef struct {
+    bool     present;
+    bool     dirty;              // Changed since the last commit
+    uint8_t  length;
+    uint8_t  value[KV_MAX_VALUE];
+} KvEntry;
+
+typedef struct {
+    KvEntry  entries[KV_KEY_COUNT];
+    uint8_t  active;             // Sector holding the live log (0 or 1)
+    uint32_t sequence;           // Of the active sector
+    uint32_t write_offset;       // Next free page in the active sector
+    bool     needs_compaction;   // A torn commit blocks further appends
+
+    uint32_t commits;
+    uint32_t compactions;
+    uint32_t worst_stall_us;     // Longest flash stall of any commit so far
+} KvStore;
+
+// Load the live log into RAM, formatting the store if neither sector holds one
+void kv_init(KvStore* kv);
+
+// Copy a value out. Returns false if the key is unset or has another size.
+bool kv_get(const KvStore* kv, KvKey key, void* value, uint8_t length);
+
+// Update the RAM copy; nothing is written until kv_commit()
+void kv_set(KvStore* kv, KvKey key, const void* value, uint8_t length);
+
+// Write every dirty key to flash as one commit (compacting first if the
+// sector is full). Returns the flash stall in microseconds, 0 if clean.
+uint32_t kv_commit(KvStore* kv);
+
+#endif // KV_STORE_HH
@@ -2,12 +2,15 @@
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "pico/multicore.h"
+#include "hardware/sync.h"
 
 #include "game_types.h"
 #include "map_render.hh"
+#include "render_snapshot.h"
 #include "joystick.hh"
 #include "oled_display.hh"
 #include "buzzer_pwm.hh"
@@ -15,11 +18,18 @@
 #include "rfid.hh"
 #include "pin-definitions.hh"
 #include "wave_system.h"
+#include "replay.h"
+#include "snapshot_flash.hh"
+#include "kv_store.hh"
+#include "flash_io.hh"
+#include "frame_stream.hh"
+#include "telemetry.hh"
 
 // Forward declarations for LED matrix driver functions
 void init_matrix();
 void swap_frames();
 void render_frame();
+void matrix_set_brightness(uint8_t percent);
 void set_pixel(int x, int y, Color color);
 
 // Global game data
@@ -40,31 +50,98 @@ bool rfid_scanning_mode = false;  // True when actively scanning for RFID
 extern TowerType scanned_tower;
 TowerType last_scanned_tower = TOWER_BLANK;
 
+// Input log of this game, dumped to the console for host replay
+#define REPLAY_BUFFER_SIZE 16384
+static uint8_t replay_buffer[REPLAY_BUFFER_SIZE];
+ReplayRecorder replay;
+
+// Autosave interval, on top of the save at the end of each wave
+#define SNAPSHOT_INTERVAL_TICKS (30 * SIM_TICK_HZ)
+uint32_t last_snapshot_tick = 0;
+
+// Volume, brightness, joystick calibration and high scores
+KvStore settings;
+
+// Frames travel to core 1 as render snapshots; core 1 composes each one in
+// the gaps of its refresh loop and swaps it onto the panel
+static RenderExchange render_exchange;
+static RenderComposer composer;             // Core 1 only, but for its stats
+static bool composing = false;              // Core 1 only
+static bool frame_composed = false;         // Core 1 only
+static uint32_t compose_work_us = 0;        // Core 1 only
+
+// Held by core 1 while it swaps frames, and by core 0 while it copies the
+// frame on the panel
+static spin_lock_t* shown_frame_lock;
+static Color stream_frame[MATRIX_ROWS][MATRIX_COLS];    // Core 0's copy of it
+
+// Written by core 1 for telemetry and the frame stream
+volatile uint32_t matrix_refreshes = 0;     // Panel refreshes
+volatile uint32_t shown_tick = 0;           // Tick of the frame on the panel
+
 // Initialize everything
 static void setup_hardware() {
     stdio_init_all();
+    kv_init(&settings);
 
     // Matrix, joystick, OLED, RFID, buzzer
     init_matrix();
+    flash_io_set_park_hook(matrix_blank);
+    render_exchange_init(&render_exchange);
+    render_composer_init(&composer);
+    shown_frame_lock = spin_lock_init(spin_lock_claim_unused(true));
     init_joystick();
     rfid_setup();
     init_oled();
 
     buzzer_pwm_init();
-    buzzer_set_volume(40);
+    uint8_t volume = 40;
+    kv_get(&settings, KV_KEY_VOLUME, &volume, sizeof(volume));
+    buzzer_set_volume(volume);
+
+    uint8_t brightness = 100;
+    kv_get(&settings, KV_KEY_BRIGHTNESS, &brightness, sizeof(brightness));
+    matrix_set_brightness(brightness);
+
+    uint8_t stream_hz = FRAME_STREAM_DEFAULT_HZ;
+    kv_get(&settings, KV_KEY_FRAME_STREAM_HZ, &stream_hz, sizeof(stream_hz));
+    frame_stream_init(stream_hz);
+
+    // Calibrate the stick on first boot (hands off) and keep the result
+    uint16_t center[2];
+    if (kv_get(&settings, KV_KEY_JOYSTICK_CENTER, center, sizeof(center))) {
+        joystick_set_center(center[0], center[1]);
+    } else {
+        joystick_calibrate(&center[0], &center[1]);
+        kv_set(&settings, KV_KEY_JOYSTICK_CENTER, center, sizeof(center));
+        printf("Joystick calibrated: center %d, %d\n", center[0], center[1]);
+    }
+
+    uint32_t high_scores[KV_HIGH_SCORE_COUNT];
+    if (kv_get(&settings, KV_KEY_HIGH_SCORES, high_scores, sizeof(high_scores))) {
+        printf("High score: %lu\n", (unsigned long)high_scores[0]);
+    }
 
-    // Initialize game
-    game_init(&game);
-    game.selected_tower = TOWER_MACHINE_GUN;
+    // Resume the game saved before the last power cycle, if it was alive
+    bool resumed = snapshot_flash_load(&game, &wave_manager) && game.lives > 0;
+    if (!resumed) {
+        game_init(&game);
+        wave_manager_init(&wave_manager);
+    }
+    last_snapshot_tick = game.tick;
     
     map_render_init(&game);
 
-    // Initialize wave manager
-    wave_manager_init(&wave_manager);
+    // Replays start from game_init(), so a resumed game is not recorded
+    replay_recorder_start(&replay, replay_buffer, resumed ? 0 : sizeof(replay_buffer), &game);
     
     // Start wave 1 automatically
-    wave_manager_start_wave(&wave_manager, 0, &game);
+    if (!resumed) {
+        wave_manager_start_wave(&wave_manager, 0, &game);
+        replay_record_wave_start(&replay, game.tick, 0);
+    }
     start_sound();
+    telemetry_init(&game, &wave_manager, &replay, &settings);
 
     last_time_ms = to_ms_since_boot(get_absolute_time());
     
@@ -74,6 +151,25 @@ static void setup_hardware() {
     printf("===========================\n\n");
 }
 
+// Insert a finished run's score into the saved table (committed at the
+// next frame boundary)
+static void record_high_score(uint32_t score) {
+    uint32_t scores[KV_HIGH_SCORE_COUNT];
+    if (!kv_get(&settings, KV_KEY_HIGH_SCORES, scores, sizeof(scores))) {
+        memset(scores, 0, sizeof(scores));
+    }
+
+    int rank = 0;
+    while (rank < KV_HIGH_SCORE_COUNT && scores[rank] >= score) rank++;
+    if (rank == KV_HIGH_SCORE_COUNT) return;
+
+    memmove(&scores[rank + 1], &scores[rank],
+            (KV_HIGH_SCORE_COUNT - 1 - rank) * sizeof(scores[0]));
+    scores[rank] = score;
+    kv_set(&settings, KV_KEY_HIGH_SCORES, scores, sizeof(scores));
+    printf("*** HIGH SCORE #%d: %lu ***\n", rank + 1, (unsigned long)score);
+}
+
 // Convert hardware tower type to game tower type
 static TowerType convert_hw_to_game_tower(HardwareTowerType hw) {
     switch (hw) {
@@ -114,9 +210,9 @@ static void handle_joystick() {
             TowerSlot* slot = &game.tower_slots[current_slot_index];
             
             if (!slot->occupied) {
+                replay_record_place(&replay, game.tick);
                 bool ok = game_place_tower(&game, game.selected_tower, slot->x, slot->y);
                 if (ok) {
-                    slot->occupied = true;
                     beep_ok();
                     show_placement_mode = false;
                     rfid_scanning_mode = false;  // Stop scanning after placement
@@ -142,6 +238,7 @@ static void handle_joystick() {
             
             game.selected_tower = game_tower;
             scanned_tower = game_tower;
+            replay_record_tag_scan(&replay, game.tick, game_tower);
             
             show_placement_mode = true;
             current_slot_index = 0;
@@ -154,6 +251,7 @@ static void handle_joystick() {
                     current_slot_index = 0;
                 attempts++;
             }
+            replay_record_slot(&replay, game.tick, (uint8_t)current_slot_index);
             
             const TowerStats* stats = &TOWER_STATS_TABLE[game_tower];
             printf("Selected tower - Cost: %d, Range: %.1f, Damage: %d\n",
@@ -191,6 +289,7 @@ static void handle_joystick() {
                     current_slot_index = 0;
                 attempts++;
             }
+            replay_record_slot(&replay, game.tick, (uint8_t)current_slot_index);
             printf("→ Slot %d\n", current_slot_index);
         } 
         else if (jx == left) {
@@ -205,6 +304,7 @@ static void handle_joystick() {
                     current_slot_index = game.tower_slot_count - 1;
                 attempts++;
             }
+            replay_record_slot(&replay, game.tick, (uint8_t)current_slot_index);
             printf("← Slot %d\n", current_slot_index);
         }
     }
@@ -221,10 +321,29 @@ static void update_game() {
     last_time_ms = now;
     if (dt > 0.1f) dt = 0.1f;
 
-    game.game_time += dt;
+    // Spawns are checked every tick (not every frame) so that a replay,
+    // which has no frames, spawns on exactly the same ticks
+    game.tick_accumulator += dt;
+    while (game.tick_accumulator >= SIM_DT) {
+        game.tick_accumulator -= SIM_DT;
+        wave_manager_update(&wave_manager, &game);
+        game_step(&game);
+        replay_record_tick(&replay, &game, &wave_manager);
+    }
+
+    static bool score_recorded = false;
+    if (game.lives == 0 && !score_recorded) {
+        printf("\n*** GAME OVER ***\n");
+        record_high_score(game.score);
+        score_recorded = true;
+    }
 
-    // Update wave manager
-    wave_manager_update(&wave_manager, dt, &game);
+    static bool replay_dumped = false;
+    if (replay.full && replay.size > 0 && !replay_dumped) {
+        printf("Replay buffer full, dumping what was recorded\n");
+        replay_dump(&replay, game.tick);
+        replay_dumped = true;
+    }
     
     // Check if wave is complete
     static bool wave_just_completed = false;
@@ -234,23 +353,34 @@ static void update_game() {
             
             printf("\n*** WAVE %d COMPLETE! ***\n", wave_manager.current_wave + 1);
             victory_sound();
+            snapshot_flash_save(&game, &wave_manager);
+            last_snapshot_tick = game.tick;
             
-            if (wave_manager.current_wave + 1 < wave_manager_get_total_waves()) {
+            if (wave_manager.endless ||
+                wave_manager.current_wave + 1 < wave_manager_get_total_waves()) {
                 printf("Next wave starting in 3 seconds...\n\n");
                 sleep_ms(3000);
                 
                 wave_manager_start_wave(&wave_manager, wave_manager.current_wave + 1, &game);
+                replay_record_wave_start(&replay, game.tick, wave_manager.current_wave);
                 start_sound();
                 wave_just_completed = false;
             } else {
                 printf("\n*** ALL WAVES COMPLETE! VICTORY! ***\n");
-                printf("Final Score: %d\n", game.score);
-                printf("Money Remaining: %d\n", game.money);
+                printf("Final Score: %lu\n", (unsigned long)game.score);
+                printf("Money Remaining: %lu\n", (unsigned long)game.money);
                 printf("Lives Remaining: %d\n", game.lives);
+                printf("Entering ENDLESS MODE...\n");
                 printf("================================\n\n");
+                replay_dump(&replay, game.tick);
                 
+                // Keep the towers and carry on with generated waves; the boot
+                // time seeds a different run every game
                 sleep_ms(5000);
-                wave_manager_start_wave(&wave_manager, 0, &game);
+                wave_manager_set_endless(&wave_manager, time_us_32());
+                replay_record_endless(&replay, game.tick, wave_manager.seed);
+                wave_manager_start_wave(&wave_manager, wave_manager.current_wave + 1, &game);
+                replay_record_wave_start(&replay, game.tick, wave_manager.current_wave);
                 start_sound();
                 wave_just_completed = false;
             }
@@ -258,46 +388,36 @@ static void update_game() {
     } else {
         wave_just_completed = false;
     }
+}
+
+// Hand this frame to core 1 as a snapshot to compose
+static void publish_render_snapshot() {
+    // Placement UI: the selected tower's range around the cursor slot
+    RenderPlacement placement;
+    bool placing = show_placement_mode && game.tower_slot_count > 0;
+    if (placing) {
+        TowerSlot* slot = &game.tower_slots[current_slot_index];
+        placement.x = slot->x;
+        placement.y = slot->y;
+        placement.range = TOWER_STATS_TABLE[game.selected_tower].range;
+    }
 
-    // Update game logic
-    game_update(&game, dt);
+    RenderSnapshot* snapshot = render_exchange_back(&render_exchange);
+    render_snapshot_capture(snapshot, &game, placing ? &placement : NULL);
+    render_exchange_publish(&render_exchange);
 }
 
-// Render game to framebuffer
-static void render_game_to_framebuffer() {
-    // Copy pre-rendered static background
-    map_render_draw_static();
+// Offer the frame on the panel to the USB stream. Core 1 waits to swap
+// only while it is copied; encoding runs after the lock is released.
+static void stream_shown_frame() {
+    if (!frame_stream_due()) return;
 
-    // Draw dynamic game objects
-    game_draw(&game);
+    uint32_t save = spin_lock_blocking(shown_frame_lock);
+    memcpy(stream_frame, frames[!frame_index], sizeof(stream_frame));
+    uint32_t tick = shown_tick;
+    spin_unlock(shown_frame_lock, save);
 
-    // Draw UI elements (placement mode, range indicators)
-    if (show_placement_mode && game.tower_slot_count > 0) {
-        TowerSlot* slot = &game.tower_slots[current_slot_index];
-        
-        const TowerStats* stats = &TOWER_STATS_TABLE[game.selected_tower];
-        draw_tower_range(slot->x, slot->y, stats->range);
-        
-        bool blink_on = ((int)(game.game_time * 2.0f) % 2) == 0;
-        
-        if (blink_on) {
-            int cx = slot->x;
-            int cy = slot->y;
-            
-            for (int dy = -2; dy <= 2; ++dy) {
-                for (int dx = -2; dx <= 2; ++dx) {
-                    if (abs(dx) == 2 || abs(dy) == 2) {
-                        int px = cx + dx;
-                        int py = cy + dy;
-                        if (px >= 0 && px < MATRIX_WIDTH &&
-                            py >= 0 && py < MATRIX_HEIGHT) {
-                            set_pixel(px, py, Color(100, 100, 255));
-                        }
-                    }
-                }
-            }
-        }
-    }
+    frame_stream_capture(&stream_frame[0][0], tick);
 }
 
 // OLED UI
@@ -316,25 +436,66 @@ static void render_oled_ui() {
                 TOWER_STATS_TABLE[game.selected_tower].cost);
         snprintf(line2, sizeof(line2), "L/R=Slot SEL=OK");
     } else {
-        snprintf(line1, sizeof(line1), "HP:%d Score:%d", 
+        snprintf(line1, sizeof(line1), "HP:%d Score:%lu", 
                 game.lives,
-                game.score);
-        snprintf(line2, sizeof(line2), "$%d Wave:%d/%d", 
-                 game.money, 
-                 wave_manager.current_wave + 1,
-                 wave_manager_get_total_waves());
+                (unsigned long)game.score);
+        if (wave_manager.endless) {
+            snprintf(line2, sizeof(line2), "$%lu Wave:%d", 
+                     (unsigned long)game.money, 
+                     wave_manager.current_wave + 1);
+        } else {
+            snprintf(line2, sizeof(line2), "$%lu Wave:%d/%d", 
+                     (unsigned long)game.money, 
+                     wave_manager.current_wave + 1,
+                     wave_manager_get_total_waves());
+        }
     }
 
     oled_print(line1, line2);
 }
 
+// Core 1: one composition step, run by render_frame() while a row is lit
+static bool compose_in_row_gap() {
+    if (!composing) return false;
+
+    uint32_t start = time_us_32();
+    composing = render_compose_step(&composer);
+    compose_work_us += time_us_32() - start;
+
+    if (!composing) frame_composed = true;
+    return composing;
+}
+
 // Core 1 rendering
 void render_matrix() {
+    // Lets core 0 park this core while it writes snapshots to flash. The
+    // lockout handler drains the inter-core FIFO, so frames are handed over
+    // in shared memory instead.
+    multicore_lockout_victim_init();
+    matrix_set_idle_task(compose_in_row_gap);
+
     for (;;) {
         render_frame();
-        if (multicore_fifo_rvalid()) {
-            multicore_fifo_pop_blocking();
+        matrix_refreshes = matrix_refreshes + 1;
+
+        if (frame_composed) {
+            uint32_t save = spin_lock_blocking(shown_frame_lock);
             swap_frames();
+            shown_tick = composer.snapshot->tick;
+            spin_unlock(shown_frame_lock, save);
+
+            composer.stats.us = compose_work_us;
+            frame_composed = false;
+        }
+
+        // Start on the newest snapshot; older ones were never composed
+        if (!composing) {
+            const RenderSnapshot* snapshot = render_exchange_take(&render_exchange);
+            if (snapshot != NULL) {
+                render_compose_begin(&composer, snapshot);
+                compose_work_us = 0;
+                composing = true;
+            }
         }
     }
 }
@@ -355,17 +516,38 @@ int main() {
     printf("================================\n\n");
 
     while (true) {
+        uint32_t frame_start = time_us_32();
         handle_joystick();
+        uint32_t input_done = time_us_32();
         
         update_game();
-        render_game_to_framebuffer();
+        uint32_t sim_done = time_us_32();
+        publish_render_snapshot();
+        stream_shown_frame();
+        uint32_t draw_done = time_us_32();
         if (oled_counter % 3 == 0){
             render_oled_ui();
         }
-        multicore_fifo_push_blocking(1);
+        uint32_t oled_done = time_us_32();
+        telemetry_frame(input_done - frame_start, sim_done - input_done,
+                        draw_done - sim_done, oled_done - draw_done,
+                        matrix_refreshes, &composer.stats);
+
+        // Between frames: this frame's snapshot is already with core 1.
+        // Flash writes stall both cores, so they happen here or at a wave
+        // end, where the game pauses anyway. The idle time that follows
+        // sends the streamed frame, if any.
+        if (game.tick - last_snapshot_tick >= SNAPSHOT_INTERVAL_TICKS) {
+            snapshot_flash_save(&game, &wave_manager);
+            last_snapshot_tick = game.tick;
+        }
+        kv_commit(&settings);
+
+        // Tuning requests, answered while no streamed frame is half sent
+        if (!frame_stream_sending()) telemetry_poll();
 
         oled_counter++;
-        sleep_ms(60);
+        frame_stream_pump_until(make_timeout_time_ms(60));
     }
 
     return 0;
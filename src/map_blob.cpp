@@ -0,0 +1,143 @@
+// map_blob.cpp - Loading maps from the compiled flash blobs
+#include "map_blob.h"
+
+#include <string.h>
+#include <stdio.h>
+
+static_assert(sizeof(MapBlobHeader) == 52, "MapBlobHeader must match tools/map_compiler.py");
+static_assert(sizeof(PathPoint) == 4, "PathPoint must match tools/map_compiler.py");
+static_assert(sizeof(MapDecoration) == 6, "MapDecoration must match tools/map_compiler.py");
+static_assert(sizeof(Color) == 3, "Background pixels are packed RGB");
+
+const MapBlobHeader* map_blob_header(uint8_t map_index) {
+    if (map_index >= MAP_COUNT) return NULL;
+
+    const MapBlobHeader* header = (const MapBlobHeader*)MAP_BLOBS[map_index];
+    if (header->magic != MAP_BLOB_MAGIC || header->version != MAP_BLOB_VERSION) {
+        printf("ERROR: Map %d has a bad header\n", map_index);
+        return NULL;
+    }
+    return header;
+}
+
+bool map_blob_load(GameState* game, uint8_t map_index) {
+    const MapBlobHeader* header = map_blob_header(map_index);
+    if (header == NULL) return false;
+
+    if (header->width > MATRIX_WIDTH || header->height > MATRIX_HEIGHT ||
+        header->path_length < 2 || header->path_length > MAX_PATH_WAYPOINTS ||
+        header->slot_count > MAX_TOWERS) {
+        printf("ERROR: Map %d does not fit this build\n", map_index);
+        return false;
+    }
+
+    const uint8_t* blob = MAP_BLOBS[map_index];
+    uint8_t path_length = header->path_length;
+    uint8_t segment_count = (uint8_t)(path_length - 1);
+
+    memcpy(game->path, blob + header->path_offset, path_length * sizeof(PathPoint));
+    game->path_length = path_length;
+
+    // Arc lengths were computed by the compiler exactly as path_geometry_build()
+    // would, so this is a straight copy
+    const float* geometry = (const float*)(blob + header->geometry_offset);
+    PathGeometry* geom = &game->path_geometry;
+    memcpy(geom->cumulative, geometry, path_length * sizeof(float));
+    memcpy(geom->dir_x, geometry + path_length, segment_count * sizeof(float));
+    memcpy(geom->dir_y, geometry + path_length + segment_count, segment_count * sizeof(float));
+    geom->segment_count = segment_count;
+    geom->total_length = geom->cumulative[segment_count];
+
+    const PathPoint* slots = (const PathPoint*)(blob + header->slot_offset);
+    for (int i = 0; i < header->slot_count; i++) {
+        game->tower_slots[i] = {slots[i].x, slots[i].y, false};
+    }
+    game->tower_slot_count = header->slot_count;
+
+    game->map_index = map_index;
+    game_scenery_changed(game);
+    return true;
+}
+
+bool map_blob_background(uint8_t map_index, MapBackground* background) {
+    const MapBlobHeader* header = map_blob_header(map_index);
+    if (header == NULL || header->width > MATRIX_WIDTH || header->height > MATRIX_HEIGHT) {
+        return false;
+    }
+
+    background->data = MAP_BLOBS[map_index] + header->background_offset;
+    background->width = header->width;
+    background->height = header->height;
+    return true;
+}
+
+// Per-pixel texture noise: a fixed hash of the position, so any row (or
+// pixel) decodes independently and the same map always looks the same
+static inline uint32_t map_noise_hash(int x, int y) {
+    uint32_t h = (uint32_t)((y << 8) | x) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA77u;
+    h ^= h >> 13;
+    return h;
+}
+
+// base + a hash byte scaled onto [-variation, variation], clamped to 0..255
+static inline uint8_t map_noise_channel(uint8_t base, uint32_t byte, uint8_t variation) {
+    int value = base + (int)((byte * (2u * variation + 1u)) >> 8) - variation;
+    if (value < 0) return 0;
+    if (value > 255) return 255;
+    return (uint8_t)value;
+}
+
+void map_background_decode_row(const MapBackground* background, int row, Color* out) {
+    const uint16_t* row_offsets = (const uint16_t*)background->data;
+    const uint8_t* run = background->data + row_offsets[row];
+    int x = 0;
+
+    while (x < background->width) {
+        uint8_t code = *run++;
+        int end = x + (code & MAP_RUN_LENGTH_MASK) + 1;
+
+        switch (code >> MAP_RUN_KIND_SHIFT) {
+            case MAP_RUN_SOLID: {
+                Color color(run[0], run[1], run[2]);
+                run += 3;
+                for (; x < end; x++) {
+                    out[x] = color;
+                }
+                break;
+            }
+            case MAP_RUN_NOISE_RGB: {
+                uint8_t r = run[0], g = run[1], b = run[2], variation = run[3];
+                run += 4;
+                for (; x < end; x++) {
+                    uint32_t h = map_noise_hash(x, row);
+                    out[x].r = map_noise_channel(r, h & 0xFF, variation);
+                    out[x].g = map_noise_channel(g, (h >> 8) & 0xFF, variation);
+                    out[x].b = map_noise_channel(b, (h >> 16) & 0xFF, variation);
+                }
+                break;
+            }
+            default: {  // MAP_RUN_NOISE_GRAY
+                uint8_t gray = run[0], variation = run[1];
+                run += 2;
+                for (; x < end; x++) {
+                    uint8_t value = map_noise_channel(gray, map_noise_hash(x, row) & 0xFF, variation);
+                    out[x] = Color(value, value, value);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void map_background_panel_row(const MapBackground* background, int row, Color* out) {
+    int x = 0;
+    if (row < background->height) {
+        map_background_decode_row(background, row, out);
+        x = background->width;
+    }
+    for (; x < MATRIX_WIDTH; x++) {
+        out[x] = BLACK;
+    }
+}
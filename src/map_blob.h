@@ -0,0 +1,81 @@
+// map_blob.h - Flash-resident maps produced by tools/map_compiler.py
+#ifndef MAP_BLOB_H
+#define MAP_BLOB_H
+
+#include "game_types.h"
+
+#define MAP_BLOB_MAGIC      0x504D4454u  // "TDMP"
+#define MAP_BLOB_VERSION    2
+#define MAP_NAME_LENGTH     16
+
+typedef enum {
+    MAP_DECORATION_TREE = 0,
+    MAP_DECORATION_ROCK,
+    MAP_DECORATION_LAKE
+} MapDecorationType;
+
+// Background runs: one byte of kind << MAP_RUN_KIND_SHIFT | (length - 1),
+// followed by the kind's operands. Runs never cross rows.
+#define MAP_RUN_SOLID       0   // r, g, b
+#define MAP_RUN_NOISE_RGB   1   // r, g, b, variation (per channel)
+#define MAP_RUN_NOISE_GRAY  2   // gray, variation
+#define MAP_RUN_KIND_SHIFT  6
+#define MAP_RUN_LENGTH_MASK 0x3F
+
+typedef struct {
+    uint8_t  type;       // MapDecorationType
+    uint8_t  reserved;
+    int16_t  x;
+    int16_t  y;
+} MapDecoration;
+
+// A blob starts with this header; every section offset is from the start of
+// the blob and 4-byte aligned. All fields are little-endian.
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t  width;
+    uint8_t  height;
+    char     name[MAP_NAME_LENGTH];
+    uint8_t  path_length;
+    uint8_t  slot_count;
+    uint8_t  decoration_count;
+    uint8_t  reserved;
+    uint32_t path_offset;        // PathPoint[path_length]
+    uint32_t geometry_offset;    // float cumulative[path_length], then dir_x and
+                                 // dir_y, each float[path_length - 1]
+    uint32_t slot_offset;        // PathPoint[slot_count]
+    uint32_t decoration_offset;  // MapDecoration[decoration_count]
+    uint32_t background_offset;  // uint16 row_offsets[height] (from this offset),
+                                 // then the runs of every row
+    uint32_t size;
+} MapBlobHeader;
+
+// Generated blob table (src/map_blobs.cpp); index 0 is the default map
+extern const uint8_t* const MAP_BLOBS[];
+extern const uint8_t MAP_COUNT;
+
+// Header of a map, or NULL if the index or blob is invalid
+const MapBlobHeader* map_blob_header(uint8_t map_index);
+
+// Copy the path, arc-length table and tower slots into the game state.
+// Returns false (and leaves the game untouched) if the map is unusable.
+bool map_blob_load(GameState* game, uint8_t map_index);
+
+// Compressed background, decoded in place from flash a row at a time
+typedef struct {
+    const uint8_t* data;         // Section start; begins with the row table
+    uint8_t        width;
+    uint8_t        height;
+} MapBackground;
+
+// false if the map is missing or larger than the panel
+bool map_blob_background(uint8_t map_index, MapBackground* background);
+
+// Expand one row (width pixels) straight into `out`
+void map_background_decode_row(const MapBackground* background, int row, Color* out);
+
+// One panel row (MATRIX_WIDTH pixels): the map's row, black beyond the map
+void map_background_panel_row(const MapBackground* background, int row, Color* out);
+
+#endif // MAP_BLOB_H
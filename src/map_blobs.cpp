@@ -0,0 +1,180 @@
+// map_blobs.cpp - GENERATED by tools/map_compiler.py from gam4/maps/*.json
+// Do not edit; change the JSON and rebuild.
+#include "map_blob.h"
+
+// Classic (classic.json), 1344 bytes; background 6144 -> 1056 bytes (5.8:1)
+alignas(4) static const uint8_t MAP_BLOB_CLASSIC[1344] = {
+    0x54, 0x44, 0x4d, 0x50, 0x02, 0x00, 0x40, 0x20, 0x43, 0x6c, 0x61, 0x73, 0x73, 0x69, 0x63, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x05, 0x10, 0x00, 0x34, 0x00, 0x00, 0x00,
+    0x54, 0x00, 0x00, 0x00, 0xac, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0x20, 0x01, 0x00, 0x00,
+    0x40, 0x05, 0x00, 0x00, 0x3f, 0x00, 0x0f, 0x00, 0x32, 0x00, 0x0f, 0x00, 0x32, 0x00, 0x19, 0x00,
+    0x1e, 0x00, 0x19, 0x00, 0x1e, 0x00, 0x0a, 0x00, 0x0f, 0x00, 0x0a, 0x00, 0x0f, 0x00, 0x14, 0x00,
+    0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x41, 0x00, 0x00, 0xb8, 0x41,
+    0x00, 0x00, 0x2c, 0x42, 0x00, 0x00, 0x68, 0x42, 0x00, 0x00, 0x92, 0x42, 0x00, 0x00, 0xa6, 0x42,
+    0x00, 0x00, 0xc4, 0x42, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x37, 0x00, 0x08, 0x00,
+    0x37, 0x00, 0x16, 0x00, 0x26, 0x00, 0x12, 0x00, 0x14, 0x00, 0x06, 0x00, 0x14, 0x00, 0x1c, 0x00,
+    0x00, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x02, 0x00, 0x00, 0x00, 0x19, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x2a, 0x00, 0x03, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x03, 0x00, 0x00, 0x00,
+    0x05, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x2a, 0x00, 0x1d, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x1c, 0x00,
+    0x00, 0x00, 0x18, 0x00, 0x10, 0x00, 0x01, 0x00, 0x12, 0x00, 0x14, 0x00, 0x01, 0x00, 0x23, 0x00,
+    0x08, 0x00, 0x01, 0x00, 0x34, 0x00, 0x01, 0x00, 0x01, 0x00, 0x12, 0x00, 0x1d, 0x00, 0x01, 0x00,
+    0x34, 0x00, 0x1d, 0x00, 0x02, 0x00, 0x08, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x2a, 0x00, 0x0c, 0x00,
+    0x40, 0x00, 0x45, 0x00, 0x65, 0x00, 0xa0, 0x00, 0xd2, 0x00, 0x04, 0x01, 0x36, 0x01, 0x56, 0x01,
+    0x5b, 0x01, 0x69, 0x01, 0x7f, 0x01, 0x95, 0x01, 0xab, 0x01, 0xc9, 0x01, 0xf0, 0x01, 0x11, 0x02,
+    0x3b, 0x02, 0x65, 0x02, 0x8b, 0x02, 0xb1, 0x02, 0xd2, 0x02, 0xf3, 0x02, 0x14, 0x03, 0x29, 0x03,
+    0x3e, 0x03, 0x4b, 0x03, 0x58, 0x03, 0x65, 0x03, 0x7c, 0x03, 0x9c, 0x03, 0xce, 0x03, 0x00, 0x04,
+    0x7f, 0x00, 0x3c, 0x00, 0x08, 0x4a, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x49, 0x00,
+    0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x58, 0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e,
+    0x49, 0x00, 0x3c, 0x00, 0x08, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x43, 0x00,
+    0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x49, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00,
+    0x4d, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x1e,
+    0x1e, 0x1e, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x41, 0x00, 0x3c, 0x00, 0x08,
+    0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00,
+    0x50, 0x00, 0x49, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x4d, 0x00, 0x3c, 0x00, 0x08,
+    0x02, 0x00, 0x50, 0x00, 0x4e, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x41, 0x00, 0x3c,
+    0x00, 0x08, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x44, 0x00, 0x3c, 0x00, 0x08,
+    0x00, 0x64, 0x32, 0x00, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x4e, 0x00, 0x3c,
+    0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x4e, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x41,
+    0x00, 0x3c, 0x00, 0x08, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x44, 0x00, 0x3c,
+    0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x49, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x4e,
+    0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32,
+    0x00, 0x42, 0x00, 0x3c, 0x00, 0x08, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x61,
+    0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x4e, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32,
+    0x00, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x62, 0x00, 0x3c, 0x00, 0x08,
+    0x01, 0x1e, 0x1e, 0x1e, 0x5a, 0x00, 0x3c, 0x00, 0x08, 0x4e, 0x00, 0x3c, 0x00, 0x08, 0x8f, 0x2d,
+    0x03, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x1e, 0x1e, 0x1e, 0x59, 0x00, 0x3c, 0x00, 0x08, 0x4d,
+    0x00, 0x3c, 0x00, 0x08, 0x91, 0x2d, 0x03, 0x49, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x00, 0x50,
+    0x52, 0x00, 0x3c, 0x00, 0x08, 0x4d, 0x00, 0x3c, 0x00, 0x08, 0x91, 0x2d, 0x03, 0x48, 0x00, 0x3c,
+    0x00, 0x08, 0x05, 0x00, 0x00, 0x50, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x4d, 0x00, 0x3c, 0x00, 0x08,
+    0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x48, 0x00, 0x3c, 0x00, 0x08,
+    0x05, 0x00, 0x00, 0x50, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00,
+    0x00, 0x50, 0x42, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x82,
+    0x2d, 0x03, 0x4a, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x00, 0x50, 0x51, 0x00, 0x3c, 0x00, 0x08,
+    0x46, 0x00, 0x3c, 0x00, 0x08, 0x05, 0x00, 0x00, 0x50, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d,
+    0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x51, 0x00, 0x3c, 0x00, 0x08, 0x8d, 0x2d,
+    0x03, 0x46, 0x00, 0x3c, 0x00, 0x08, 0x05, 0x00, 0x00, 0x50, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x82,
+    0x2d, 0x03, 0x45, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x42, 0x00, 0x3c, 0x00, 0x08,
+    0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x8e, 0x2d, 0x03, 0x48, 0x00, 0x3c, 0x00, 0x08,
+    0x02, 0x00, 0x00, 0x50, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x45, 0x00, 0x3c, 0x00,
+    0x08, 0x02, 0x00, 0x50, 0x00, 0x42, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c,
+    0x00, 0x08, 0x8e, 0x2d, 0x03, 0x4d, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x45, 0x00, 0x3c,
+    0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x42, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x50, 0x00,
+    0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x4d, 0x00, 0x3c, 0x00, 0x08,
+    0x82, 0x2d, 0x03, 0x46, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x43, 0x00, 0x3c, 0x00,
+    0x08, 0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00,
+    0x08, 0x90, 0x2d, 0x03, 0x45, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x42, 0x00, 0x3c,
+    0x00, 0x08, 0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c,
+    0x00, 0x08, 0x90, 0x2d, 0x03, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e, 0x48, 0x00,
+    0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00,
+    0x3c, 0x00, 0x08, 0x8f, 0x2d, 0x03, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x1e, 0x1e, 0x1e, 0x47,
+    0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b,
+    0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x50, 0x00, 0x3c, 0x00,
+    0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d,
+    0x03, 0x50, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00,
+    0x3c, 0x00, 0x08, 0x96, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00, 0x3c, 0x00, 0x08,
+    0x96, 0x2d, 0x03, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x5d, 0x00, 0x3c, 0x00, 0x08, 0x94, 0x2d, 0x03,
+    0x4c, 0x00, 0x3c, 0x00, 0x08, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x73, 0x00,
+    0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x43, 0x00, 0x3c, 0x00,
+    0x08, 0x02, 0x00, 0x50, 0x00, 0x61, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x4e, 0x00,
+    0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x43, 0x00, 0x3c, 0x00,
+    0x08, 0x02, 0x00, 0x50, 0x00, 0x4a, 0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e, 0x54, 0x00,
+    0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e,
+    0x44, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x44, 0x00,
+    0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x1e, 0x1e, 0x1e,
+    0x53, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x1e,
+    0x1e, 0x1e, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x42, 0x00, 0x3c, 0x00, 0x08,
+    0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x62, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64,
+    0x32, 0x00, 0x4f, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x41, 0x00, 0x3c, 0x00, 0x08,
+};
+
+// Forest (forest.json), 540 bytes; background 6144 -> 397 bytes (15.5:1)
+alignas(4) static const uint8_t MAP_BLOB_FOREST[540] = {
+    0x54, 0x44, 0x4d, 0x50, 0x02, 0x00, 0x40, 0x20, 0x46, 0x6f, 0x72, 0x65, 0x73, 0x74, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x03, 0x00, 0x34, 0x00, 0x00, 0x00,
+    0x44, 0x00, 0x00, 0x00, 0x6c, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x8c, 0x00, 0x00, 0x00,
+    0x1c, 0x02, 0x00, 0x00, 0x3f, 0x00, 0x14, 0x00, 0x14, 0x00, 0x14, 0x00, 0x14, 0x00, 0x0a, 0x00,
+    0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2c, 0x42, 0x00, 0x00, 0x54, 0x42,
+    0x00, 0x00, 0x92, 0x42, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x05, 0x00,
+    0x0a, 0x00, 0x19, 0x00, 0x28, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x05, 0x00, 0x01, 0x00,
+    0x14, 0x00, 0x1c, 0x00, 0x02, 0x00, 0x2d, 0x00, 0x08, 0x00, 0x00, 0x00, 0x40, 0x00, 0x45, 0x00,
+    0x4a, 0x00, 0x4f, 0x00, 0x54, 0x00, 0x62, 0x00, 0x70, 0x00, 0x87, 0x00, 0x9e, 0x00, 0xb5, 0x00,
+    0xc6, 0x00, 0xce, 0x00, 0xd6, 0x00, 0xe3, 0x00, 0xf0, 0x00, 0xfd, 0x00, 0x0a, 0x01, 0x17, 0x01,
+    0x24, 0x01, 0x31, 0x01, 0x39, 0x01, 0x41, 0x01, 0x49, 0x01, 0x4e, 0x01, 0x53, 0x01, 0x58, 0x01,
+    0x5d, 0x01, 0x62, 0x01, 0x67, 0x01, 0x75, 0x01, 0x83, 0x01, 0x88, 0x01, 0x7f, 0x00, 0x3c, 0x00,
+    0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08,
+    0x5c, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x5f, 0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00,
+    0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x5f, 0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00, 0x3c, 0x00,
+    0x08, 0x02, 0x00, 0x50, 0x00, 0x4c, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x00, 0x50, 0x4f, 0x00,
+    0x3c, 0x00, 0x08, 0x5d, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x4c, 0x00, 0x3c, 0x00,
+    0x08, 0x05, 0x00, 0x00, 0x50, 0x4d, 0x00, 0x3c, 0x00, 0x08, 0x5c, 0x00, 0x3c, 0x00, 0x08, 0x02,
+    0x64, 0x32, 0x00, 0x4b, 0x00, 0x3c, 0x00, 0x08, 0x05, 0x00, 0x00, 0x50, 0x4d, 0x00, 0x3c, 0x00,
+    0x08, 0x94, 0x2d, 0x03, 0x58, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x00, 0x50, 0x4e, 0x00, 0x3c,
+    0x00, 0x08, 0x95, 0x2d, 0x03, 0x69, 0x00, 0x3c, 0x00, 0x08, 0x95, 0x2d, 0x03, 0x69, 0x00, 0x3c,
+    0x00, 0x08, 0x52, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x69, 0x00, 0x3c, 0x00, 0x08, 0x52,
+    0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x69, 0x00, 0x3c, 0x00, 0x08, 0x52, 0x00, 0x3c, 0x00,
+    0x08, 0x82, 0x2d, 0x03, 0x69, 0x00, 0x3c, 0x00, 0x08, 0x52, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d,
+    0x03, 0x69, 0x00, 0x3c, 0x00, 0x08, 0x52, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x69, 0x00,
+    0x3c, 0x00, 0x08, 0x52, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x69, 0x00, 0x3c, 0x00, 0x08,
+    0x52, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x69, 0x00, 0x3c, 0x00, 0x08, 0x52, 0x00, 0x3c,
+    0x00, 0x08, 0xac, 0x2d, 0x03, 0x52, 0x00, 0x3c, 0x00, 0x08, 0xac, 0x2d, 0x03, 0x53, 0x00, 0x3c,
+    0x00, 0x08, 0xab, 0x2d, 0x03, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x7f,
+    0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00,
+    0x3c, 0x00, 0x08, 0x53, 0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e, 0x69, 0x00, 0x3c, 0x00,
+    0x08, 0x53, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x1e, 0x1e, 0x1e, 0x68, 0x00, 0x3c, 0x00, 0x08, 0x7f,
+    0x00, 0x3c, 0x00, 0x08, 0x7f, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x00, 0x00,
+};
+
+// Small (small.json), 616 bytes; background 1536 -> 388 bytes (4.0:1)
+alignas(4) static const uint8_t MAP_BLOB_SMALL[616] = {
+    0x54, 0x44, 0x4d, 0x50, 0x02, 0x00, 0x20, 0x10, 0x53, 0x6d, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x05, 0x06, 0x00, 0x34, 0x00, 0x00, 0x00,
+    0x54, 0x00, 0x00, 0x00, 0xac, 0x00, 0x00, 0x00, 0xc0, 0x00, 0x00, 0x00, 0xe4, 0x00, 0x00, 0x00,
+    0x68, 0x02, 0x00, 0x00, 0x1f, 0x00, 0x07, 0x00, 0x18, 0x00, 0x07, 0x00, 0x18, 0x00, 0x0c, 0x00,
+    0x0e, 0x00, 0x0c, 0x00, 0x0e, 0x00, 0x04, 0x00, 0x06, 0x00, 0x04, 0x00, 0x06, 0x00, 0x0a, 0x00,
+    0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x40, 0x00, 0x00, 0x40, 0x41,
+    0x00, 0x00, 0xb0, 0x41, 0x00, 0x00, 0xf0, 0x41, 0x00, 0x00, 0x18, 0x42, 0x00, 0x00, 0x30, 0x42,
+    0x00, 0x00, 0x48, 0x42, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xbf,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x02, 0x00,
+    0x1c, 0x00, 0x0c, 0x00, 0x13, 0x00, 0x08, 0x00, 0x0a, 0x00, 0x08, 0x00, 0x03, 0x00, 0x0e, 0x00,
+    0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x14, 0x00, 0x02, 0x00, 0x00, 0x00, 0x0b, 0x00,
+    0x0e, 0x00, 0x01, 0x00, 0x12, 0x00, 0x0f, 0x00, 0x01, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x02, 0x00,
+    0x13, 0x00, 0x03, 0x00, 0x20, 0x00, 0x25, 0x00, 0x3c, 0x00, 0x53, 0x00, 0x72, 0x00, 0x91, 0x00,
+    0xb0, 0x00, 0xc8, 0x00, 0xe0, 0x00, 0xf8, 0x00, 0x10, 0x01, 0x28, 0x01, 0x38, 0x01, 0x45, 0x01,
+    0x5b, 0x01, 0x69, 0x01, 0x5f, 0x00, 0x3c, 0x00, 0x08, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00,
+    0x50, 0x00, 0x4e, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x00, 0x50, 0x49, 0x00, 0x3c, 0x00, 0x08,
+    0x40, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x4d, 0x00, 0x3c, 0x00, 0x08, 0x05, 0x00,
+    0x00, 0x50, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00,
+    0x41, 0x00, 0x3c, 0x00, 0x08, 0x88, 0x2d, 0x03, 0x42, 0x00, 0x3c, 0x00, 0x08, 0x05, 0x00, 0x00,
+    0x50, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x41, 0x00, 0x3c, 0x00, 0x08, 0x00, 0x64, 0x32, 0x00, 0x41,
+    0x00, 0x3c, 0x00, 0x08, 0x8a, 0x2d, 0x03, 0x43, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x00, 0x50,
+    0x48, 0x00, 0x3c, 0x00, 0x08, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x40, 0x00,
+    0x3c, 0x00, 0x08, 0x8a, 0x2d, 0x03, 0x42, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x64, 0x32, 0x00, 0x49,
+    0x00, 0x3c, 0x00, 0x08, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x44, 0x00, 0x3c, 0x00,
+    0x08, 0x82, 0x2d, 0x03, 0x47, 0x00, 0x3c, 0x00, 0x08, 0x87, 0x2d, 0x03, 0x44, 0x00, 0x3c, 0x00,
+    0x08, 0x82, 0x2d, 0x03, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x46, 0x00, 0x3c, 0x00,
+    0x08, 0x88, 0x2d, 0x03, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x44, 0x00, 0x3c, 0x00,
+    0x08, 0x82, 0x2d, 0x03, 0x46, 0x00, 0x3c, 0x00, 0x08, 0x88, 0x2d, 0x03, 0x87, 0x2d, 0x03, 0x44,
+    0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x46, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x45,
+    0x00, 0x3c, 0x00, 0x08, 0x87, 0x2d, 0x03, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x46,
+    0x00, 0x3c, 0x00, 0x08, 0x82, 0x2d, 0x03, 0x45, 0x00, 0x3c, 0x00, 0x08, 0x86, 0x2d, 0x03, 0x45,
+    0x00, 0x3c, 0x00, 0x08, 0x8c, 0x2d, 0x03, 0x45, 0x00, 0x3c, 0x00, 0x08, 0x4c, 0x00, 0x3c, 0x00,
+    0x08, 0x8c, 0x2d, 0x03, 0x45, 0x00, 0x3c, 0x00, 0x08, 0x49, 0x00, 0x3c, 0x00, 0x08, 0x02, 0x00,
+    0x50, 0x00, 0x40, 0x00, 0x3c, 0x00, 0x08, 0x8a, 0x2d, 0x03, 0x46, 0x00, 0x3c, 0x00, 0x08, 0x49,
+    0x00, 0x3c, 0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x52, 0x00, 0x3c, 0x00, 0x08, 0x49, 0x00, 0x3c,
+    0x00, 0x08, 0x02, 0x00, 0x50, 0x00, 0x44, 0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e, 0x49,
+    0x00, 0x3c, 0x00, 0x08, 0x01, 0x1e, 0x1e, 0x1e,
+};
+
+const uint8_t* const MAP_BLOBS[] = {
+    MAP_BLOB_CLASSIC,
+    MAP_BLOB_FOREST,
+    MAP_BLOB_SMALL,
+};
+
+const uint8_t MAP_COUNT = 3;
@@ -6,14 +6,13 @@
 
 /**
  * Initialize the map rendering system.
- * Generates a SINGLE combined background buffer with:
- * - Textured grass background
- * - Textured path
- * - All decorations (trees, rocks, lakes)
+ * Points the renderer at the current map's pre-rendered background
+ * (grass, textured path and decorations), which tools/map_compiler.py
+ * bakes into the map blob at build time. Nothing is generated at boot.
  * 
- * This only needs to be called ONCE at game startup.
+ * Call again after loading a different map.
  * 
- * @param game Pointer to game state (for path data)
+ * @param game Pointer to game state (for the map index)
  */
 void map_render_init(const GameState* game);
 
@@ -24,9 +23,4 @@ void map_render_init(const GameState* game);
  */
 void map_render_draw_static();
 
-// Individual decoration functions (now only used during init)
-void draw_tree(int x, int y);
-void draw_rock(int x, int y);
-void draw_lake(int x, int y);
-
-#endif // MAP_RENDER_HH
\ No newline at end of file
+#endif // MAP_RENDER_HH
@@ -0,0 +1,133 @@
+// path_geometry.cpp - Precomputed arc-length table for the enemy path
+#include "game_types.h"
+
+#include <math.h>
+
+void path_geometry_build(PathGeometry* geom, const PathPoint* path, uint8_t path_length) {
+    geom->segment_count = (path_length > 1) ? (uint8_t)(path_length - 1) : 0;
+    geom->total_length = 0.0f;
+
+    for (int i = 0; i < geom->segment_count; i++) {
+        float dx = (float)(path[i + 1].x - path[i].x);
+        float dy = (float)(path[i + 1].y - path[i].y);
+        float length = sqrtf(dx * dx + dy * dy);
+
+        geom->cumulative[i] = geom->total_length;
+        if (length > 0.0f) {
+            geom->dir_x[i] = dx / length;
+            geom->dir_y[i] = dy / length;
+        } else {
+            geom->dir_x[i] = 0.0f;
+            geom->dir_y[i] = 0.0f;
+        }
+        geom->total_length += length;
+    }
+
+    geom->cumulative[geom->segment_count] = geom->total_length;
+}
+
+uint8_t path_segment_at(const PathGeometry* geom, float progress) {
+    if (geom->segment_count == 0) return 0;
+
+    // Last segment whose start is <= progress
+    int lo = 0;
+    int hi = geom->segment_count - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (geom->cumulative[mid] <= progress) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return (uint8_t)lo;
+}
+
+void path_point_at(const PathGeometry* geom, const PathPoint* path, float progress,
+                   uint8_t* segment, float* x, float* y) {
+    if (geom->segment_count == 0) {
+        *segment = 0;
+        *x = (float)path[0].x;
+        *y = (float)path[0].y;
+        return;
+    }
+
+    uint8_t seg = *segment;
+    while (seg + 1 < geom->segment_count && progress >= geom->cumulative[seg + 1]) {
+        seg++;
+    }
+    *segment = seg;
+
+    float along = progress - geom->cumulative[seg];
+    *x = (float)path[seg].x + geom->dir_x[seg] * along;
+    *y = (float)path[seg].y + geom->dir_y[seg] * along;
+}
+
+// Earliest time at which a shot fired from (sx, sy) at shot_speed meets an
+// enemy at `progress` moving along the path at enemy_speed. Solves
+// |E(t) - S| = shot_speed * t one segment at a time, where E(t) is linear
+// within a segment. Returns false if the enemy reaches the end of the path
+// first.
+bool path_intercept(const PathGeometry* geom, const PathPoint* path,
+                    float progress, float enemy_speed,
+                    float sx, float sy, float shot_speed,
+                    float* time, float* x, float* y) {
+    if (shot_speed <= 0.0f || progress >= geom->total_length) return false;
+
+    uint8_t seg = path_segment_at(geom, progress);
+
+    if (enemy_speed <= 0.0f) {
+        float ex, ey;
+        path_point_at(geom, path, progress, &seg, &ex, &ey);
+        float dx = ex - sx;
+        float dy = ey - sy;
+        *time = sqrtf(dx * dx + dy * dy) / shot_speed;
+        *x = ex;
+        *y = ey;
+        return true;
+    }
+
+    for (; seg < geom->segment_count; seg++) {
+        float t_lo = (geom->cumulative[seg] - progress) / enemy_speed;
+        float t_hi = (geom->cumulative[seg + 1] - progress) / enemy_speed;
+        if (t_lo < 0.0f) t_lo = 0.0f;
+
+        // Enemy on this segment: E(t) = F0 + G * t (relative to the shooter)
+        float along = progress - geom->cumulative[seg];
+        float fx = (float)path[seg].x + geom->dir_x[seg] * along - sx;
+        float fy = (float)path[seg].y + geom->dir_y[seg] * along - sy;
+        float gx = geom->dir_x[seg] * enemy_speed;
+        float gy = geom->dir_y[seg] * enemy_speed;
+
+        float a = enemy_speed * enemy_speed - shot_speed * shot_speed;
+        float b = 2.0f * (fx * gx + fy * gy);
+        float c = fx * fx + fy * fy;
+
+        float t = -1.0f;
+        if (fabsf(a) < 1e-6f) {
+            if (b < 0.0f) t = -c / b;
+        } else {
+            float disc = b * b - 4.0f * a * c;
+            if (disc >= 0.0f) {
+                float root = sqrtf(disc);
+                float t0 = (-b - root) / (2.0f * a);
+                float t1 = (-b + root) / (2.0f * a);
+                if (t0 > t1) {
+                    float tmp = t0;
+                    t0 = t1;
+                    t1 = tmp;
+                }
+                t = (t0 >= t_lo) ? t0 : t1;
+            }
+        }
+
+        if (t >= t_lo && t <= t_hi) {
+            *time = t;
+            *x = fx + gx * t + sx;
+            *y = fy + gy * t + sy;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,322 @@
+// render_snapshot.cpp - Frame capture, cross-core hand-off and composition
+#include "render_snapshot.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "matrix.hh"
+
+static const Color PROJECTILE_COLOR = {255, 255, 0};  // Yellow projectiles
+
+// ============================================================================
+// CAPTURE
+// ============================================================================
+
+static void capture_slots(DisplayList* list, const GameState* game) {
+    // Occupied slots are darkened; their tower normally covers them and
+    // display_list_finish() culls them
+    for (int i = 0; i < game->tower_slot_count; i++) {
+        const TowerSlot* slot = &game->tower_slots[i];
+        display_list_sprite(list, DRAW_LAYER_SLOTS, DRAW_SPRITE_SLOT,
+                            slot->x - 2, slot->y - 2, slot->occupied ? 3 : 1);
+    }
+}
+
+static void capture_towers(DisplayList* list, const GameState* game) {
+    const TowerStore* towers = &game->towers;
+
+    const uint32_t* tower_mask = towers->pool.alive;
+    for (int i = mask_next(tower_mask, MAX_TOWERS, 0); i >= 0;
+         i = mask_next(tower_mask, MAX_TOWERS, i + 1)) {
+        const TowerStats* stats = &TOWER_STATS_TABLE[towers->type[i]];
+        int cx = (int)towers->x[i];
+        int cy = (int)towers->y[i];
+
+        display_list_sprite(list, DRAW_LAYER_TOWERS, DRAW_SPRITE_TOWER(towers->type[i]),
+                            cx - 2, cy - 2, 1);
+
+        // Radars show their coverage under every tower
+        if (stats->is_radar) {
+            display_list_circle(list, DRAW_LAYER_RANGES, cx, cy, (int)stats->range,
+                                Color(0, 120, 0));
+        }
+    }
+}
+
+static void capture_sweeps(DisplayList* list, const GameState* game) {
+    const TowerStore* towers = &game->towers;
+    float angle = fmodf(2.0f * game->game_time, 2.0f * 3.14159f);  // 2 rad/s
+
+    const uint32_t* tower_mask = towers->pool.alive;
+    for (int i = mask_next(tower_mask, MAX_TOWERS, 0); i >= 0;
+         i = mask_next(tower_mask, MAX_TOWERS, i + 1)) {
+        const TowerStats* stats = &TOWER_STATS_TABLE[towers->type[i]];
+        if (!stats->is_radar) continue;
+
+        int cx = (int)towers->x[i];
+        int cy = (int)towers->y[i];
+        int sweep_length = (int)(stats->range) - 1;  // Stay inside circle
+        int end_x = cx + (int)(cosf(angle) * sweep_length);
+        int end_y = cy + (int)(sinf(angle) * sweep_length);
+        display_list_line(list, DRAW_LAYER_SWEEPS, cx, cy, end_x, end_y, Color(0, 200, 0));
+    }
+}
+
+static void capture_enemies(DisplayList* list, const GameState* game) {
+    const EnemyStore* enemies = &game->enemies;
+
+    const uint32_t* enemy_mask = enemies->pool.alive;
+    for (int i = mask_next(enemy_mask, MAX_ENEMIES, 0); i >= 0;
+         i = mask_next(enemy_mask, MAX_ENEMIES, i + 1)) {
+        Color color = ENEMY_STATS_TABLE[enemies->type[i]].color;
+
+        // Ghost enemies are barely visible until a radar reveals them
+        if (enemies->flags[i] == ENEMY_FLAG_INVISIBLE) {
+            color = Color(color.r / 8, color.g / 8, color.b / 4);
+        }
+        display_list_pixel(list, DRAW_LAYER_ENEMIES,
+                           (int)enemies->x[i], (int)enemies->y[i], color);
+    }
+}
+
+static void capture_projectiles(DisplayList* list, const GameState* game) {
+    const ProjectileStore* projs = &game->projectiles;
+
+    const uint32_t* proj_mask = projs->pool.alive;
+    for (int i = mask_next(proj_mask, MAX_PROJECTILES, 0); i >= 0;
+         i = mask_next(proj_mask, MAX_PROJECTILES, i + 1)) {
+        // Interpolate along the straight flight line for display only,
+        // including the part of a tick not yet simulated
+        float flight = (float)(projs->impact_tick[i] - projs->launch_tick[i]);
+        float elapsed = (float)(game->tick - projs->launch_tick[i]) +
+                        game->tick_accumulator * SIM_TICK_HZ;
+        float t = elapsed / flight;
+        if (t > 1.0f) t = 1.0f;
+
+        int x = (int)(projs->origin_x[i] + (projs->impact_x[i] - projs->origin_x[i]) * t);
+        int y = (int)(projs->origin_y[i] + (projs->impact_y[i] - projs->origin_y[i]) * t);
+        display_list_pixel(list, DRAW_LAYER_PROJECTILES, x, y, PROJECTILE_COLOR);
+    }
+}
+
+static void capture_placement(DisplayList* list, const RenderPlacement* placement,
+                              float game_time) {
+    display_list_circle(list, DRAW_LAYER_OVERLAY, placement->x, placement->y,
+                        (int)placement->range, Color(80, 80, 80));
+
+    bool blink_on = ((int)(game_time * 4.0f) % 2) == 0;
+    if (blink_on) {
+        display_list_rect(list, DRAW_LAYER_OVERLAY, placement->x - 2, placement->y - 2, 5, 5,
+                          Color(100, 100, 255));
+    }
+}
+
+void render_snapshot_capture(RenderSnapshot* snapshot, const GameState* game,
+                             const RenderPlacement* placement) {
+    DisplayList* list = &snapshot->list;
+    snapshot->tick = game->tick;
+    snapshot->map_index = game->map_index;
+
+    if (!snapshot->has_scenery || snapshot->scenery_revision != game->scenery_revision) {
+        display_list_clear(&snapshot->scenery);
+        capture_slots(&snapshot->scenery, game);
+        capture_towers(&snapshot->scenery, game);
+        display_list_finish(&snapshot->scenery);
+        snapshot->has_scenery = true;
+        snapshot->scenery_revision = game->scenery_revision;
+    }
+
+    display_list_clear(list);
+    capture_sweeps(list, game);
+    capture_enemies(list, game);
+    capture_projectiles(list, game);
+    if (placement != NULL) capture_placement(list, placement, game->game_time);
+    display_list_finish(list);
+}
+
+void render_snapshot_draw(const RenderSnapshot* snapshot) {
+    display_list_execute(&snapshot->scenery, 0, snapshot->scenery.count);
+    display_list_execute(&snapshot->list, 0, snapshot->list.count);
+}
+
+// ============================================================================
+// HAND-OFF
+// ============================================================================
+
+void render_exchange_init(RenderExchange* exchange) {
+    for (int i = 0; i < 3; i++) exchange->buffers[i].has_scenery = false;
+    exchange->back = 0;
+    exchange->middle = 1;
+    exchange->front = 2;
+}
+
+RenderSnapshot* render_exchange_back(RenderExchange* exchange) {
+    return &exchange->buffers[exchange->back];
+}
+
+void render_exchange_publish(RenderExchange* exchange) {
+    // Release: the snapshot's contents are visible before its index is
+    uint8_t previous = __atomic_exchange_n(&exchange->middle,
+                                           (uint8_t)(exchange->back | RENDER_EXCHANGE_FRESH),
+                                           __ATOMIC_ACQ_REL);
+    exchange->back = previous & ~RENDER_EXCHANGE_FRESH;
+}
+
+const RenderSnapshot* render_exchange_take(RenderExchange* exchange) {
+    if (!(__atomic_load_n(&exchange->middle, __ATOMIC_ACQUIRE) & RENDER_EXCHANGE_FRESH)) {
+        return NULL;
+    }
+    uint8_t latest = __atomic_exchange_n(&exchange->middle, exchange->front, __ATOMIC_ACQ_REL);
+    exchange->front = latest & ~RENDER_EXCHANGE_FRESH;
+    return &exchange->buffers[exchange->front];
+}
+
+// ============================================================================
+// COMPOSITION
+// ============================================================================
+
+void render_composer_init(RenderComposer* composer) {
+    composer->snapshot = NULL;
+    composer->phase = RENDER_PHASE_DONE;
+    composer->cursor = 0;
+    composer->full = true;
+    composer->has_backdrop = false;
+    composer->history = 0;
+    display_list_clear(&composer->previous);
+    display_damage_clear(&composer->changes);
+    display_damage_clear(&composer->previous_changes);
+    composer->stats = RenderComposeStats();
+}
+
+void render_compose_begin(RenderComposer* composer, const RenderSnapshot* snapshot) {
+    composer->snapshot = snapshot;
+    composer->cursor = 0;
+    composer->phase = RENDER_PHASE_DAMAGE_SHAPES;
+
+    // A new map or placed tower: rebuild the backdrop, then draw whole frames
+    if (!composer->has_backdrop || composer->backdrop_map != snapshot->map_index ||
+        composer->backdrop_revision != snapshot->scenery_revision) {
+        if (!map_blob_background(snapshot->map_index, &composer->background)) {
+            composer->background.height = 0;    // No background: black
+        }
+        composer->has_backdrop = false;
+        composer->history = 0;
+        composer->phase = RENDER_PHASE_BACKDROP;
+    }
+}
+
+// Damage is done: pick a partial or a full redraw
+static void compose_plan(RenderComposer* composer) {
+    composer->damage = composer->changes;
+    display_damage_add(&composer->damage, &composer->previous_changes);
+    uint32_t area = display_damage_area(&composer->damage);
+
+    composer->full = composer->history < 2 || area > RENDER_FULL_DAMAGE;
+    composer->stats.damage = composer->full ? MATRIX_WIDTH * MATRIX_HEIGHT : area;
+}
+
+bool render_compose_step(RenderComposer* composer) {
+    const DisplayList* list = &composer->snapshot->list;
+    const DisplayList* previous = &composer->previous;
+
+    switch (composer->phase) {
+        case RENDER_PHASE_BACKDROP: {
+            map_background_panel_row(&composer->background, composer->cursor,
+                                     composer->backdrop[composer->cursor]);
+            if (++composer->cursor < MATRIX_HEIGHT) return true;
+            composer->cursor = 0;
+            composer->phase = RENDER_PHASE_SCENERY;
+            return true;
+        }
+
+        case RENDER_PHASE_SCENERY: {
+            const DisplayList* scenery = &composer->snapshot->scenery;
+            if (composer->cursor < scenery->count) {
+                display_list_execute_to(scenery, composer->cursor, composer->cursor + 1,
+                                        composer->backdrop);
+                composer->cursor++;
+            }
+            if (composer->cursor < scenery->count) return true;
+
+            composer->has_backdrop = true;
+            composer->backdrop_map = composer->snapshot->map_index;
+            composer->backdrop_revision = composer->snapshot->scenery_revision;
+            composer->stats.backdrops++;
+            composer->cursor = 0;
+            composer->phase = RENDER_PHASE_DAMAGE_SHAPES;
+            return true;
+        }
+
+        case RENDER_PHASE_DAMAGE_SHAPES:
+            display_damage_clear(&composer->changes);
+            if (composer->history > 0) {
+                display_damage_add_commands(&composer->changes, previous, list);
+                composer->phase = RENDER_PHASE_DAMAGE_OLD;
+            } else {
+                compose_plan(composer);
+                composer->phase = RENDER_PHASE_RESTORE;
+            }
+            return true;
+
+        case RENDER_PHASE_DAMAGE_OLD:
+        case RENDER_PHASE_DAMAGE_NEW: {
+            const DisplayList* pixels = (composer->phase == RENDER_PHASE_DAMAGE_OLD) ? previous : list;
+            uint16_t end = composer->cursor + DISPLAY_LIST_PIXEL_BATCH;
+            if (end > pixels->pixel_count) end = pixels->pixel_count;
+            display_damage_add_pixels(&composer->changes, pixels, composer->cursor, end);
+            composer->cursor = end;
+            if (end < pixels->pixel_count) return true;
+
+            composer->cursor = 0;
+            if (composer->phase == RENDER_PHASE_DAMAGE_OLD) {
+                composer->phase = RENDER_PHASE_DAMAGE_NEW;
+            } else {
+                compose_plan(composer);
+                composer->phase = RENDER_PHASE_RESTORE;
+            }
+            return true;
+        }
+
+        case RENDER_PHASE_RESTORE: {
+            int y = composer->cursor;
+            if (composer->full) {
+                memcpy(frames[frame_index][y], composer->backdrop[y], sizeof(composer->backdrop[y]));
+            } else {
+                display_damage_restore_row(&composer->damage, y, composer->backdrop[y],
+                                           frames[frame_index][y]);
+            }
+            if (++composer->cursor < MATRIX_HEIGHT) return true;
+            composer->cursor = 0;
+            composer->phase = RENDER_PHASE_COMMANDS;
+            return true;
+        }
+
+        case RENDER_PHASE_COMMANDS:
+            if (composer->cursor < list->count) {
+                if (composer->full) {
+                    display_list_execute(list, composer->cursor, composer->cursor + 1);
+                } else {
+                    display_list_execute_damaged(list, composer->cursor, composer->cursor + 1,
+                                                 &composer->damage);
+                }
+                composer->cursor++;
+            }
+            if (composer->cursor < list->count) return true;
+            composer->phase = RENDER_PHASE_FINISH;
+            return true;
+
+        case RENDER_PHASE_FINISH:
+            // Remember this frame for the next two
+            display_list_copy(&composer->previous, list);
+            composer->previous_changes = composer->changes;
+            if (composer->history < 2) composer->history++;
+
+            composer->stats.frames++;
+            if (composer->full) composer->stats.full_frames++;
+            composer->phase = RENDER_PHASE_DONE;
+            return false;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,139 @@
+// render_snapshot.h - What a frame shows, captured so it can be drawn elsewhere
+//
+// After simulating, core 0 captures a RenderSnapshot of the game and
+// publishes it through a RenderExchange. Core 1 takes the latest one and
+// composes the frame from it a step at a time (RenderComposer), in the gaps
+// of its refresh loop, so drawing one frame overlaps simulating the next.
+//
+// A snapshot is the frame's display lists (display_list.h) with positions,
+// colours and the radar sweep already resolved. Composing never reads
+// GameState or the stat tables, so core 0 can run the next tick or retune
+// a table meanwhile.
+//
+// What only changes when a tower is placed (slots, radar ranges, tower
+// bodies) is the scenery, kept in a list of its own. Each snapshot buffer
+// re-records it only when GameState.scenery_revision moves on, and the
+// composer bakes it into its copy of the background, so frames draw just
+// the sweeps, enemies, projectiles and overlay.
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include "game_types.h"
+#include "map_blob.h"
+#include "display_list.h"
+
+typedef struct {
+    uint32_t    tick;
+    uint8_t     map_index;
+    bool        has_scenery;        // false: `scenery` holds nothing yet
+    uint16_t    scenery_revision;   // The game's scenery_revision when recorded
+    DisplayList scenery;            // Slots, ranges and tower bodies
+    DisplayList list;               // Everything drawn over them
+} RenderSnapshot;
+
+// Placement cursor: the selected tower's range around a slot
+typedef struct {
+    int16_t     x, y;
+    float       range;
+} RenderPlacement;
+
+// Record the drawable state of `game`, plus the placement cursor if
+// `placement` is not NULL, and finish the lists. The scenery is recorded
+// only if it changed since this snapshot last held it.
+void render_snapshot_capture(RenderSnapshot* snapshot, const GameState* game,
+                             const RenderPlacement* placement);
+
+// Draw everything but the background into the active framebuffer
+void render_snapshot_draw(const RenderSnapshot* snapshot);
+
+// ============================================================================
+// Hand-off between cores
+// ============================================================================
+
+// Lock-free triple buffer: the producer always has a buffer to write, the
+// consumer always keeps the one it is reading, and the third holds the
+// latest publication. A snapshot not taken before the next one is published
+// is dropped, never waited for.
+#define RENDER_EXCHANGE_FRESH   0x80
+
+typedef struct {
+    RenderSnapshot   buffers[3];
+    uint8_t          back;      // Producer's
+    uint8_t          front;     // Consumer's
+    volatile uint8_t middle;    // Buffer index, | RENDER_EXCHANGE_FRESH until taken
+} RenderExchange;
+
+void render_exchange_init(RenderExchange* exchange);
+
+// Producer: fill the back buffer, then publish it
+RenderSnapshot* render_exchange_back(RenderExchange* exchange);
+void render_exchange_publish(RenderExchange* exchange);
+
+// Consumer: the snapshot published since the last take, or NULL. It stays
+// valid until the next take.
+const RenderSnapshot* render_exchange_take(RenderExchange* exchange);
+
+// ============================================================================
+// Incremental composition
+// ============================================================================
+
+// Frames normally change in a few small places, so a frame is composed
+// over the one last shown in the same framebuffer, two frames back. Only
+// the pixels damaged in either of the last two frames are restored from
+// the backdrop (background and scenery) and redrawn. When the damage
+// covers more than RENDER_FULL_DAMAGE pixels, or the older frame is unknown
+// (first frames, new backdrop), the whole frame is restored and redrawn.
+#define RENDER_FULL_DAMAGE      (MATRIX_WIDTH * MATRIX_HEIGHT / 2)
+
+typedef enum {
+    RENDER_PHASE_BACKDROP = 0,      // Decode the background, one row per step
+    RENDER_PHASE_SCENERY,           // Bake in one scenery command per step
+    RENDER_PHASE_DAMAGE_SHAPES,
+    RENDER_PHASE_DAMAGE_OLD,        // Last frame's pixels, a batch per step
+    RENDER_PHASE_DAMAGE_NEW,        // This frame's pixels, a batch per step
+    RENDER_PHASE_RESTORE,           // One row per step
+    RENDER_PHASE_COMMANDS,          // One display list command per step
+    RENDER_PHASE_FINISH,
+    RENDER_PHASE_DONE
+} RenderPhase;
+
+typedef struct {
+    uint32_t frames;                // Composed
+    uint32_t full_frames;           // Of those, restored and redrawn whole
+    uint32_t damage;                // Pixels restored in the last frame
+    uint32_t backdrops;             // Backdrops built: map changes and placements
+    uint32_t us;                    // Time spent on the last frame (set by the caller)
+} RenderComposeStats;
+
+typedef struct {
+    const RenderSnapshot* snapshot;
+    uint8_t               phase;    // RenderPhase
+    uint16_t              cursor;   // Row, pixel or command within the phase
+    bool                  full;     // This frame is redrawn whole
+
+    MapBackground         background;
+    bool                  has_backdrop;
+    uint8_t               backdrop_map;     // What backdrop was built from
+    uint16_t              backdrop_revision;
+    uint8_t               history;          // Frames composed on it, up to 2
+    Color                 backdrop[MATRIX_HEIGHT][MATRIX_WIDTH];
+
+    DisplayList           previous;         // Last frame composed
+    DisplayDamage         changes;          // This frame against `previous`
+    DisplayDamage         previous_changes; // Last frame against the one before
+    DisplayDamage         damage;           // Both: what this framebuffer lacks
+
+    RenderComposeStats    stats;
+} RenderComposer;
+
+void render_composer_init(RenderComposer* composer);
+
+// Start composing `snapshot` (backdrop included) into the active
+// framebuffer. The snapshot must stay unchanged until composition is done,
+// and each frame must go to the other framebuffer than the last one.
+void render_compose_begin(RenderComposer* composer, const RenderSnapshot* snapshot);
+
+// Do one short step. Returns false once the frame is complete.
+bool render_compose_step(RenderComposer* composer);
+
+#endif // RENDER_SNAPSHOT_H
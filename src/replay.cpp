@@ -0,0 +1,375 @@
+// replay.cpp - Input-log recording, state hashing and headless replay
+#include "replay.h"
+#include "map_blob.h"
+
+#include <string.h>
+#include <stdio.h>
+
+// Worst-case encoded event: type + 5-byte varint delta + 5-byte payload
+#define REPLAY_EVENT_MAX    11
+// Room always kept back so the stream can be terminated
+#define REPLAY_END_RESERVE  6
+
+// ============================================================================
+// STATE HASH (FNV-1a, a word at a time)
+// ============================================================================
+
+#define HASH_OFFSET_BASIS   2166136261u
+#define HASH_PRIME          16777619u
+
+static uint32_t hash_bytes(uint32_t h, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+
+    while (size >= 4) {
+        uint32_t word;
+        memcpy(&word, p, 4);
+        h = (h ^ word) * HASH_PRIME;
+        p += 4;
+        size -= 4;
+    }
+    while (size > 0) {
+        h = (h ^ *p++) * HASH_PRIME;
+        size--;
+    }
+    return h;
+}
+
+// Only ever applied to arrays and scalars, which have no padding bytes
+#define HASH_FIELD(h, field)  hash_bytes((h), &(field), sizeof(field))
+
+template <uint16_t N>
+static uint32_t hash_pool(uint32_t h, const EntityPool<N>* pool) {
+    h = HASH_FIELD(h, pool->alive);
+    h = HASH_FIELD(h, pool->generation);
+    h = HASH_FIELD(h, pool->free_list);
+    return HASH_FIELD(h, pool->free_count);
+}
+
+uint32_t replay_state_hash(const GameState* game, const WaveManager* wm) {
+    uint32_t h = HASH_OFFSET_BASIS;
+
+    const EnemyStore* enemies = &game->enemies;
+    h = HASH_FIELD(h, enemies->x);
+    h = HASH_FIELD(h, enemies->y);
+    h = HASH_FIELD(h, enemies->progress);
+    h = HASH_FIELD(h, enemies->speed);
+    h = HASH_FIELD(h, enemies->health);
+    h = HASH_FIELD(h, enemies->type);
+    h = HASH_FIELD(h, enemies->segment);
+    h = HASH_FIELD(h, enemies->flags);
+    h = hash_pool(h, &enemies->pool);
+    h = HASH_FIELD(h, game->enemy_count);
+    h = HASH_FIELD(h, game->enemy_grid.head);
+    h = HASH_FIELD(h, game->enemy_grid.next);
+    h = HASH_FIELD(h, game->enemy_grid.prev);
+    h = HASH_FIELD(h, game->enemy_grid.cell);
+    h = HASH_FIELD(h, game->enemy_order);
+
+    const TowerStore* towers = &game->towers;
+    h = HASH_FIELD(h, towers->x);
+    h = HASH_FIELD(h, towers->y);
+    h = HASH_FIELD(h, towers->ready_tick);
+    h = HASH_FIELD(h, towers->type);
+    h = hash_bytes(h, towers->coverage, sizeof(towers->coverage));
+    h = HASH_FIELD(h, towers->coverage_count);
+    h = hash_pool(h, &towers->pool);
+    h = HASH_FIELD(h, game->tower_count);
+
+    const ProjectileStore* projs = &game->projectiles;
+    h = HASH_FIELD(h, projs->origin_x);
+    h = HASH_FIELD(h, projs->origin_y);
+    h = HASH_FIELD(h, projs->impact_x);
+    h = HASH_FIELD(h, projs->impact_y);
+    h = HASH_FIELD(h, projs->launch_tick);
+    h = HASH_FIELD(h, projs->impact_tick);
+    h = HASH_FIELD(h, projs->target);
+    h = HASH_FIELD(h, projs->damage);
+    h = HASH_FIELD(h, projs->splash_radius);
+    h = hash_pool(h, &projs->pool);
+    h = HASH_FIELD(h, game->projectile_count);
+
+    for (int i = 0; i < game->tower_slot_count; i++) {
+        h = HASH_FIELD(h, game->tower_slots[i].occupied);
+    }
+
+    h = HASH_FIELD(h, game->money);
+    h = HASH_FIELD(h, game->lives);
+    h = HASH_FIELD(h, game->score);
+    h = HASH_FIELD(h, game->tick);
+    h = HASH_FIELD(h, game->timers.due);
+    h = HASH_FIELD(h, game->timers.heap);
+    h = HASH_FIELD(h, game->timers.pos);
+    h = HASH_FIELD(h, game->timers.count);
+    h = HASH_FIELD(h, game->selected_tower);
+
+    h = HASH_FIELD(h, wm->wave_start_tick);
+    h = HASH_FIELD(h, wm->next_spawn_tick);
+    h = HASH_FIELD(h, wm->current_wave);
+    h = HASH_FIELD(h, wm->spawn_count);
+    h = HASH_FIELD(h, wm->spawns_completed);
+    h = HASH_FIELD(h, wm->wave_active);
+    h = HASH_FIELD(h, wm->wave_complete);
+    h = HASH_FIELD(h, wm->wave_complete_tick);
+    h = HASH_FIELD(h, wm->endless);
+    h = HASH_FIELD(h, wm->seed);
+    h = HASH_FIELD(h, wm->rng);
+
+    return h;
+}
+
+static inline uint32_t replay_roll(uint32_t rolling, uint32_t state_hash) {
+    return hash_bytes(rolling, &state_hash, sizeof(state_hash));
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+static void put_u8(ReplayRecorder* rec, uint8_t value) {
+    rec->data[rec->size++] = value;
+}
+
+static void put_u16(ReplayRecorder* rec, uint16_t value) {
+    put_u8(rec, (uint8_t)value);
+    put_u8(rec, (uint8_t)(value >> 8));
+}
+
+static void put_u32(ReplayRecorder* rec, uint32_t value) {
+    put_u16(rec, (uint16_t)value);
+    put_u16(rec, (uint16_t)(value >> 16));
+}
+
+static void put_varint(ReplayRecorder* rec, uint32_t value) {
+    while (value >= 0x80) {
+        put_u8(rec, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_u8(rec, (uint8_t)value);
+}
+
+// Writes the event's type and tick, or marks the recorder full
+static bool replay_begin_event(ReplayRecorder* rec, ReplayEventType type, uint32_t tick) {
+    if (rec->full) return false;
+    if (rec->size + REPLAY_EVENT_MAX + REPLAY_END_RESERVE > rec->capacity) {
+        rec->full = true;
+        return false;
+    }
+
+    put_u8(rec, (uint8_t)type);
+    put_varint(rec, tick - rec->last_tick);
+    rec->last_tick = tick;
+    return true;
+}
+
+void replay_recorder_start(ReplayRecorder* rec, uint8_t* buffer, uint32_t capacity,
+                           const GameState* game) {
+    rec->data = buffer;
+    rec->capacity = capacity;
+    rec->size = 0;
+    rec->last_tick = game->tick;
+    rec->rolling_hash = HASH_OFFSET_BASIS;
+    rec->full = (capacity < REPLAY_HEADER_SIZE + REPLAY_END_RESERVE);
+    if (rec->full) return;
+
+    put_u32(rec, REPLAY_MAGIC);
+    put_u16(rec, REPLAY_VERSION);
+    put_u8(rec, game->map_index);
+    put_u8(rec, MAX_TOWERS);
+    put_u16(rec, MAX_ENEMIES);
+    put_u8(rec, MAX_PROJECTILES);
+    put_u8(rec, SIM_TICK_HZ);
+}
+
+void replay_record_wave_start(ReplayRecorder* rec, uint32_t tick, uint16_t wave) {
+    if (replay_begin_event(rec, REPLAY_EV_WAVE_START, tick)) put_varint(rec, wave);
+}
+
+void replay_record_endless(ReplayRecorder* rec, uint32_t tick, uint32_t seed) {
+    if (replay_begin_event(rec, REPLAY_EV_ENDLESS, tick)) put_varint(rec, seed);
+}
+
+void replay_record_tag_scan(ReplayRecorder* rec, uint32_t tick, TowerType type) {
+    if (replay_begin_event(rec, REPLAY_EV_TAG_SCAN, tick)) put_u8(rec, (uint8_t)type);
+}
+
+void replay_record_slot(ReplayRecorder* rec, uint32_t tick, uint8_t slot) {
+    if (replay_begin_event(rec, REPLAY_EV_SLOT, tick)) put_u8(rec, slot);
+}
+
+void replay_record_place(ReplayRecorder* rec, uint32_t tick) {
+    replay_begin_event(rec, REPLAY_EV_PLACE, tick);
+}
+
+void replay_record_tick(ReplayRecorder* rec, const GameState* game, const WaveManager* wm) {
+    if (rec->full) return;
+
+    rec->rolling_hash = replay_roll(rec->rolling_hash, replay_state_hash(game, wm));
+    if (game->tick % REPLAY_CHECKPOINT_TICKS == 0 &&
+        replay_begin_event(rec, REPLAY_EV_CHECKPOINT, game->tick)) {
+        put_u32(rec, rec->rolling_hash);
+    }
+}
+
+void replay_dump(const ReplayRecorder* rec, uint32_t tick) {
+    if (rec->size == 0) return;  // Recording never started
+
+    // Terminate a copy of the tail so recording can carry on
+    uint8_t end[REPLAY_END_RESERVE];
+    ReplayRecorder tail = {end, sizeof(end), 0, rec->last_tick, 0, false};
+    put_u8(&tail, REPLAY_EV_END);
+    put_varint(&tail, tick - rec->last_tick);
+
+    printf("REPLAY BEGIN %lu\n", (unsigned long)(rec->size + tail.size));
+    for (uint32_t i = 0; i < rec->size + tail.size; i += 32) {
+        printf("REPLAY ");
+        for (uint32_t j = i; j < i + 32 && j < rec->size + tail.size; j++) {
+            printf("%02x", j < rec->size ? rec->data[j] : end[j - rec->size]);
+        }
+        printf("\n");
+    }
+    printf("REPLAY END\n");
+}
+
+// ============================================================================
+// PLAYBACK
+// ============================================================================
+
+static bool get_u8(const ReplayPlayer* player, uint32_t* pos, uint8_t* value) {
+    if (*pos >= player->size) return false;
+    *value = player->data[(*pos)++];
+    return true;
+}
+
+static bool get_u32(const ReplayPlayer* player, uint32_t* pos, uint32_t* value) {
+    if (*pos + 4 > player->size) return false;
+    const uint8_t* p = player->data + *pos;
+    *value = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    *pos += 4;
+    return true;
+}
+
+static bool get_varint(const ReplayPlayer* player, uint32_t* pos, uint32_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte;
+        if (!get_u8(player, pos, &byte)) return false;
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// Apply every event stamped with the current tick, in recorded order
+static void replay_apply_due(ReplayPlayer* player, GameState* game, WaveManager* wm) {
+    while (!player->finished) {
+        uint32_t pos = player->pos;
+        uint8_t type;
+        uint32_t delta;
+        if (!get_u8(player, &pos, &type) || !get_varint(player, &pos, &delta)) {
+            player->finished = true;  // Truncated stream
+            return;
+        }
+
+        uint32_t tick = player->event_tick + delta;
+        if (tick > game->tick) return;  // Not due yet
+
+        uint8_t u8 = 0;
+        uint32_t u32 = 0;
+        bool ok = true;
+
+        switch (type) {
+            case REPLAY_EV_WAVE_START:
+                ok = get_varint(player, &pos, &u32);
+                if (ok) wave_manager_start_wave(wm, (uint16_t)u32, game);
+                break;
+            case REPLAY_EV_ENDLESS:
+                ok = get_varint(player, &pos, &u32);
+                if (ok) wave_manager_set_endless(wm, u32);
+                break;
+            case REPLAY_EV_TAG_SCAN:
+                ok = get_u8(player, &pos, &u8) && u8 < GAME_TOWER_TYPE_COUNT;
+                if (ok) game->selected_tower = (TowerType)u8;
+                break;
+            case REPLAY_EV_SLOT:
+                ok = get_u8(player, &pos, &player->slot);
+                break;
+            case REPLAY_EV_PLACE:
+                if (player->slot < game->tower_slot_count) {
+                    const TowerSlot* slot = &game->tower_slots[player->slot];
+                    game_place_tower(game, game->selected_tower, slot->x, slot->y);
+                }
+                break;
+            case REPLAY_EV_CHECKPOINT:
+                ok = get_u32(player, &pos, &u32);
+                if (ok) {
+                    player->checkpoints++;
+                    if (u32 != player->rolling_hash && player->mismatches++ == 0) {
+                        player->first_mismatch_tick = tick;
+                    }
+                }
+                break;
+            case REPLAY_EV_END:
+                player->finished = true;
+                break;
+            default:
+                ok = false;
+                break;
+        }
+
+        if (!ok) {
+            player->finished = true;  // Truncated or unknown event
+            return;
+        }
+        player->event_tick = tick;
+        player->pos = pos;
+    }
+}
+
+bool replay_player_start(ReplayPlayer* player, const uint8_t* data, uint32_t size,
+                         GameState* game, WaveManager* wm) {
+    if (size < REPLAY_HEADER_SIZE) return false;
+
+    uint32_t magic = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+    uint16_t version = (uint16_t)(data[4] | (data[5] << 8));
+    uint8_t map_index = data[6];
+    uint8_t max_towers = data[7];
+    uint16_t max_enemies = (uint16_t)(data[8] | (data[9] << 8));
+    uint8_t max_projectiles = data[10];
+    uint8_t tick_hz = data[11];
+
+    if (magic != REPLAY_MAGIC || version != REPLAY_VERSION) {
+        printf("ERROR: Not a replay (or unsupported version)\n");
+        return false;
+    }
+    // Capacities decide which spawns and shots succeed, so they must match
+    if (max_towers != MAX_TOWERS || max_enemies != MAX_ENEMIES ||
+        max_projectiles != MAX_PROJECTILES || tick_hz != SIM_TICK_HZ) {
+        printf("ERROR: Replay was recorded with different capacities\n");
+        return false;
+    }
+
+    game_init(game);
+    if (map_index != game->map_index && !map_blob_load(game, map_index)) return false;
+    wave_manager_init(wm);
+
+    memset(player, 0, sizeof(*player));
+    player->data = data;
+    player->size = size;
+    player->pos = REPLAY_HEADER_SIZE;
+    player->event_tick = game->tick;
+    player->rolling_hash = HASH_OFFSET_BASIS;
+
+    replay_apply_due(player, game, wm);
+    return true;
+}
+
+bool replay_player_step(ReplayPlayer* player, GameState* game, WaveManager* wm) {
+    if (player->finished) return false;
+
+    wave_manager_update(wm, game);
+    game_step(game);
+    player->rolling_hash = replay_roll(player->rolling_hash, replay_state_hash(game, wm));
+
+    replay_apply_due(player, game, wm);
+    return !player->finished;
+}
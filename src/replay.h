@@ -0,0 +1,83 @@
+// replay.h - Input-log recording and headless replay
+//
+// A replay is the map, the wave schedule and every player action, each
+// stamped with the tick it was applied on, plus a rolling hash of the
+// simulation state checkpointed every REPLAY_CHECKPOINT_TICKS. Re-running
+// the inputs on the host must reproduce every checkpoint.
+//
+// Stream layout (little-endian): a header (magic u32, version u16, map u8,
+// then the MAX_TOWERS/MAX_ENEMIES/MAX_PROJECTILES and SIM_TICK_HZ the game
+// was built with), then events of
+//   type byte, varint ticks since the previous event, payload
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game_types.h"
+#include "wave_system.h"
+
+#define REPLAY_MAGIC            0x50524454u  // "TDRP"
+#define REPLAY_VERSION          1
+#define REPLAY_HEADER_SIZE      12
+#define REPLAY_CHECKPOINT_TICKS SIM_TICK_HZ
+
+typedef enum {
+    REPLAY_EV_WAVE_START = 1,   // varint wave number
+    REPLAY_EV_ENDLESS,          // varint seed
+    REPLAY_EV_TAG_SCAN,         // u8 TowerType
+    REPLAY_EV_SLOT,             // u8 slot index (placement cursor)
+    REPLAY_EV_PLACE,            // Place the selected tower at the cursor
+    REPLAY_EV_CHECKPOINT,       // u32 rolling hash after this tick
+    REPLAY_EV_END               // Last tick of the recording
+} ReplayEventType;
+
+typedef struct {
+    uint8_t*  data;
+    uint32_t  capacity;
+    uint32_t  size;
+    uint32_t  last_tick;        // Tick of the last event written
+    uint32_t  rolling_hash;
+    bool      full;             // Out of room; later events are dropped
+} ReplayRecorder;
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t  size;
+    uint32_t  pos;              // Next unread event
+    uint32_t  event_tick;       // Tick of the last event read
+    uint8_t   slot;             // Placement cursor
+    uint32_t  rolling_hash;
+    uint32_t  checkpoints;      // Checkpoints compared so far
+    uint32_t  mismatches;
+    uint32_t  first_mismatch_tick;
+    bool      finished;         // END reached (or the stream is truncated)
+} ReplayPlayer;
+
+// Hash of everything the simulation carries from tick to tick. Derived and
+// real-time fields (game_time, tick_accumulator) are left out.
+uint32_t replay_state_hash(const GameState* game, const WaveManager* wm);
+
+// Recording. Events carry the tick they were applied on: inputs between
+// frames are applied before the next tick runs.
+void replay_recorder_start(ReplayRecorder* rec, uint8_t* buffer, uint32_t capacity,
+                           const GameState* game);
+void replay_record_wave_start(ReplayRecorder* rec, uint32_t tick, uint16_t wave);
+void replay_record_endless(ReplayRecorder* rec, uint32_t tick, uint32_t seed);
+void replay_record_tag_scan(ReplayRecorder* rec, uint32_t tick, TowerType type);
+void replay_record_slot(ReplayRecorder* rec, uint32_t tick, uint8_t slot);
+void replay_record_place(ReplayRecorder* rec, uint32_t tick);
+// Call after every game_step()
+void replay_record_tick(ReplayRecorder* rec, const GameState* game, const WaveManager* wm);
+
+// Print the stream (terminated at `tick`) as "REPLAY" hex lines on stdout,
+// for capture from the serial console. Recording can continue afterwards.
+void replay_dump(const ReplayRecorder* rec, uint32_t tick);
+
+// Playback: validates the header and sets up a fresh game on the recorded
+// map. Returns false if the stream is not usable with this build.
+bool replay_player_start(ReplayPlayer* player, const uint8_t* data, uint32_t size,
+                         GameState* game, WaveManager* wm);
+// Runs one tick (waves, game_step), then applies the events stamped with it,
+// checking any checkpoint. Returns false once the recording has ended.
+bool replay_player_step(ReplayPlayer* player, GameState* game, WaveManager* wm);
+
+#endif // REPLAY_H
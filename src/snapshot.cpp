@@ -0,0 +1,344 @@
+// snapshot.cpp - Bit-packed save/resume of GameState and WaveManager
+#include "snapshot.h"
+#include "map_blob.h"
+
+#include <string.h>
+#include <math.h>
+
+static_assert(sizeof(SnapshotHeader) == SNAPSHOT_HEADER_SIZE, "SnapshotHeader is stored as-is");
+static_assert(ENEMY_GHOST < 4 && GAME_TOWER_TYPE_COUNT <= 4, "types are stored in 2 bits");
+
+// Bits needed to hold 0..n-1
+static constexpr int bits_for(uint32_t n) {
+    int bits = 0;
+    while ((1u << bits) < n) bits++;
+    return bits;
+}
+
+#define ENEMY_SLOT_BITS     bits_for(MAX_ENEMIES)
+#define TOWER_SLOT_BITS     bits_for(MAX_TOWERS)
+#define TYPE_BITS           2
+#define PROGRESS_BITS       16
+#define POS_X_BITS          bits_for((MATRIX_WIDTH + 2 * SNAPSHOT_POS_MARGIN) * SNAPSHOT_POS_SCALE)
+#define POS_Y_BITS          bits_for((MATRIX_HEIGHT + 2 * SNAPSHOT_POS_MARGIN) * SNAPSHOT_POS_SCALE)
+
+#define ENEMY_BITS          (ENEMY_SLOT_BITS + TYPE_BITS + 1 + SNAPSHOT_HEALTH_BITS + PROGRESS_BITS)
+#define TOWER_BITS          (TOWER_SLOT_BITS + TYPE_BITS + SNAPSHOT_TICK_BITS)
+#define PROJECTILE_BITS     (2 * (POS_X_BITS + POS_Y_BITS) + 2 * SNAPSHOT_TICK_BITS + \
+                             1 + ENEMY_SLOT_BITS + 8 + 8)
+// Scalars of GameState and WaveManager, plus the three entity counts
+#define FIXED_BITS          (32 + 8 + 32 + 32 + 8 + 8 + 8 +                 \
+                             32 + 32 + 16 + 16 + 16 + 3 + 32 + 32 + 32 +     \
+                             bits_for(MAX_ENEMIES + 1) + bits_for(MAX_TOWERS + 1) + \
+                             bits_for(MAX_PROJECTILES + 1))
+
+// Longest possible path (every segment a screen diagonal) must quantize
+static_assert((MAX_PATH_WAYPOINTS - 1) * 72 * SNAPSHOT_PROGRESS_SCALE < (1 << PROGRESS_BITS),
+              "progress does not fit PROGRESS_BITS");
+
+uint32_t snapshot_max_size() {
+    uint32_t bits = FIXED_BITS + MAX_ENEMIES * ENEMY_BITS + MAX_TOWERS * TOWER_BITS +
+                    MAX_PROJECTILES * PROJECTILE_BITS;
+    return SNAPSHOT_HEADER_SIZE + (bits + 7) / 8;
+}
+
+// ============================================================================
+// BIT STREAMS
+// ============================================================================
+
+typedef struct {
+    uint8_t*  data;
+    uint32_t  capacity;   // Bytes
+    uint32_t  bit_pos;
+    bool      overflow;
+} BitWriter;
+
+typedef struct {
+    const uint8_t* data;
+    uint32_t  size;       // Bytes
+    uint32_t  bit_pos;
+    bool      overflow;
+} BitReader;
+
+static void put_bits(BitWriter* w, uint32_t value, int count) {
+    if (w->bit_pos + count > w->capacity * 8) {
+        w->overflow = true;
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        uint32_t byte = w->bit_pos >> 3;
+        uint8_t bit = (uint8_t)(1u << (w->bit_pos & 7));
+        if ((value >> i) & 1u) {
+            w->data[byte] |= bit;
+        } else {
+            w->data[byte] &= (uint8_t)~bit;
+        }
+        w->bit_pos++;
+    }
+}
+
+static uint32_t get_bits(BitReader* r, int count) {
+    if (r->bit_pos + count > r->size * 8) {
+        r->overflow = true;
+        return 0;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < count; i++) {
+        value |= (uint32_t)((r->data[r->bit_pos >> 3] >> (r->bit_pos & 7)) & 1u) << i;
+        r->bit_pos++;
+    }
+    return value;
+}
+
+// Clamp to what `count` bits can hold
+static inline uint32_t clamp_bits(int64_t value, int count) {
+    int64_t max = ((int64_t)1 << count) - 1;
+    if (value < 0) return 0;
+    return (uint32_t)(value > max ? max : value);
+}
+
+static inline uint32_t quantize_pos(float value, int count) {
+    return clamp_bits(lroundf((value + SNAPSHOT_POS_MARGIN) * SNAPSHOT_POS_SCALE), count);
+}
+
+static inline float dequantize_pos(uint32_t value) {
+    return (float)value / SNAPSHOT_POS_SCALE - SNAPSHOT_POS_MARGIN;
+}
+
+// ============================================================================
+// ENCODE
+// ============================================================================
+
+uint32_t snapshot_encode(const GameState* game, const WaveManager* wm,
+                         uint8_t* out, uint32_t capacity) {
+    if (capacity < SNAPSHOT_HEADER_SIZE) return 0;
+
+    BitWriter w = {out + SNAPSHOT_HEADER_SIZE, capacity - SNAPSHOT_HEADER_SIZE, 0, false};
+    if (w.capacity > 0xFFFF) w.capacity = 0xFFFF;
+
+    put_bits(&w, game->money, 32);
+    put_bits(&w, game->lives, 8);
+    put_bits(&w, game->score, 32);
+    put_bits(&w, game->tick, 32);
+    put_bits(&w, game->selected_tower, 8);
+    put_bits(&w, game->wave_number, 8);
+    put_bits(&w, game->total_waves, 8);
+
+    put_bits(&w, wm->wave_start_tick, 32);
+    put_bits(&w, wm->next_spawn_tick, 32);
+    put_bits(&w, wm->current_wave, 16);
+    put_bits(&w, wm->spawn_count, 16);
+    put_bits(&w, wm->spawns_completed, 16);
+    put_bits(&w, wm->wave_active, 1);
+    put_bits(&w, wm->wave_complete, 1);
+    put_bits(&w, wm->endless, 1);
+    put_bits(&w, wm->wave_complete_tick, 32);
+    put_bits(&w, wm->seed, 32);
+    put_bits(&w, wm->rng, 32);
+
+    // Enemies in progress order, so enemy_order comes back as it was
+    const EnemyStore* enemies = &game->enemies;
+    put_bits(&w, game->enemy_count, bits_for(MAX_ENEMIES + 1));
+    for (int k = 0; k < game->enemy_count; k++) {
+        EnemyIndex i = game->enemy_order[k];
+        put_bits(&w, i, ENEMY_SLOT_BITS);
+        put_bits(&w, enemies->type[i], TYPE_BITS);
+        put_bits(&w, (enemies->flags[i] & ENEMY_FLAG_REVEALED) != 0, 1);
+        put_bits(&w, clamp_bits(enemies->health[i], SNAPSHOT_HEALTH_BITS), SNAPSHOT_HEALTH_BITS);
+        put_bits(&w, clamp_bits(lroundf(enemies->progress[i] * SNAPSHOT_PROGRESS_SCALE),
+                                PROGRESS_BITS), PROGRESS_BITS);
+    }
+
+    // Towers by the slot they stand on
+    const TowerStore* towers = &game->towers;
+    put_bits(&w, game->tower_count, bits_for(MAX_TOWERS + 1));
+    for (int i = mask_next(towers->pool.alive, MAX_TOWERS, 0); i >= 0;
+         i = mask_next(towers->pool.alive, MAX_TOWERS, i + 1)) {
+        int slot = 0;
+        while (slot < game->tower_slot_count &&
+               (game->tower_slots[slot].x != (int16_t)towers->x[i] ||
+                game->tower_slots[slot].y != (int16_t)towers->y[i])) {
+            slot++;
+        }
+        put_bits(&w, (uint32_t)slot, TOWER_SLOT_BITS);
+        put_bits(&w, towers->type[i], TYPE_BITS);
+        put_bits(&w, clamp_bits((int64_t)towers->ready_tick[i] - game->tick,
+                                SNAPSHOT_TICK_BITS), SNAPSHOT_TICK_BITS);
+    }
+
+    // Projectiles; a target that no longer resolves is stored as none
+    const ProjectileStore* projs = &game->projectiles;
+    put_bits(&w, game->projectile_count, bits_for(MAX_PROJECTILES + 1));
+    for (int i = mask_next(projs->pool.alive, MAX_PROJECTILES, 0); i >= 0;
+         i = mask_next(projs->pool.alive, MAX_PROJECTILES, i + 1)) {
+        put_bits(&w, quantize_pos(projs->origin_x[i], POS_X_BITS), POS_X_BITS);
+        put_bits(&w, quantize_pos(projs->origin_y[i], POS_Y_BITS), POS_Y_BITS);
+        put_bits(&w, quantize_pos(projs->impact_x[i], POS_X_BITS), POS_X_BITS);
+        put_bits(&w, quantize_pos(projs->impact_y[i], POS_Y_BITS), POS_Y_BITS);
+        put_bits(&w, clamp_bits((int64_t)game->tick - projs->launch_tick[i],
+                                SNAPSHOT_TICK_BITS), SNAPSHOT_TICK_BITS);
+        put_bits(&w, clamp_bits((int64_t)projs->impact_tick[i] - game->tick,
+                                SNAPSHOT_TICK_BITS), SNAPSHOT_TICK_BITS);
+
+        int target = pool_resolve(&enemies->pool, projs->target[i]);
+        put_bits(&w, target >= 0, 1);
+        put_bits(&w, target >= 0 ? (uint32_t)target : 0, ENEMY_SLOT_BITS);
+        put_bits(&w, projs->damage[i], 8);
+        put_bits(&w, projs->splash_radius[i], 8);
+    }
+
+    if (w.overflow) return 0;
+
+    uint32_t payload_size = (w.bit_pos + 7) / 8;
+    if (w.bit_pos & 7) {
+        put_bits(&w, 0, 8 - (w.bit_pos & 7));  // Deterministic padding for the crc
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.payload_size = (uint16_t)payload_size;
+    header.max_enemies = MAX_ENEMIES;
+    header.max_towers = MAX_TOWERS;
+    header.max_projectiles = MAX_PROJECTILES;
+    header.map_index = game->map_index;
+    header.panel_width = MATRIX_WIDTH;
+    header.panel_height = MATRIX_HEIGHT;
+    memcpy(out, &header, sizeof(header));
+
+    return SNAPSHOT_HEADER_SIZE + payload_size;
+}
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+const SnapshotHeader* snapshot_header(const uint8_t* data, uint32_t size) {
+    if (size < SNAPSHOT_HEADER_SIZE) return NULL;
+
+    const SnapshotHeader* header = (const SnapshotHeader*)data;
+    if (header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION) return NULL;
+    if (header->payload_size > size - SNAPSHOT_HEADER_SIZE) return NULL;
+    // Field widths follow the capacities and panel, so only the same build can read it
+    if (header->max_enemies != MAX_ENEMIES || header->max_towers != MAX_TOWERS ||
+        header->max_projectiles != MAX_PROJECTILES ||
+        header->panel_width != MATRIX_WIDTH || header->panel_height != MATRIX_HEIGHT) {
+        return NULL;
+    }
+    return header;
+}
+
+bool snapshot_decode(const uint8_t* data, uint32_t size, GameState* game, WaveManager* wm) {
+    const SnapshotHeader* header = snapshot_header(data, size);
+    if (header == NULL) return false;
+
+    game_init(game);
+    if (header->map_index != game->map_index && !map_blob_load(game, header->map_index)) {
+        return false;
+    }
+    wave_manager_init(wm);
+
+    BitReader r = {data + SNAPSHOT_HEADER_SIZE, header->payload_size, 0, false};
+
+    game->money = get_bits(&r, 32);
+    game->lives = (uint8_t)get_bits(&r, 8);
+    game->score = get_bits(&r, 32);
+    game->tick = get_bits(&r, 32);
+    game->selected_tower = (TowerType)get_bits(&r, 8);
+    game->wave_number = (uint8_t)get_bits(&r, 8);
+    game->total_waves = (uint8_t)get_bits(&r, 8);
+    game->game_time = game->tick * SIM_DT;
+    if (game->selected_tower >= GAME_TOWER_TYPE_COUNT) return false;
+
+    wm->wave_start_tick = get_bits(&r, 32);
+    wm->next_spawn_tick = get_bits(&r, 32);
+    wm->current_wave = (uint16_t)get_bits(&r, 16);
+    wm->spawn_count = (uint16_t)get_bits(&r, 16);
+    wm->spawns_completed = (uint16_t)get_bits(&r, 16);
+    wm->wave_active = get_bits(&r, 1);
+    wm->wave_complete = get_bits(&r, 1);
+    wm->endless = get_bits(&r, 1);
+    wm->wave_complete_tick = get_bits(&r, 32);
+    wm->seed = get_bits(&r, 32);
+    wm->rng = get_bits(&r, 32);
+    if (wm->wave_active && !wm->endless && wm->current_wave >= wave_manager_get_total_waves()) {
+        return false;
+    }
+
+    // Enemies: position, segment and grid cell follow from progress
+    EnemyStore* enemies = &game->enemies;
+    uint16_t enemy_count = (uint16_t)get_bits(&r, bits_for(MAX_ENEMIES + 1));
+    if (enemy_count > MAX_ENEMIES) return false;
+    for (int k = 0; k < enemy_count; k++) {
+        EnemyIndex i = (EnemyIndex)get_bits(&r, ENEMY_SLOT_BITS);
+        EnemyType type = (EnemyType)get_bits(&r, TYPE_BITS);
+        bool revealed = get_bits(&r, 1);
+        int16_t health = (int16_t)get_bits(&r, SNAPSHOT_HEALTH_BITS);
+        float progress = (float)get_bits(&r, PROGRESS_BITS) / SNAPSHOT_PROGRESS_SCALE;
+        if (r.overflow || i >= MAX_ENEMIES || pool_is_alive(&enemies->pool, i)) return false;
+
+        enemy_init(enemies, i, type);
+        enemies->health[i] = health;
+        if (revealed) enemies->flags[i] |= ENEMY_FLAG_REVEALED;
+        enemies->progress[i] = progress;
+        enemies->segment[i] = path_segment_at(&game->path_geometry, progress);
+        path_point_at(&game->path_geometry, game->path, progress,
+                      &enemies->segment[i], &enemies->x[i], &enemies->y[i]);
+        mask_set(enemies->pool.alive, i);
+        spatial_grid_insert(&game->enemy_grid, i, enemies->x[i], enemies->y[i]);
+        game->enemy_order[k] = i;
+    }
+    pool_rebuild_free_list(&enemies->pool);
+    game->enemy_count = enemy_count;
+
+    // Towers wake on the first tick after resume and reschedule themselves
+    TowerStore* towers = &game->towers;
+    uint8_t tower_count = (uint8_t)get_bits(&r, bits_for(MAX_TOWERS + 1));
+    if (tower_count > MAX_TOWERS) return false;
+    for (int k = 0; k < tower_count; k++) {
+        uint8_t slot = (uint8_t)get_bits(&r, TOWER_SLOT_BITS);
+        TowerType type = (TowerType)get_bits(&r, TYPE_BITS);
+        uint32_t ready = game->tick + get_bits(&r, SNAPSHOT_TICK_BITS);
+        if (r.overflow || slot >= game->tower_slot_count || game->tower_slots[slot].occupied ||
+            type >= GAME_TOWER_TYPE_COUNT) {
+            return false;
+        }
+
+        int i = pool_alloc(&towers->pool);
+        TowerSlot* tower_slot = &game->tower_slots[slot];
+        tower_init(towers, (uint8_t)i, type, tower_slot->x, tower_slot->y);
+        tower_compute_coverage(game, (uint8_t)i);
+        towers->ready_tick[i] = ready;
+        timer_arm(&game->timers, TIMER_TOWER(i), ready > game->tick ? ready : game->tick + 1);
+        tower_slot->occupied = true;
+        game->tower_count++;
+    }
+    game_scenery_changed(game);
+
+    ProjectileStore* projs = &game->projectiles;
+    uint8_t projectile_count = (uint8_t)get_bits(&r, bits_for(MAX_PROJECTILES + 1));
+    if (projectile_count > MAX_PROJECTILES) return false;
+    for (int k = 0; k < projectile_count; k++) {
+        int i = pool_alloc(&projs->pool);
+        projs->origin_x[i] = dequantize_pos(get_bits(&r, POS_X_BITS));
+        projs->origin_y[i] = dequantize_pos(get_bits(&r, POS_Y_BITS));
+        projs->impact_x[i] = dequantize_pos(get_bits(&r, POS_X_BITS));
+        projs->impact_y[i] = dequantize_pos(get_bits(&r, POS_Y_BITS));
+        projs->launch_tick[i] = game->tick - get_bits(&r, SNAPSHOT_TICK_BITS);
+        projs->impact_tick[i] = game->tick + get_bits(&r, SNAPSHOT_TICK_BITS);
+        if (projs->impact_tick[i] == game->tick) projs->impact_tick[i]++;
+
+        bool has_target = get_bits(&r, 1);
+        EnemyIndex target = (EnemyIndex)get_bits(&r, ENEMY_SLOT_BITS);
+        projs->target[i] = (has_target && target < MAX_ENEMIES)
+                         ? pool_handle(&enemies->pool, target) : HANDLE_NONE;
+        projs->damage[i] = (uint8_t)get_bits(&r, 8);
+        projs->splash_radius[i] = (uint8_t)get_bits(&r, 8);
+
+        timer_arm(&game->timers, TIMER_PROJECTILE(i), projs->impact_tick[i]);
+        game->projectile_count++;
+    }
+
+    return !r.overflow;
+}
@@ -0,0 +1,59 @@
+// snapshot.h - Compact save/resume format for a game in progress
+//
+// A snapshot is a byte-aligned header followed by a bit-packed payload
+// (LSB first). Only state that cannot be rebuilt is stored: enemy slot,
+// type, health and quantized progress (position, segment, grid and speed
+// are re-derived from the path), towers by slot index, and projectiles
+// with quantized endpoints. Timers are re-armed on restore, so a resumed
+// game plays on like the original up to the quantization.
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game_types.h"
+#include "wave_system.h"
+
+#define SNAPSHOT_MAGIC          0x4E534454u  // "TDSN"
+#define SNAPSHOT_VERSION        2
+#define SNAPSHOT_HEADER_SIZE    20
+
+// Fixed-point scales for the quantized fields
+#define SNAPSHOT_PROGRESS_SCALE 32   // 1/32 px, 16 bits: paths up to 2048 px
+#define SNAPSHOT_POS_SCALE      8    // 1/8 px for projectile endpoints
+#define SNAPSHOT_POS_MARGIN     16   // Endpoints may lie this far off-screen
+#define SNAPSHOT_HEALTH_BITS    12
+#define SNAPSHOT_TICK_BITS      16   // Cooldowns and flight times, clamped
+
+// Header layout (little-endian): magic u32, version u16, payload size u16,
+// payload crc u32, max_enemies u16, max_towers u8, max_projectiles u8,
+// map index u8, panel width u8, panel height u8, sequence u8
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t payload_size;
+    uint32_t crc;                // Filled in by the storage layer
+    uint16_t max_enemies;
+    uint8_t  max_towers;
+    uint8_t  max_projectiles;
+    uint8_t  map_index;
+    uint8_t  panel_width;        // Position fields are sized by the panel
+    uint8_t  panel_height;
+    uint8_t  sequence;           // Filled in by the storage layer: the newer copy
+} SnapshotHeader;
+
+// Upper bound on an encoded snapshot for this build's capacities
+uint32_t snapshot_max_size();
+
+// Serialize into `out`. Returns the total size (header + payload), or 0 if
+// `capacity` is too small. The header crc is left 0.
+uint32_t snapshot_encode(const GameState* game, const WaveManager* wm,
+                         uint8_t* out, uint32_t capacity);
+
+// The header if it is a snapshot this build can read (the crc is not
+// checked here), else NULL
+const SnapshotHeader* snapshot_header(const uint8_t* data, uint32_t size);
+
+// Rebuild a game from a snapshot. Returns false (game state undefined) if
+// the snapshot does not fit this build.
+bool snapshot_decode(const uint8_t* data, uint32_t size, GameState* game, WaveManager* wm);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,106 @@
+// snapshot_flash.cpp - Snapshot storage in two reserved flash sectors
+//
+// Saves alternate between the sectors, and each carries a sequence number
+// in its header. A save erases the older copy's sector only, so the newer
+// one survives a power cut until the new save is written and read back.
+#include "snapshot_flash.hh"
+#include "snapshot.h"
+#include "flash_io.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+static const uint32_t SNAPSHOT_SECTORS[2] = {FLASH_SNAPSHOT_OFFSET, FLASH_SNAPSHOT_OFFSET_2};
+
+static uint8_t __attribute__((aligned(4))) snapshot_buffer[FLASH_SECTOR_SIZE];
+
+// The sector's snapshot header if it holds an intact snapshot of this build
+static const SnapshotHeader* snapshot_sector_header(int sector) {
+    const uint8_t* flash = flash_io_read(SNAPSHOT_SECTORS[sector]);
+    const SnapshotHeader* header = snapshot_header(flash, FLASH_SECTOR_SIZE);
+    if (header == NULL) return NULL;  // Erased, or written by another build
+
+    if (flash_io_crc32(flash + SNAPSHOT_HEADER_SIZE, header->payload_size) != header->crc) {
+        printf("Snapshot crc mismatch in sector %d\n", sector);
+        return NULL;
+    }
+    return header;
+}
+
+// The sector holding the newest intact snapshot, or -1
+static int snapshot_newest_sector() {
+    const SnapshotHeader* headers[2] = {snapshot_sector_header(0), snapshot_sector_header(1)};
+    if (headers[0] != NULL && headers[1] != NULL) {
+        return ((int8_t)(headers[1]->sequence - headers[0]->sequence) > 0) ? 1 : 0;
+    }
+    if (headers[0] != NULL) return 0;
+    if (headers[1] != NULL) return 1;
+    return -1;
+}
+
+bool snapshot_flash_save(const GameState* game, const WaveManager* wm) {
+    uint32_t start = time_us_32();
+
+    uint32_t size = snapshot_encode(game, wm, snapshot_buffer, sizeof(snapshot_buffer));
+    if (size == 0) {
+        printf("ERROR: Snapshot does not fit a flash sector\n");
+        return false;
+    }
+    uint32_t program_size = (size + FLASH_PAGE_SIZE - 1) & ~(FLASH_PAGE_SIZE - 1);
+    memset(snapshot_buffer + size, 0xFF, program_size - size);
+
+    // Write over the older copy, never the newest
+    int newest = snapshot_newest_sector();
+    int target = (newest == 0) ? 1 : 0;
+    uint8_t sequence = 0;
+    if (newest >= 0) {
+        sequence = ((const SnapshotHeader*)flash_io_read(SNAPSHOT_SECTORS[newest]))->sequence + 1;
+    }
+
+    SnapshotHeader* header = (SnapshotHeader*)snapshot_buffer;
+    header->sequence = sequence;
+    header->crc = flash_io_crc32(snapshot_buffer + SNAPSHOT_HEADER_SIZE, header->payload_size);
+    uint32_t encoded = time_us_32();
+
+    uint32_t offset = SNAPSHOT_SECTORS[target];
+    uint32_t stall = flash_io_erase(offset);
+    stall += flash_io_program(offset, snapshot_buffer, program_size);
+
+    if (memcmp(flash_io_read(offset), snapshot_buffer, program_size) != 0) {
+        printf("ERROR: Snapshot did not verify in sector %d\n", target);
+        return false;
+    }
+
+    printf("Snapshot saved: %lu bytes in sector %d, encode %lu us, flash stall %lu us\n",
+           (unsigned long)size, target, (unsigned long)(encoded - start), (unsigned long)stall);
+    return true;
+}
+
+bool snapshot_flash_load(GameState* game, WaveManager* wm) {
+    uint32_t start = time_us_32();
+
+    // Newest first; an older copy still beats starting over
+    int newest = snapshot_newest_sector();
+    if (newest < 0) return false;
+
+    for (int k = 0; k < 2; k++) {
+        int sector = newest ^ k;
+        const SnapshotHeader* header = snapshot_sector_header(sector);
+        if (header == NULL) continue;
+
+        if (!snapshot_decode(flash_io_read(SNAPSHOT_SECTORS[sector]), FLASH_SECTOR_SIZE, game, wm)) {
+            printf("Snapshot in sector %d rejected\n", sector);
+            continue;
+        }
+
+        printf("Snapshot restored: %lu bytes in %lu us (sector %d, wave %d, tick %lu)\n",
+               (unsigned long)(SNAPSHOT_HEADER_SIZE + header->payload_size),
+               (unsigned long)(time_us_32() - start), sector, wm->current_wave + 1,
+               (unsigned long)game->tick);
+        return true;
+    }
+
+    printf("No usable snapshot, starting a new game\n");
+    return false;
+}
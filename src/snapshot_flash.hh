@@ -0,0 +1,18 @@
+// snapshot_flash.hh - Game snapshots in two reserved flash sectors
+#ifndef SNAPSHOT_FLASH_HH
+#define SNAPSHOT_FLASH_HH
+
+#include "game_types.h"
+#include "wave_system.h"
+
+// Encode the game and write it over the older of the two saved copies, then
+// read it back. Core 1 must have called multicore_lockout_victim_init(): it
+// is parked (and the panel blanked) while the sector is erased and
+// programmed. Prints the snapshot size and the stall.
+bool snapshot_flash_save(const GameState* game, const WaveManager* wm);
+
+// Restore the newest intact saved game, falling back to the older copy.
+// Returns false if neither is usable.
+bool snapshot_flash_load(GameState* game, WaveManager* wm);
+
+#endif // SNAPSHOT_FLASH_HH
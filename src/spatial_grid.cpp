@@ -0,0 +1,105 @@
+// spatial_grid.cpp - Uniform-grid spatial index for enemy range queries
+#include "game_types.h"
+
+#include <string.h>
+
+// Map a position to its bucket, clamping anything just off-screen (spawn and
+// exit points sit on the border) into the edge buckets.
+static inline uint8_t grid_cell_of(float x, float y) {
+    int cx = (int)x >> GRID_CELL_SHIFT;
+    int cy = (int)y >> GRID_CELL_SHIFT;
+
+    if (x < 0.0f) cx = 0;
+    if (y < 0.0f) cy = 0;
+    if (cx >= GRID_COLS) cx = GRID_COLS - 1;
+    if (cy >= GRID_ROWS) cy = GRID_ROWS - 1;
+
+    return (uint8_t)(cy * GRID_COLS + cx);
+}
+
+static inline int grid_clamp(int v, int max) {
+    if (v < 0) return 0;
+    if (v > max) return max;
+    return v;
+}
+
+static void grid_link(SpatialGrid* grid, EnemyIndex index, uint8_t cell) {
+    EnemyIndex old_head = grid->head[cell];
+
+    grid->cell[index] = cell;
+    grid->prev[index] = GRID_NONE;
+    grid->next[index] = old_head;
+    if (old_head != GRID_NONE) {
+        grid->prev[old_head] = index;
+    }
+    grid->head[cell] = index;
+}
+
+static void grid_unlink(SpatialGrid* grid, EnemyIndex index) {
+    uint8_t cell = grid->cell[index];
+    EnemyIndex prev = grid->prev[index];
+    EnemyIndex next = grid->next[index];
+
+    if (prev != GRID_NONE) {
+        grid->next[prev] = next;
+    } else {
+        grid->head[cell] = next;
+    }
+    if (next != GRID_NONE) {
+        grid->prev[next] = prev;
+    }
+
+    grid->cell[index] = GRID_NO_CELL;
+}
+
+void spatial_grid_clear(SpatialGrid* grid) {
+    for (int c = 0; c < GRID_CELL_COUNT; c++) {
+        grid->head[c] = GRID_NONE;
+    }
+    memset(grid->cell, GRID_NO_CELL, sizeof(grid->cell));
+}
+
+void spatial_grid_insert(SpatialGrid* grid, EnemyIndex index, float x, float y) {
+    if (grid->cell[index] != GRID_NO_CELL) {
+        grid_unlink(grid, index);
+    }
+    grid_link(grid, index, grid_cell_of(x, y));
+}
+
+void spatial_grid_remove(SpatialGrid* grid, EnemyIndex index) {
+    if (grid->cell[index] == GRID_NO_CELL) return;
+    grid_unlink(grid, index);
+}
+
+void spatial_grid_update(SpatialGrid* grid, EnemyIndex index, float x, float y) {
+    uint8_t cell = grid_cell_of(x, y);
+    if (cell == grid->cell[index]) return;  // Common case: same bucket
+
+    if (grid->cell[index] != GRID_NO_CELL) {
+        grid_unlink(grid, index);
+    }
+    grid_link(grid, index, cell);
+}
+
+uint16_t spatial_grid_query(const SpatialGrid* grid, float x, float y, float radius,
+                            EnemyIndex* out, uint16_t max_out) {
+    int min_cx = grid_clamp((int)(x - radius) >> GRID_CELL_SHIFT, GRID_COLS - 1);
+    int max_cx = grid_clamp((int)(x + radius) >> GRID_CELL_SHIFT, GRID_COLS - 1);
+    int min_cy = grid_clamp((int)(y - radius) >> GRID_CELL_SHIFT, GRID_ROWS - 1);
+    int max_cy = grid_clamp((int)(y + radius) >> GRID_CELL_SHIFT, GRID_ROWS - 1);
+
+    uint16_t count = 0;
+
+    for (int cy = min_cy; cy <= max_cy; cy++) {
+        for (int cx = min_cx; cx <= max_cx; cx++) {
+            EnemyIndex i = grid->head[cy * GRID_COLS + cx];
+            while (i != GRID_NONE) {
+                if (count >= max_out) return count;
+                out[count++] = i;
+                i = grid->next[i];
+            }
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,70 @@
+// targeting.h - Compile-time tower targeting policies
+//
+// Each policy is a type passed as a template argument to the tower batch
+// update in game.cpp, so the choice is resolved at compile time and the
+// per-enemy loop contains only the policy's own comparison.
+#ifndef TARGETING_H
+#define TARGETING_H
+
+#include "game_types.h"
+
+// How the candidate search walks a tower's coverage intervals
+typedef enum {
+    SCAN_FROM_END,    // First valid enemy from the end of the path wins
+    SCAN_FROM_START,  // First valid enemy from the start of the path wins
+    SCAN_ALL          // Every enemy in range is scored; highest score wins
+} TargetScan;
+
+// Furthest along the path (the classic default)
+struct TargetFirst {
+    static constexpr TargetScan kScan = SCAN_FROM_END;
+};
+
+// Least far along the path
+struct TargetLast {
+    static constexpr TargetScan kScan = SCAN_FROM_START;
+};
+
+// Most remaining health
+struct TargetStrongest {
+    static constexpr TargetScan kScan = SCAN_ALL;
+    static inline float score(const EnemyStore* enemies, int i, float tx, float ty) {
+        (void)tx;
+        (void)ty;
+        return (float)enemies->health[i];
+    }
+};
+
+// Nearest to the tower
+struct TargetClosest {
+    static constexpr TargetScan kScan = SCAN_ALL;
+    static inline float score(const EnemyStore* enemies, int i, float tx, float ty) {
+        return -distance_squared(tx, ty, enemies->x[i], enemies->y[i]);
+    }
+};
+
+// Invisible enemies first, then furthest along
+struct TargetCamoPriority {
+    static constexpr TargetScan kScan = SCAN_ALL;
+    static inline float score(const EnemyStore* enemies, int i, float tx, float ty) {
+        (void)tx;
+        (void)ty;
+        float camo_bonus = (enemies->flags[i] & ENEMY_FLAG_INVISIBLE) ? 100000.0f : 0.0f;
+        return camo_bonus + enemies->progress[i];
+    }
+};
+
+// Policy per shooting tower type, chosen at build time like the panel
+// (-DTOWER_SNIPER_TARGETING=TargetStrongest). Recorded replays and the
+// bench figures assume the defaults.
+#ifndef TOWER_MACHINE_GUN_TARGETING
+#define TOWER_MACHINE_GUN_TARGETING TargetFirst
+#endif
+#ifndef TOWER_CANNON_TARGETING
+#define TOWER_CANNON_TARGETING      TargetFirst
+#endif
+#ifndef TOWER_SNIPER_TARGETING
+#define TOWER_SNIPER_TARGETING      TargetFirst
+#endif
+
+#endif // TARGETING_H
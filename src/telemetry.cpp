@@ -0,0 +1,464 @@
+// telemetry.cpp - Binary telemetry and live tuning over the USB serial port
+#include "telemetry.hh"
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include "pico/stdlib.h"
+
+#include "flash_io.hh"
+#include "cobs.hh"
+#include "snapshot.h"
+#include "frame_stream.hh"
+#include "matrix.hh"
+#include "buzzer_pwm.hh"
+#include "joystick.hh"
+
+#define ENEMY_TYPE_COUNT    (ENEMY_GHOST + 1)
+#define RESPONSE_BIT        0x80
+
+// ============================================================================
+// TUNABLE FIELDS
+// ============================================================================
+
+typedef struct {
+    uint8_t     table;          // TelemetryTable
+    uint8_t     type;           // TelemetryType
+    uint16_t    offset;         // Into the row's struct
+    float       min;
+    float       max;
+    const char* name;
+} TelemetryField;
+
+#define TOWER_FIELD(type, member, min, max) \
+    {TEL_TABLE_TOWER, type, offsetof(TowerStats, member), min, max, #member}
+#define ENEMY_FIELD(type, member, min, max) \
+    {TEL_TABLE_ENEMY, type, offsetof(EnemyStats, member), min, max, #member}
+
+// Limits keep the simulation sane: a shooting tower needs a cooldown of at
+// least a tick, and enemies must move for their wake-up times to be finite.
+// Enemy health stays within what a snapshot can hold, so an autosaved game
+// resumes with the health it had.
+static const TelemetryField FIELDS[] = {
+    TOWER_FIELD(TEL_TYPE_U8,    cost,              0.0f,   255.0f),
+    TOWER_FIELD(TEL_TYPE_U8,    damage,            0.0f,   255.0f),
+    TOWER_FIELD(TEL_TYPE_F32,   range,             1.0f,   64.0f),
+    TOWER_FIELD(TEL_TYPE_F32,   fire_rate,         SIM_DT, 60.0f),
+    TOWER_FIELD(TEL_TYPE_F32,   projectile_speed,  0.5f,   200.0f),
+    TOWER_FIELD(TEL_TYPE_U8,    color.r,           0.0f,   255.0f),
+    TOWER_FIELD(TEL_TYPE_U8,    color.g,           0.0f,   255.0f),
+    TOWER_FIELD(TEL_TYPE_U8,    color.b,           0.0f,   255.0f),
+    TOWER_FIELD(TEL_TYPE_BOOL,  can_see_invisible, 0.0f,   1.0f),
+    TOWER_FIELD(TEL_TYPE_U8,    splash_radius,     0.0f,   16.0f),
+
+    ENEMY_FIELD(TEL_TYPE_I32,   health,            1.0f,   (1 << SNAPSHOT_HEALTH_BITS) - 1),
+    ENEMY_FIELD(TEL_TYPE_F32,   speed,             0.1f,   60.0f),
+    ENEMY_FIELD(TEL_TYPE_U8,    color.r,           0.0f,   255.0f),
+    ENEMY_FIELD(TEL_TYPE_U8,    color.g,           0.0f,   255.0f),
+    ENEMY_FIELD(TEL_TYPE_U8,    color.b,           0.0f,   255.0f),
+    ENEMY_FIELD(TEL_TYPE_U8,    reward,            0.0f,   255.0f),
+    ENEMY_FIELD(TEL_TYPE_U8,    damage,            0.0f,   255.0f),
+    ENEMY_FIELD(TEL_TYPE_BOOL,  invisible,         0.0f,   1.0f),
+    ENEMY_FIELD(TEL_TYPE_BOOL,  splits_on_death,   0.0f,   1.0f),
+    ENEMY_FIELD(TEL_TYPE_U8,    split_count,       0.0f,   8.0f),
+    ENEMY_FIELD(TEL_TYPE_ENEMY, split_type,        0.0f,   ENEMY_TYPE_COUNT - 1),
+
+    {TEL_TABLE_WAVE, TEL_TYPE_ENEMY, offsetof(WaveSpawn, type), 0.0f, ENEMY_TYPE_COUNT - 1, "type"},
+    {TEL_TABLE_WAVE, TEL_TYPE_F32, offsetof(WaveSpawn, spawn_time), 0.0f, 600.0f, "spawn_time"},
+};
+
+#define FIELD_COUNT (sizeof(FIELDS) / sizeof(FIELDS[0]))
+
+static GameState*      game;
+static WaveManager*    wave_manager;
+static ReplayRecorder* replay;
+static KvStore*        settings;
+
+static TelemetryProfile profile;
+static uint32_t link_errors;
+static bool     tuned;
+
+// Request being received, still COBS-encoded
+static uint8_t  rx[TELEMETRY_MAX_PACKET + TELEMETRY_MAX_PACKET / 254 + 2];
+static uint32_t rx_size;
+static bool     rx_overflow;
+
+void telemetry_init(GameState* g, WaveManager* wm, ReplayRecorder* rec, KvStore* kv) {
+    game = g;
+    wave_manager = wm;
+    replay = rec;
+    settings = kv;
+}
+
+const TelemetryProfile* telemetry_profile() {
+    return &profile;
+}
+
+void telemetry_frame(uint32_t input_us, uint32_t sim_us, uint32_t draw_us,
+                     uint32_t oled_us, uint32_t refreshes,
+                     const RenderComposeStats* compose) {
+    static uint32_t second_start_ms;
+    static uint32_t second_refreshes;
+    static uint32_t second_composed;
+
+    profile.frames++;
+    profile.input_us = input_us;
+    profile.sim_us = sim_us;
+    profile.draw_us = draw_us;
+    profile.oled_us = oled_us;
+    profile.compose_us = compose->us;
+    profile.compose_damage = compose->damage;
+    profile.compose_full = compose->full_frames;
+    profile.compose_backdrops = compose->backdrops;
+    profile.frame_us = input_us + sim_us + draw_us + oled_us;
+    if (profile.frame_us > profile.frame_us_max) profile.frame_us_max = profile.frame_us;
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    if (now_ms - second_start_ms >= 1000) {
+        uint32_t elapsed_ms = now_ms - second_start_ms;
+        profile.refresh_hz = (refreshes - second_refreshes) * 1000 / elapsed_ms;
+        profile.compose_hz = (compose->frames - second_composed) * 1000 / elapsed_ms;
+        second_start_ms = now_ms;
+        second_refreshes = refreshes;
+        second_composed = compose->frames;
+    }
+}
+
+// ============================================================================
+// FIELD ACCESS
+// ============================================================================
+
+// The row's struct, or NULL if the row does not exist
+static uint8_t* field_row(const TelemetryField* field, uint16_t row) {
+    switch (field->table) {
+        case TEL_TABLE_TOWER:
+            return row < GAME_TOWER_TYPE_COUNT ? (uint8_t*)&TOWER_STATS_TABLE[row] : NULL;
+        case TEL_TABLE_ENEMY:
+            return row < ENEMY_TYPE_COUNT ? (uint8_t*)&ENEMY_STATS_TABLE[row] : NULL;
+        case TEL_TABLE_WAVE: {
+            const WaveDef* wave = wave_manager_get_wave((uint8_t)(row >> 8));
+            if (wave == NULL || (row & 0xFF) >= wave->spawn_count) return NULL;
+            return (uint8_t*)&wave->spawns[row & 0xFF];
+        }
+        default:
+            return NULL;
+    }
+}
+
+static uint32_t field_get(const TelemetryField* field, const uint8_t* row) {
+    const uint8_t* p = row + field->offset;
+    switch (field->type) {
+        case TEL_TYPE_U8:
+        case TEL_TYPE_BOOL:  return *p;
+        case TEL_TYPE_I32:   { int value; memcpy(&value, p, sizeof(value)); return (uint32_t)value; }
+        case TEL_TYPE_ENEMY: { EnemyType value; memcpy(&value, p, sizeof(value)); return (uint32_t)value; }
+        default:             { uint32_t bits; memcpy(&bits, p, sizeof(bits)); return bits; }
+    }
+}
+
+static void field_set(const TelemetryField* field, uint8_t* row, uint32_t value) {
+    uint8_t* p = row + field->offset;
+    switch (field->type) {
+        case TEL_TYPE_U8:    *p = (uint8_t)value; break;
+        case TEL_TYPE_BOOL:  *(bool*)p = value != 0; break;
+        case TEL_TYPE_I32:   { int v = (int)value; memcpy(p, &v, sizeof(v)); break; }
+        case TEL_TYPE_ENEMY: { EnemyType v = (EnemyType)value; memcpy(p, &v, sizeof(v)); break; }
+        default:             memcpy(p, &value, sizeof(value)); break;
+    }
+}
+
+static bool field_in_range(const TelemetryField* field, uint32_t value) {
+    float number;
+    if (field->type == TEL_TYPE_F32) {
+        memcpy(&number, &value, sizeof(number));
+        if (!isfinite(number)) return false;
+    } else {
+        number = (float)(int32_t)value;
+    }
+    return number >= field->min && number <= field->max;
+}
+
+// A splitter must not (eventually) split into itself
+static bool enemy_splits_terminate() {
+    for (int start = 0; start < ENEMY_TYPE_COUNT; start++) {
+        int type = start;
+        for (int depth = 0; ENEMY_STATS_TABLE[type].splits_on_death &&
+                            ENEMY_STATS_TABLE[type].split_count > 0; depth++) {
+            if (depth == ENEMY_TYPE_COUNT) return false;
+            type = ENEMY_STATS_TABLE[type].split_type;
+        }
+    }
+    return true;
+}
+
+// The table spawns a wave in order, so times must not decrease
+static bool wave_times_ordered(uint8_t wave_number) {
+    const WaveDef* wave = wave_manager_get_wave(wave_number);
+    for (int i = 1; i < wave->spawn_count; i++) {
+        if (wave->spawns[i].spawn_time < wave->spawns[i - 1].spawn_time) return false;
+    }
+    return true;
+}
+
+static TelemetryStatus field_write(const TelemetryField* field, uint16_t row_index,
+                                   uint32_t value, uint32_t* stored) {
+    uint8_t* row = field_row(field, row_index);
+    if (row == NULL) return TEL_ERR_ARGUMENT;
+    if (!field_in_range(field, value)) return TEL_ERR_RANGE;
+
+    uint32_t old = field_get(field, row);
+    field_set(field, row, value);
+
+    bool consistent = true;
+    if (field->table == TEL_TABLE_ENEMY) consistent = enemy_splits_terminate();
+    if (field->table == TEL_TABLE_WAVE) consistent = wave_times_ordered((uint8_t)(row_index >> 8));
+    if (!consistent) {
+        field_set(field, row, old);
+        return TEL_ERR_RANGE;
+    }
+
+    if (field->table == TEL_TABLE_TOWER) game_retune(game);
+    if (!tuned) {
+        printf("Live tuning: stats differ from the build, replays of this game will not match\n");
+        tuned = true;
+    }
+    *stored = field_get(field, row);
+    return TEL_OK;
+}
+
+// ============================================================================
+// SETTINGS
+// ============================================================================
+
+// Apply a setting that the game otherwise only reads at boot
+static void setting_apply(KvKey key, const uint8_t* value, uint8_t length) {
+    switch (key) {
+        case KV_KEY_VOLUME:
+            if (length == 1) buzzer_set_volume(value[0]);
+            break;
+        case KV_KEY_BRIGHTNESS:
+            if (length == 1) matrix_set_brightness(value[0]);
+            break;
+        case KV_KEY_FRAME_STREAM_HZ:
+            if (length == 1) frame_stream_set_rate(value[0]);
+            break;
+        case KV_KEY_JOYSTICK_CENTER:
+            if (length == 4) joystick_set_center(value[0] | (value[1] << 8), value[2] | (value[3] << 8));
+            break;
+        default:
+            break;
+    }
+}
+
+// ============================================================================
+// REQUESTS
+// ============================================================================
+
+static inline void put_u16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static inline void put_u32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(value >> (8 * i));
+}
+
+static inline uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t get_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t counter_value(int counter) {
+    const FrameStreamStats* stream = frame_stream_stats();
+    switch (counter) {
+        case TEL_COUNTER_UPTIME_MS:         return to_ms_since_boot(get_absolute_time());
+        case TEL_COUNTER_TICK:              return game->tick;
+        case TEL_COUNTER_WAVE:              return wave_manager->current_wave;
+        case TEL_COUNTER_LIVES:             return game->lives;
+        case TEL_COUNTER_MONEY:             return game->money;
+        case TEL_COUNTER_SCORE:             return game->score;
+        case TEL_COUNTER_ENEMIES:           return game->enemy_count;
+        case TEL_COUNTER_TOWERS:            return game->tower_count;
+        case TEL_COUNTER_PROJECTILES:       return game->projectile_count;
+        case TEL_COUNTER_FRAMES:            return profile.frames;
+        case TEL_COUNTER_FRAME_US:          return profile.frame_us;
+        case TEL_COUNTER_FRAME_US_MAX:      return profile.frame_us_max;
+        case TEL_COUNTER_INPUT_US:          return profile.input_us;
+        case TEL_COUNTER_SIM_US:            return profile.sim_us;
+        case TEL_COUNTER_DRAW_US:           return profile.draw_us;
+        case TEL_COUNTER_OLED_US:           return profile.oled_us;
+        case TEL_COUNTER_COMPOSE_US:        return profile.compose_us;
+        case TEL_COUNTER_REFRESH_HZ:        return profile.refresh_hz;
+        case TEL_COUNTER_COMPOSE_HZ:        return profile.compose_hz;
+        case TEL_COUNTER_COMPOSE_DAMAGE:    return profile.compose_damage;
+        case TEL_COUNTER_COMPOSE_FULL_FRAMES: return profile.compose_full;
+        case TEL_COUNTER_COMPOSE_BACKDROPS: return profile.compose_backdrops;
+        case TEL_COUNTER_STREAM_FRAMES:     return stream->frames;
+        case TEL_COUNTER_STREAM_BYTES:      return stream->bytes;
+        case TEL_COUNTER_STREAM_SKIPPED:    return stream->skipped;
+        case TEL_COUNTER_KV_COMMITS:        return settings->commits;
+        case TEL_COUNTER_KV_WORST_STALL_US: return settings->worst_stall_us;
+        case TEL_COUNTER_LINK_ERRORS:       return link_errors;
+        default:                            return 0;
+    }
+}
+
+// Run one request (arguments in `args`, `size` bytes), writing the result
+// to `out`. Returns the status; *out_size is the result length.
+static TelemetryStatus handle(uint8_t command, const uint8_t* args, uint32_t size,
+                              uint8_t* out, uint32_t* out_size, uint32_t out_capacity) {
+    *out_size = 0;
+
+    switch (command) {
+        case TEL_CMD_HELLO: {
+            uint8_t waves = wave_manager_get_total_waves();
+            if (5u + waves > out_capacity) return TEL_ERR_ARGUMENT;
+            out[0] = FIELD_COUNT;
+            out[1] = TEL_COUNTER_COUNT;
+            out[2] = GAME_TOWER_TYPE_COUNT;
+            out[3] = ENEMY_TYPE_COUNT;
+            out[4] = waves;
+            for (int w = 0; w < waves; w++) out[5 + w] = wave_manager_get_wave(w)->spawn_count;
+            *out_size = 5 + waves;
+            return TEL_OK;
+        }
+
+        case TEL_CMD_FIELD: {
+            if (size != 1 || args[0] >= FIELD_COUNT) return TEL_ERR_ARGUMENT;
+            const TelemetryField* field = &FIELDS[args[0]];
+            uint32_t name_length = (uint32_t)strlen(field->name);
+            if (10 + name_length > out_capacity) name_length = out_capacity - 10;
+
+            out[0] = field->table;
+            out[1] = field->type;
+            memcpy(&out[2], &field->min, 4);
+            memcpy(&out[6], &field->max, 4);
+            memcpy(&out[10], field->name, name_length);
+            *out_size = 10 + name_length;
+            return TEL_OK;
+        }
+
+        case TEL_CMD_READ: {
+            if (size != 3 || args[0] >= FIELD_COUNT) return TEL_ERR_ARGUMENT;
+            const TelemetryField* field = &FIELDS[args[0]];
+            const uint8_t* row = field_row(field, get_u16(&args[1]));
+            if (row == NULL) return TEL_ERR_ARGUMENT;
+            put_u32(out, field_get(field, row));
+            *out_size = 4;
+            return TEL_OK;
+        }
+
+        case TEL_CMD_WRITE: {
+            if (size != 7 || args[0] >= FIELD_COUNT) return TEL_ERR_ARGUMENT;
+            uint32_t stored;
+            TelemetryStatus status = field_write(&FIELDS[args[0]], get_u16(&args[1]),
+                                                 get_u32(&args[3]), &stored);
+            if (status != TEL_OK) return status;
+            put_u32(out, stored);
+            *out_size = 4;
+            return TEL_OK;
+        }
+
+        case TEL_CMD_COUNTERS: {
+            if (1u + 4 * TEL_COUNTER_COUNT > out_capacity) return TEL_ERR_ARGUMENT;
+            out[0] = TEL_COUNTER_COUNT;
+            for (int i = 0; i < TEL_COUNTER_COUNT; i++) put_u32(&out[1 + 4 * i], counter_value(i));
+            *out_size = 1 + 4 * TEL_COUNTER_COUNT;
+            return TEL_OK;
+        }
+
+        case TEL_CMD_START_WAVE: {
+            if (size != 2) return TEL_ERR_ARGUMENT;
+            uint16_t wave = get_u16(args);
+            if (!wave_manager->endless && wave >= wave_manager_get_total_waves()) {
+                return TEL_ERR_ARGUMENT;
+            }
+            wave_manager_start_wave(wave_manager, wave, game);
+            replay_record_wave_start(replay, game->tick, wave);
+            return TEL_OK;
+        }
+
+        case TEL_CMD_GET_SETTING: {
+            if (size != 1 || args[0] >= KV_KEY_COUNT) return TEL_ERR_ARGUMENT;
+            const KvEntry* entry = &settings->entries[args[0]];
+            if (!entry->present) return TEL_ERR_ARGUMENT;
+            memcpy(out, entry->value, entry->length);
+            *out_size = entry->length;
+            return TEL_OK;
+        }
+
+        case TEL_CMD_SET_SETTING: {
+            if (size < 2 || size - 1 > KV_MAX_VALUE || args[0] >= KV_KEY_COUNT) {
+                return TEL_ERR_ARGUMENT;
+            }
+            kv_set(settings, (KvKey)args[0], &args[1], (uint8_t)(size - 1));
+            setting_apply((KvKey)args[0], &args[1], (uint8_t)(size - 1));
+            return TEL_OK;
+        }
+
+        default:
+            return TEL_ERR_COMMAND;
+    }
+}
+
+// COBS-frame the packet and write it out raw, bypassing stdio's newline
+// translation
+static void send_packet(const uint8_t* packet, uint32_t size) {
+    uint8_t framed[COBS_FRAMED_SIZE(TELEMETRY_MAX_PACKET + 1 + 4 * TEL_COUNTER_COUNT)];
+    uint32_t framed_size = cobs_frame(framed, packet, size);
+    for (uint32_t i = 0; i < framed_size; i++) putchar_raw(framed[i]);
+}
+
+static void handle_packet(const uint8_t* encoded, uint32_t encoded_size) {
+    uint8_t request[TELEMETRY_MAX_PACKET];
+    uint32_t size = cobs_decode(encoded, encoded_size, request, sizeof(request));
+    if (size < 3 + 4 ||
+        flash_io_crc32(request, size - 4) != get_u32(&request[size - 4])) {
+        link_errors++;
+        return;
+    }
+    size -= 4;
+
+    uint8_t response[TELEMETRY_MAX_PACKET + 1 + 4 * TEL_COUNTER_COUNT];
+    response[0] = TELEMETRY_SCHEMA;
+    response[1] = request[1] | RESPONSE_BIT;
+    response[2] = request[2];
+
+    uint32_t result_size = 0;
+    if (request[0] != TELEMETRY_SCHEMA) {
+        response[3] = TEL_ERR_SCHEMA;
+    } else {
+        response[3] = handle(request[1], &request[3], size - 3, &response[4], &result_size,
+                             sizeof(response) - 4 - 4);
+    }
+
+    uint32_t response_size = 4 + result_size;
+    put_u32(&response[response_size], flash_io_crc32(response, response_size));
+    send_packet(response, response_size + 4);
+}
+
+void telemetry_poll() {
+    for (;;) {
+        int c = getchar_timeout_us(0);
+        if (c < 0) return;
+
+        if (c != 0) {
+            if (rx_size < sizeof(rx)) rx[rx_size++] = (uint8_t)c;
+            else rx_overflow = true;
+            continue;
+        }
+
+        // Delimiter: a packet ends here (or, between packets, nothing does)
+        if (rx_overflow) {
+            link_errors++;
+        } else if (rx_size > 0) {
+            handle_packet(rx, rx_size);
+        }
+        rx_size = 0;
+        rx_overflow = false;
+    }
+}
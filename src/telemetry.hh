@@ -0,0 +1,134 @@
+// telemetry.hh - Binary telemetry and live tuning over the USB serial port
+//
+// A small request/response protocol, driven by tools/td_tune.py. It reads
+// and writes the stat tables and wave spawns in RAM, reads live counters
+// (entities, frame time, refresh rate), starts waves and changes saved
+// settings. Nothing is formatted as text on the device.
+//
+// Packets are framed like the frame stream (frame_stream.hh): COBS between
+// 0x00 bytes, ending in a CRC-32/MPEG-2 (flash_io_crc32) of the rest.
+//   request:  schema u8, command u8, sequence u8, arguments
+//   response: schema u8, command | 0x80, sequence u8, status u8, result
+// Values are little-endian. Requests with a bad crc or framing are dropped
+// and counted (TEL_COUNTER_LINK_ERRORS); the host retries on timeout.
+//
+// Tunable values are addressed as (field, row). TEL_CMD_FIELD describes
+// each field (table, type, limits, name), so the host needs no copy of the
+// struct layouts. Rows are the TowerType or EnemyType, or wave << 8 | spawn
+// for wave spawns. Values travel as 32 bits: float bits for TEL_TYPE_F32,
+// an integer otherwise.
+//
+// Bump TELEMETRY_SCHEMA whenever a command, field or counter changes.
+#ifndef TELEMETRY_HH
+#define TELEMETRY_HH
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_types.h"
+#include "wave_system.h"
+#include "replay.h"
+#include "kv_store.hh"
+#include "render_snapshot.h"
+
+#define TELEMETRY_SCHEMA        4
+#define TELEMETRY_MAX_PACKET    64      // Largest decoded request, crc included
+
+typedef enum {
+    TEL_CMD_HELLO = 1,      // -> field count u8, counter count u8, tower rows u8,
+                            //    enemy rows u8, wave count u8, spawns per wave u8...
+    TEL_CMD_FIELD,          // field u8 -> table u8, type u8, min f32, max f32, name
+    TEL_CMD_READ,           // field u8, row u16 -> value u32
+    TEL_CMD_WRITE,          // field u8, row u16, value u32 -> value u32 as stored
+    TEL_CMD_COUNTERS,       // -> count u8, then count u32 (TelemetryCounter order)
+    TEL_CMD_START_WAVE,     // wave u16
+    TEL_CMD_GET_SETTING,    // key u8 -> value bytes
+    TEL_CMD_SET_SETTING     // key u8, value bytes; applied now, saved at the next commit
+} TelemetryCommand;
+
+typedef enum {
+    TEL_OK = 0,
+    TEL_ERR_SCHEMA,         // Request built for another schema
+    TEL_ERR_COMMAND,
+    TEL_ERR_ARGUMENT,       // Malformed, or no such field, row, wave or key
+    TEL_ERR_RANGE           // Value outside the field's limits or inconsistent
+} TelemetryStatus;
+
+typedef enum {
+    TEL_TABLE_TOWER = 0,
+    TEL_TABLE_ENEMY,
+    TEL_TABLE_WAVE
+} TelemetryTable;
+
+typedef enum {
+    TEL_TYPE_U8 = 0,
+    TEL_TYPE_I32,
+    TEL_TYPE_F32,
+    TEL_TYPE_BOOL,
+    TEL_TYPE_ENEMY          // EnemyType
+} TelemetryType;
+
+typedef enum {
+    TEL_COUNTER_UPTIME_MS = 0,
+    TEL_COUNTER_TICK,
+    TEL_COUNTER_WAVE,
+    TEL_COUNTER_LIVES,
+    TEL_COUNTER_MONEY,
+    TEL_COUNTER_SCORE,
+    TEL_COUNTER_ENEMIES,
+    TEL_COUNTER_TOWERS,
+    TEL_COUNTER_PROJECTILES,
+    TEL_COUNTER_FRAMES,
+    TEL_COUNTER_FRAME_US,
+    TEL_COUNTER_FRAME_US_MAX,
+    TEL_COUNTER_INPUT_US,
+    TEL_COUNTER_SIM_US,
+    TEL_COUNTER_DRAW_US,
+    TEL_COUNTER_OLED_US,
+    TEL_COUNTER_COMPOSE_US,
+    TEL_COUNTER_REFRESH_HZ,
+    TEL_COUNTER_COMPOSE_HZ,
+    TEL_COUNTER_COMPOSE_DAMAGE,
+    TEL_COUNTER_COMPOSE_FULL_FRAMES,
+    TEL_COUNTER_COMPOSE_BACKDROPS,
+    TEL_COUNTER_STREAM_FRAMES,
+    TEL_COUNTER_STREAM_BYTES,
+    TEL_COUNTER_STREAM_SKIPPED,
+    TEL_COUNTER_KV_COMMITS,
+    TEL_COUNTER_KV_WORST_STALL_US,
+    TEL_COUNTER_LINK_ERRORS,
+    TEL_COUNTER_COUNT
+} TelemetryCounter;
+
+// Main-loop timings, filled in by the caller each frame
+typedef struct {
+    uint32_t frames;            // Main-loop frames so far
+    uint32_t frame_us;          // Work in the last frame, idle time excluded
+    uint32_t frame_us_max;
+    uint32_t input_us;          // Phases of the last frame
+    uint32_t sim_us;
+    uint32_t draw_us;           // Core 0's part: render snapshot and stream capture
+    uint32_t oled_us;
+    uint32_t compose_us;        // Core 1 composing the last frame it finished
+    uint32_t refresh_hz;        // Core 1 panel refreshes over the last second
+    uint32_t compose_hz;        // Core 1 frames composed over the last second
+    uint32_t compose_damage;    // Pixels restored and redrawn for that frame
+    uint32_t compose_full;      // Frames composed whole so far
+    uint32_t compose_backdrops; // Background and scenery rebuilds so far
+} TelemetryProfile;
+
+// The state requests act on
+void telemetry_init(GameState* game, WaveManager* wm, ReplayRecorder* replay, KvStore* kv);
+
+// Handle every complete request received so far. Responses are written at
+// once, so call it where nothing else is mid-way through a packet.
+void telemetry_poll();
+
+// Record one main-loop frame's phase times. From core 1: its running count
+// of panel refreshes and its composer's stats.
+void telemetry_frame(uint32_t input_us, uint32_t sim_us, uint32_t draw_us,
+                     uint32_t oled_us, uint32_t refreshes,
+                     const RenderComposeStats* compose);
+
+const TelemetryProfile* telemetry_profile();
+
+#endif // TELEMETRY_HH
@@ -0,0 +1,99 @@
+// timer_queue.cpp - Indexed binary min-heap of per-entity wake-up ticks
+#include "game_types.h"
+
+static inline bool timer_before(const TimerQueue* q, uint16_t a, uint16_t b) {
+    return q->due[a] < q->due[b];
+}
+
+static inline void timer_place(TimerQueue* q, uint16_t pos, uint16_t id) {
+    q->heap[pos] = id;
+    q->pos[id] = pos;
+}
+
+static void timer_sift_up(TimerQueue* q, uint16_t pos) {
+    uint16_t id = q->heap[pos];
+    while (pos > 0) {
+        uint16_t parent = (pos - 1) / 2;
+        if (!timer_before(q, id, q->heap[parent])) break;
+        timer_place(q, pos, q->heap[parent]);
+        pos = parent;
+    }
+    timer_place(q, pos, id);
+}
+
+static void timer_sift_down(TimerQueue* q, uint16_t pos) {
+    uint16_t id = q->heap[pos];
+    for (;;) {
+        uint16_t child = 2 * pos + 1;
+        if (child >= q->count) break;
+        if (child + 1 < q->count && timer_before(q, q->heap[child + 1], q->heap[child])) {
+            child++;
+        }
+        if (!timer_before(q, q->heap[child], id)) break;
+        timer_place(q, pos, q->heap[child]);
+        pos = child;
+    }
+    timer_place(q, pos, id);
+}
+
+void timer_queue_init(TimerQueue* q) {
+    q->count = 0;
+    for (int id = 0; id < MAX_TIMERS; id++) {
+        q->pos[id] = TIMER_UNARMED;
+    }
+}
+
+void timer_arm(TimerQueue* q, uint16_t id, uint32_t tick) {
+    if (q->pos[id] == TIMER_UNARMED) {
+        q->due[id] = tick;
+        uint16_t pos = q->count++;
+        timer_place(q, pos, id);
+        timer_sift_up(q, pos);
+        return;
+    }
+
+    // Already queued: move it to its new place
+    uint32_t old_tick = q->due[id];
+    q->due[id] = tick;
+    if (tick < old_tick) {
+        timer_sift_up(q, q->pos[id]);
+    } else if (tick > old_tick) {
+        timer_sift_down(q, q->pos[id]);
+    }
+}
+
+void timer_cancel(TimerQueue* q, uint16_t id) {
+    uint16_t pos = q->pos[id];
+    if (pos == TIMER_UNARMED) return;
+
+    q->pos[id] = TIMER_UNARMED;
+    q->count--;
+    if (pos == q->count) return;
+
+    // Fill the hole with the last entry and restore the heap around it
+    uint16_t last = q->heap[q->count];
+    timer_place(q, pos, last);
+    if (pos > 0 && timer_before(q, last, q->heap[(pos - 1) / 2])) {
+        timer_sift_up(q, pos);
+    } else {
+        timer_sift_down(q, pos);
+    }
+}
+
+bool timer_is_armed(const TimerQueue* q, uint16_t id) {
+    return q->pos[id] != TIMER_UNARMED;
+}
+
+uint32_t timer_next_due(const TimerQueue* q) {
+    return (q->count > 0) ? q->due[q->heap[0]] : TIMER_NEVER;
+}
+
+int timer_pop_due(TimerQueue* q, uint32_t now) {
+    if (q->count == 0) return -1;
+
+    uint16_t id = q->heap[0];
+    if (q->due[id] > now) return -1;
+
+    timer_cancel(q, id);
+    return id;
+}
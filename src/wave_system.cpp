@@ -6,7 +6,7 @@
 // ============================================================================
 
 // Wave 1: "Scout Swarm" - Easy introduction
-static const WaveSpawn wave1_spawns[] = {
+static WaveSpawn wave1_spawns[] = {
     {ENEMY_SCOUT, 0.0f},
     {ENEMY_SCOUT, 1.0f},
     {ENEMY_SCOUT, 2.0f},
@@ -16,7 +16,7 @@ static const WaveSpawn wave1_spawns[] = {
 };
 
 // Wave 2: "Mixed Assault" - Scouts and tanks
-static const WaveSpawn wave2_spawns[] = {
+static WaveSpawn wave2_spawns[] = {
     {ENEMY_SCOUT, 0.0f},
     {ENEMY_SCOUT, 0.5f},
     {ENEMY_TANK, 1.5f},
@@ -30,7 +30,7 @@ static const WaveSpawn wave2_spawns[] = {
 };
 
 // Wave 3: "Special Forces" - All enemy types
-static const WaveSpawn wave3_spawns[] = {
+static WaveSpawn wave3_spawns[] = {
     {ENEMY_SCOUT, 0.0f},
     {ENEMY_GHOST, 1.0f},
     {ENEMY_SCOUT, 2.0f},
@@ -56,72 +56,167 @@ static const WaveDef WAVE_TABLE[] = {
 
 #define TOTAL_WAVES (sizeof(WAVE_TABLE) / sizeof(WaveDef))
 
+// ============================================================================
+// ENDLESS MODE (procedural waves)
+// ============================================================================
+
+// Wave size and pacing are closed-form in the wave number. Each spawn's type
+// and the gap to the next one are drawn from a xorshift stream seeded from
+// (seed, wave) when the spawn comes due, so no spawn table is ever built.
+#define ENDLESS_BASE_COUNT      12    // Enemies in wave 0
+#define ENDLESS_COUNT_GROWTH    8     // Extra enemies per wave
+#define ENDLESS_MAX_COUNT       4000
+#define ENDLESS_START_GAP       45    // Mean ticks between spawns in wave 0
+#define ENDLESS_GAP_SHRINK      2     // Mean gap shrinks by this per wave
+#define ENDLESS_MIN_GAP         2
+
+static uint32_t endless_next(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint32_t endless_wave_seed(uint32_t seed, uint16_t wave) {
+    uint32_t h = seed ^ ((uint32_t)wave * 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h ? h : 1;  // xorshift state must be non-zero
+}
+
+static uint16_t endless_spawn_count(uint16_t wave) {
+    uint32_t count = ENDLESS_BASE_COUNT + (uint32_t)wave * ENDLESS_COUNT_GROWTH;
+    return (uint16_t)(count < ENDLESS_MAX_COUNT ? count : ENDLESS_MAX_COUNT);
+}
+
+// Tougher types join the mix as waves go on and their share keeps growing
+static EnemyType endless_pick_type(uint32_t r, uint16_t wave) {
+    uint32_t scout = 8;
+    uint32_t tank = wave < 8 ? wave : 8;
+    uint32_t splitter = wave < 3 ? 0 : (wave - 2 < 6 ? wave - 2 : 6);
+    uint32_t ghost = wave < 5 ? 0 : (wave - 4 < 6 ? wave - 4 : 6);
+
+    uint32_t pick = r % (scout + tank + splitter + ghost);
+    if (pick < scout) return ENEMY_SCOUT;
+    pick -= scout;
+    if (pick < tank) return ENEMY_TANK;
+    pick -= tank;
+    if (pick < splitter) return ENEMY_SPLITTER;
+    return ENEMY_GHOST;
+}
+
+// Jittered around a mean that tightens every wave, with occasional bursts
+// of back-to-back spawns that become more common later on
+static uint32_t endless_gap(uint32_t r, uint16_t wave) {
+    int mean = ENDLESS_START_GAP - wave * ENDLESS_GAP_SHRINK;
+    if (mean < ENDLESS_MIN_GAP) mean = ENDLESS_MIN_GAP;
+
+    uint32_t burst_odds = 4 + (wave < 28 ? wave : 28);  // out of 64
+    if ((r & 63) < burst_odds) return 1;
+
+    uint32_t jitter = (r >> 8) % (uint32_t)mean;  // mean/2 .. 3*mean/2
+    return (uint32_t)(mean / 2) + jitter + 1;
+}
+
 // ============================================================================
 // WAVE MANAGER IMPLEMENTATION
 // ============================================================================
 
 void wave_manager_init(WaveManager* wm) {
-    wm->wave_timer = 0.0f;
+    wm->wave_start_tick = 0;
+    wm->next_spawn_tick = 0;
     wm->current_wave = 0;
     wm->spawns_completed = 0;
     wm->wave_active = false;
     wm->wave_complete = false;
-    wm->wave_complete_timer = 0.0f;
+    wm->wave_complete_tick = 0;
+    wm->spawn_count = 0;
+    wm->endless = false;
+    wm->seed = 0;
+    wm->rng = 1;
 }
 
-void wave_manager_start_wave(WaveManager* wm, uint8_t wave_number, GameState* game) {
-    if (wave_number >= TOTAL_WAVES) {
-        printf("ERROR: Invalid wave number %d (max %d)\n", wave_number, TOTAL_WAVES - 1);
-        return;
-    }
-    
+void wave_manager_set_endless(WaveManager* wm, uint32_t seed) {
+    wm->endless = true;
+    wm->seed = seed;
+}
+
+void wave_manager_start_wave(WaveManager* wm, uint16_t wave_number, GameState* game) {
+    const char* name = "Endless";
+
     wm->current_wave = wave_number;
-    wm->wave_timer = 0.0f;
+    wm->wave_start_tick = game->tick;
+    wm->next_spawn_tick = game->tick;
+
+    if (wm->endless) {
+        wm->rng = endless_wave_seed(wm->seed, wave_number);
+        wm->spawn_count = endless_spawn_count(wave_number);
+    } else {
+        if (wave_number >= TOTAL_WAVES) {
+            printf("ERROR: Invalid wave number %d (max %d)\n", wave_number, (int)TOTAL_WAVES - 1);
+            return;
+        }
+
+        const WaveDef* wave = &WAVE_TABLE[wave_number];
+        name = wave->name;
+        wm->spawn_count = wave->spawn_count;
+        if (wave->spawn_count > 0) {
+            wm->next_spawn_tick += seconds_to_ticks(wave->spawns[0].spawn_time);
+        }
+    }
+
     wm->spawns_completed = 0;
     wm->wave_active = true;
     wm->wave_complete = false;
-    wm->wave_complete_timer = 0.0f;
+    wm->wave_complete_tick = 0;
     
-    const WaveDef* wave = &WAVE_TABLE[wave_number];
-    printf("\n=== WAVE %d: %s ===\n", wave_number + 1, wave->name);
-    printf("Enemies: %d\n", wave->spawn_count);
-    printf("=====================\n\n");
+    GAME_LOG("\n=== WAVE %d: %s ===\n", wave_number + 1, name);
+    GAME_LOG("Enemies: %d\n", wm->spawn_count);
+    GAME_LOG("=====================\n\n");
 }
 
-void wave_manager_update(WaveManager* wm, float dt, GameState* game) {
-    if (!wm->wave_active) return;
-    
-    // Update wave timer
-    wm->wave_timer += dt;
+void wave_manager_update(WaveManager* wm, GameState* game) {
+    if (!wm->wave_active || wm->wave_complete) return;
+    if (game->tick < wm->next_spawn_tick) return;
     
-    const WaveDef* wave = &WAVE_TABLE[wm->current_wave];
+    float wave_seconds = (game->tick - wm->wave_start_tick) * SIM_DT;
     
-    // Check if we should spawn any enemies
-    while (wm->spawns_completed < wave->spawn_count) {
-        const WaveSpawn* spawn = &wave->spawns[wm->spawns_completed];
-        
-        // Check if it's time to spawn this enemy
-        if (wm->wave_timer >= spawn->spawn_time) {
-            game_spawn_enemy(game, spawn->type);
-            wm->spawns_completed++;
-            printf("Spawned enemy %d/%d (type %d) at %.1fs\n", 
-                   wm->spawns_completed, wave->spawn_count, spawn->type, wm->wave_timer);
+    // Spawn everything that has come due, noting when the next one is
+    while (wm->spawns_completed < wm->spawn_count && game->tick >= wm->next_spawn_tick) {
+        EnemyType type;
+
+        if (wm->endless) {
+            type = endless_pick_type(endless_next(&wm->rng), wm->current_wave);
+            wm->next_spawn_tick += endless_gap(endless_next(&wm->rng), wm->current_wave);
         } else {
-            // Not time yet, break out of loop
-            break;
+            const WaveDef* wave = &WAVE_TABLE[wm->current_wave];
+            type = wave->spawns[wm->spawns_completed].type;
+            if (wm->spawns_completed + 1 < wave->spawn_count) {
+                const WaveSpawn* next = &wave->spawns[wm->spawns_completed + 1];
+                wm->next_spawn_tick = wm->wave_start_tick + seconds_to_ticks(next->spawn_time);
+            }
+        }
+
+        game_spawn_enemy(game, type);
+        wm->spawns_completed++;
+
+        // Endless waves spawn far too often to log each one
+        if (!wm->endless) {
+            GAME_LOG("Spawned enemy %d/%d (type %d) at %.1fs\n", 
+                     wm->spawns_completed, wm->spawn_count, type, wave_seconds);
         }
     }
     
     // Check if all enemies have been spawned
-    if (wm->spawns_completed >= wave->spawn_count && !wm->wave_complete) {
+    if (wm->spawns_completed >= wm->spawn_count) {
         wm->wave_complete = true;
-        wm->wave_complete_timer = 0.0f;
-        printf("All enemies spawned for wave %d!\n", wm->current_wave + 1);
-    }
-    
-    // Update completion timer
-    if (wm->wave_complete) {
-        wm->wave_complete_timer += dt;
+        wm->wave_complete_tick = game->tick;
+        GAME_LOG("All enemies spawned for wave %d!\n", wm->current_wave + 1);
     }
 }
 
@@ -133,7 +228,7 @@ bool wave_manager_is_complete(const WaveManager* wm, const GameState* game) {
     
     if (!wm->wave_complete) return false;
     if (game->enemy_count > 0) return false;
-    if (wm->wave_complete_timer < 0.5f) return false;
+    if (game->tick - wm->wave_complete_tick < SIM_TICK_HZ / 2) return false;
     
     return true;
 }
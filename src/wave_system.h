@@ -11,34 +11,46 @@ typedef struct {
 
 // Wave definition
 typedef struct {
-    const WaveSpawn* spawns;
+    WaveSpawn* spawns;          // Writable, for live tuning (telemetry.hh)
     uint8_t spawn_count;
     const char* name;
 } WaveDef;
 
-// Wave manager state
+// Wave manager state (times are GameState::tick values)
 typedef struct {
-    float wave_timer;           // Time since wave started
-    uint8_t current_wave;       // Current wave number (0-based)
-    uint8_t spawns_completed;   // How many enemies spawned so far
+    uint32_t wave_start_tick;   // Tick the wave started on
+    uint32_t next_spawn_tick;   // Tick the next spawn is due on
+    uint16_t current_wave;      // Current wave number (0-based)
+    uint16_t spawn_count;       // Enemies this wave spawns in total
+    uint16_t spawns_completed;  // How many enemies spawned so far
     bool wave_active;           // Is a wave currently running?
     bool wave_complete;         // Did we finish all spawns?
-    float wave_complete_timer;  // Time since last enemy spawned
+    uint32_t wave_complete_tick;  // Tick the last enemy spawned on
+
+    // Endless mode: waves are generated spawn by spawn from (seed, wave)
+    bool endless;
+    uint32_t seed;
+    uint32_t rng;               // Generator state for the current wave
 } WaveManager;
 
 // Initialize wave manager
 void wave_manager_init(WaveManager* wm);
 
+// Switch to procedurally generated waves. Any wave number is valid from
+// then on; the same seed and wave number always give the same wave.
+void wave_manager_set_endless(WaveManager* wm, uint32_t seed);
+
 // Start a wave
-void wave_manager_start_wave(WaveManager* wm, uint8_t wave_number, GameState* game);
+void wave_manager_start_wave(WaveManager* wm, uint16_t wave_number, GameState* game);
 
-// Update wave manager (spawns enemies at appropriate times)
-void wave_manager_update(WaveManager* wm, float dt, GameState* game);
+// Update wave manager (spawns enemies at appropriate times). Costs one
+// comparison unless a spawn is due.
+void wave_manager_update(WaveManager* wm, GameState* game);
 
 // Check if wave is complete (all enemies spawned AND defeated)
 bool wave_manager_is_complete(const WaveManager* wm, const GameState* game);
 
-// Get total number of waves
+// Get total number of hand-written waves
 uint8_t wave_manager_get_total_waves();
 
 // Get wave definition
@@ -0,0 +1,443 @@
+"""
+Map compiler for the RP2350 firmware
+
+Turns the JSON maps in gam4/maps/ (the same format the Python prototype
+loads) into packed binary blobs and writes them as const arrays to
+src/map_blobs.cpp, so they are linked into flash.
+
+Each blob holds the path, its arc-length table, tower slots, decorations
+and the rendered background. The layout must match MapBlobHeader in
+src/map_blob.h.
+
+Only maps that fit the build's panel are compiled; the first of those (by
+file name) is the default. PlatformIO builds pass the panel from the
+build flags, see tools/pio_map_compiler.py.
+
+Backgrounds are stored as per-row runs rather than pixels: a run is either
+one solid colour or a base colour plus hashed per-pixel noise (the grass and
+path textures), which map_background_decode_row() regenerates bit-exactly.
+
+Usage:
+    python tools/map_compiler.py [--maps DIR] [--out FILE] [--panel WxH]
+"""
+
+import argparse
+import glob
+import math
+import os
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, os.path.join(ROOT, "gam4"))
+
+from map_data import MapLoader  # noqa: E402
+
+MAP_BLOB_MAGIC = 0x504D4454  # "TDMP"
+MAP_BLOB_VERSION = 2
+MAP_NAME_LENGTH = 16
+
+# Panel presets, must match MATRIX_PANEL_* in lib/led_matrix/panel.hh
+PANEL_PRESETS = {
+    "MATRIX_PANEL_64X32": (64, 32),
+    "MATRIX_PANEL_64X64": (64, 64),
+    "MATRIX_PANEL_128X32": (128, 32),
+    "MATRIX_PANEL_32X16": (32, 16),
+}
+PANEL_PRESET_NUMBERS = ["MATRIX_PANEL_64X32", "MATRIX_PANEL_64X64",
+                        "MATRIX_PANEL_128X32", "MATRIX_PANEL_32X16"]
+DEFAULT_PANEL = PANEL_PRESETS["MATRIX_PANEL_64X32"]
+
+# Firmware capacity limits (src/game_types.h)
+MAX_PATH_WAYPOINTS = 20
+MAX_TOWERS = 10
+
+# Must match MapDecorationType in src/map_blob.h
+DECORATION_TYPES = {"tree": 0, "rock": 1, "lake": 2}
+
+# Background run kinds, must match MAP_RUN_* in src/map_blob.h
+RUN_SOLID = 0
+RUN_NOISE_RGB = 1
+RUN_NOISE_GRAY = 2
+RUN_KIND_SHIFT = 6
+MAX_RUN = 1 << RUN_KIND_SHIFT
+
+# Colors (darker than the prototype's to account for gamma correction)
+PATH_COLOR = (45, 45, 45)
+TREE_GREEN = (0, 80, 0)
+TREE_BROWN = (100, 50, 0)
+ROCK_COLOR = (30, 30, 30)
+LAKE_COLOR = (0, 0, 80)
+
+# Random noise variation amounts
+BG_VARIATION = 8
+PATH_VARIATION = 3
+
+HEADER_FORMAT = "<IHBB16sBBBBIIIIII"
+
+
+def f32(value):
+    """Round a Python float to single precision, as the firmware stores it"""
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def align4(data):
+    """Pad a bytearray to a 4-byte boundary"""
+    while len(data) % 4:
+        data.append(0)
+
+
+def path_geometry(path):
+    """
+    Arc-length table in single precision, step for step the same as
+    path_geometry_build() in src/path_geometry.cpp
+
+    Returns:
+        (cumulative, dir_x, dir_y) lists
+    """
+    cumulative = []
+    dir_x = []
+    dir_y = []
+    total = 0.0
+
+    for (x0, y0), (x1, y1) in zip(path, path[1:]):
+        dx = f32(x1 - x0)
+        dy = f32(y1 - y0)
+        length = f32(math.sqrt(f32(f32(dx * dx) + f32(dy * dy))))
+
+        cumulative.append(total)
+        if length > 0.0:
+            dir_x.append(f32(dx / length))
+            dir_y.append(f32(dy / length))
+        else:
+            dir_x.append(0.0)
+            dir_y.append(0.0)
+        total = f32(total + length)
+
+    cumulative.append(total)
+    return cumulative, dir_x, dir_y
+
+
+def line_points(x0, y0, x1, y1):
+    """Bresenham line from (x0, y0) to (x1, y1), endpoints included"""
+    points = []
+    dx = abs(x1 - x0)
+    dy = abs(y1 - y0)
+    sx = 1 if x0 < x1 else -1
+    sy = 1 if y0 < y1 else -1
+    err = dx - dy
+
+    while True:
+        points.append((x0, y0))
+        if x0 == x1 and y0 == y1:
+            break
+        e2 = 2 * err
+        if e2 > -dy:
+            err -= dy
+            x0 += sx
+        if e2 < dx:
+            err += dx
+            y0 += sy
+
+    return points
+
+
+class Background:
+    """
+    Canvas the map is rendered into. Each pixel is a (run kind, base colour,
+    variation) descriptor, so runs can be read straight off it.
+    """
+
+    def __init__(self, width, height):
+        self.width = width
+        self.height = height
+        self.pixels = [[(RUN_SOLID, (0, 0, 0), 0)] * width for _ in range(height)]
+
+    def set(self, x, y, color):
+        if 0 <= x < self.width and 0 <= y < self.height:
+            self.pixels[y][x] = (RUN_SOLID, color, 0)
+
+
+def path_mask(map_data):
+    """Pixels covered by the 3-pixel-wide path"""
+    mask = set()
+    for (x0, y0), (x1, y1) in zip(map_data.path, map_data.path[1:]):
+        horizontal = (y0 == y1)
+        for cx, cy in line_points(x0, y0, x1, y1):
+            mask.add((cx, cy))
+            if horizontal:
+                mask.add((cx, cy - 1))
+                mask.add((cx, cy + 1))
+            else:
+                mask.add((cx - 1, cy))
+                mask.add((cx + 1, cy))
+    return mask
+
+
+def draw_tree(bg, x, y):
+    for dy in range(3):
+        for dx in range(3):
+            bg.set(x + dx - 1, y + dy - 1, TREE_GREEN)
+    bg.set(x, y + 2, TREE_BROWN)
+    for dx in range(-1, 2):
+        bg.set(x + dx, y + 3, TREE_BROWN)
+
+
+def draw_rock(bg, x, y):
+    for dy in range(2):
+        for dx in range(2):
+            bg.set(x + dx, y + dy, ROCK_COLOR)
+    bg.set(x + 2, y + 1, ROCK_COLOR)
+
+
+def draw_lake(bg, x, y):
+    for dx in range(3):
+        bg.set(x + dx, y - 2, LAKE_COLOR)
+    for dx in range(-1, 5):
+        bg.set(x + dx, y - 1, LAKE_COLOR)
+        bg.set(x + dx, y, LAKE_COLOR)
+    for dx in range(3):
+        bg.set(x + dx + 1, y + 1, LAKE_COLOR)
+
+
+DECORATION_DRAW = {"tree": draw_tree, "rock": draw_rock, "lake": draw_lake}
+
+
+def render_background(map_data):
+    """Grass noise, then the textured path, then decorations on top"""
+    bg = Background(map_data.width, map_data.height)
+    grass = (RUN_NOISE_RGB, tuple(map_data.background_color), BG_VARIATION)
+    base_gray = sum(PATH_COLOR) // 3
+    path = (RUN_NOISE_GRAY, (base_gray, base_gray, base_gray), PATH_VARIATION)
+
+    mask = path_mask(map_data)
+    for y in range(bg.height):
+        for x in range(bg.width):
+            bg.pixels[y][x] = path if (x, y) in mask else grass
+
+    for decoration in map_data.decorations:
+        DECORATION_DRAW[decoration["type"]](bg, decoration["x"], decoration["y"])
+
+    return bg
+
+
+def encode_background(bg):
+    """
+    Row table (uint16 offset per row from the start of the section) followed
+    by each row's runs. A run is one byte, kind << 6 | (length - 1), then:
+        RUN_SOLID       r, g, b
+        RUN_NOISE_RGB   r, g, b, variation
+        RUN_NOISE_GRAY  gray, variation
+    Runs never cross rows, so any row decodes on its own.
+    """
+    table_size = 2 * bg.height
+    offsets = []
+    runs = bytearray()
+
+    for y in range(bg.height):
+        offsets.append(table_size + len(runs))
+        x = 0
+        while x < bg.width:
+            pixel = bg.pixels[y][x]
+            length = 1
+            while x + length < bg.width and length < MAX_RUN and bg.pixels[y][x + length] == pixel:
+                length += 1
+
+            kind, (r, g, b), variation = pixel
+            runs.append((kind << RUN_KIND_SHIFT) | (length - 1))
+            if kind == RUN_SOLID:
+                runs += bytes((r, g, b))
+            elif kind == RUN_NOISE_RGB:
+                runs += bytes((r, g, b, variation))
+            else:
+                runs += bytes((r, variation))
+            x += length
+
+    if table_size + len(runs) > 0xFFFF:
+        raise ValueError("background too complex for 16-bit row offsets")
+
+    return struct.pack(f"<{bg.height}H", *offsets) + bytes(runs)
+
+
+def panel_size(defines):
+    """
+    Panel (width, height) of a build, from its preprocessor defines as
+    lib/led_matrix/panel.hh resolves them
+
+    Args:
+        defines: {name: value or None}
+    """
+    if defines.get("MATRIX_COLS") is not None and defines.get("MATRIX_ROWS") is not None:
+        return int(defines["MATRIX_COLS"], 0), int(defines["MATRIX_ROWS"], 0)
+
+    preset = defines.get("MATRIX_PANEL")
+    if preset is None:
+        return DEFAULT_PANEL
+    preset = str(preset)
+    if preset.isdigit():
+        preset = PANEL_PRESET_NUMBERS[int(preset)]
+    if preset not in PANEL_PRESETS:
+        raise ValueError(f"unknown MATRIX_PANEL {preset}")
+    return PANEL_PRESETS[preset]
+
+
+def fits_panel(map_data, panel):
+    width, height = panel
+    return map_data.width <= width and map_data.height <= height
+
+
+def validate(map_data, filename):
+    """Reject maps the firmware cannot hold"""
+    errors = []
+    if not 2 <= len(map_data.path) <= MAX_PATH_WAYPOINTS:
+        errors.append(f"{len(map_data.path)} path points (2..{MAX_PATH_WAYPOINTS})")
+    if len(map_data.tower_slots) > MAX_TOWERS:
+        errors.append(f"{len(map_data.tower_slots)} tower slots (max {MAX_TOWERS})")
+    for decoration in map_data.decorations:
+        if decoration.get("type") not in DECORATION_TYPES:
+            errors.append(f"unknown decoration type {decoration.get('type')!r}")
+
+    if errors:
+        raise ValueError(f"{filename}: " + "; ".join(errors))
+
+
+def compile_map(map_data):
+    """
+    Pack one map into a blob
+
+    Returns:
+        (blob, compressed background size) where blob is laid out as
+        MapBlobHeader followed by its sections
+    """
+    header_size = struct.calcsize(HEADER_FORMAT)
+    body = bytearray()
+
+    def section(data):
+        align4(body)
+        offset = header_size + len(body)
+        body.extend(data)
+        return offset
+
+    path_offset = section(b"".join(struct.pack("<hh", x, y) for x, y in map_data.path))
+
+    cumulative, dir_x, dir_y = path_geometry(map_data.path)
+    geometry = struct.pack(f"<{len(cumulative)}f", *cumulative)
+    geometry += struct.pack(f"<{len(dir_x)}f", *dir_x)
+    geometry += struct.pack(f"<{len(dir_y)}f", *dir_y)
+    geometry_offset = section(geometry)
+
+    slot_offset = section(b"".join(struct.pack("<hh", x, y) for x, y in map_data.tower_slots))
+
+    decoration_offset = section(b"".join(
+        struct.pack("<BBhh", DECORATION_TYPES[d["type"]], 0, d["x"], d["y"])
+        for d in map_data.decorations))
+
+    background = encode_background(render_background(map_data))
+    background_offset = section(background)
+    align4(body)
+
+    name = map_data.name.encode("ascii", "replace")[:MAP_NAME_LENGTH - 1]
+    header = struct.pack(HEADER_FORMAT,
+                         MAP_BLOB_MAGIC,
+                         MAP_BLOB_VERSION,
+                         map_data.width,
+                         map_data.height,
+                         name,
+                         len(map_data.path),
+                         len(map_data.tower_slots),
+                         len(map_data.decorations),
+                         0,
+                         path_offset,
+                         geometry_offset,
+                         slot_offset,
+                         decoration_offset,
+                         background_offset,
+                         header_size + len(body))
+    return header + bytes(body), len(background)
+
+
+def symbol_for(filename):
+    stem = os.path.splitext(os.path.basename(filename))[0]
+    return "MAP_BLOB_" + "".join(c if c.isalnum() else "_" for c in stem).upper()
+
+
+def emit_source(maps):
+    """C++ source defining every blob plus the MAP_BLOBS index table"""
+    lines = [
+        "// map_blobs.cpp - GENERATED by tools/map_compiler.py from gam4/maps/*.json",
+        "// Do not edit; change the JSON and rebuild.",
+        '#include "map_blob.h"',
+        "",
+    ]
+
+    for filename, map_data, blob, background_size in maps:
+        raw_size = map_data.width * map_data.height * 3
+        lines.append(f"// {map_data.name} ({os.path.basename(filename)}), {len(blob)} bytes; "
+                     f"background {raw_size} -> {background_size} bytes "
+                     f"({raw_size / background_size:.1f}:1)")
+        lines.append(f"alignas(4) static const uint8_t {symbol_for(filename)}[{len(blob)}] = {{")
+        for i in range(0, len(blob), 16):
+            chunk = ", ".join(f"0x{b:02x}" for b in blob[i:i + 16])
+            lines.append(f"    {chunk},")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("const uint8_t* const MAP_BLOBS[] = {")
+    for filename, _, _, _ in maps:
+        lines.append(f"    {symbol_for(filename)},")
+    lines.append("};")
+    lines.append("")
+    lines.append(f"const uint8_t MAP_COUNT = {len(maps)};")
+    lines.append("")
+    return "\n".join(lines)
+
+
+def compile_maps(maps_dir, out_path, panel=DEFAULT_PANEL):
+    """
+    Compile every map in maps_dir that fits the panel, sorted by file name
+    (index 0 is the default map), and rewrite out_path only if the output
+    changed
+
+    Returns:
+        True if out_path was written
+    """
+    maps = []
+    for filename in sorted(glob.glob(os.path.join(maps_dir, "*.json"))):
+        map_data = MapLoader.load_json(filename)
+        validate(map_data, filename)
+        if not fits_panel(map_data, panel):
+            print(f"Skipping {os.path.basename(filename)}: "
+                  f"{map_data.width}x{map_data.height} is larger than the "
+                  f"{panel[0]}x{panel[1]} panel")
+            continue
+        maps.append((filename, map_data) + compile_map(map_data))
+
+    if not maps:
+        raise ValueError(f"no map in {maps_dir} fits the {panel[0]}x{panel[1]} panel")
+
+    source = emit_source(maps)
+    if os.path.exists(out_path):
+        with open(out_path) as f:
+            if f.read() == source:
+                return False
+
+    with open(out_path, "w") as f:
+        f.write(source)
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile JSON maps into flash blobs")
+    parser.add_argument("--maps", default=os.path.join(ROOT, "gam4", "maps"))
+    parser.add_argument("--out", default=os.path.join(ROOT, "src", "map_blobs.cpp"))
+    parser.add_argument("--panel", default="%dx%d" % DEFAULT_PANEL,
+                        help="panel size as WxH (default %(default)s)")
+    args = parser.parse_args()
+
+    width, height = (int(n) for n in args.panel.lower().split("x"))
+    if compile_maps(args.maps, args.out, (width, height)):
+        print(f"Wrote {args.out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,32 @@
+"""
+PlatformIO pre-build hook: regenerate src/map_blobs.cpp from gam4/maps/*.json
+
+Only maps that fit the panel chosen in the build flags (MATRIX_PANEL, or
+MATRIX_COLS and MATRIX_ROWS) are compiled in.
+"""
+
+import os
+import sys
+
+Import("env")  # noqa: F821 (provided by PlatformIO/SCons)
+
+sys.path.insert(0, os.path.join(env["PROJECT_DIR"], "tools"))  # noqa: F821
+
+from map_compiler import compile_maps, panel_size  # noqa: E402
+
+
+def build_defines():
+    """The build's -D flags as {name: value or None}"""
+    defines = {}
+    for define in env.ParseFlags(env.get("BUILD_FLAGS", []))["CPPDEFINES"]:  # noqa: F821
+        if isinstance(define, (list, tuple)):
+            defines[define[0]] = str(define[1]) if len(define) > 1 else None
+        else:
+            defines[define] = None
+    return defines
+
+
+if compile_maps(os.path.join(env["PROJECT_DIR"], "gam4", "maps"),  # noqa: F821
+                os.path.join(env["PROJECT_SRC_DIR"], "map_blobs.cpp"),  # noqa: F821
+                panel_size(build_defines())):
+    print("Map blobs regenerated")
@@ -0,0 +1,13 @@
+"""
+PlatformIO hook for [env:pylib]: link the host game core as a shared library
+(.pio/build/pylib/libtd.so) for gam4/td_engine.py instead of a program
+"""
+
+import sys
+
+Import("env")  # noqa: F821 (provided by PlatformIO/SCons)
+
+SUFFIXES = {"win32": ".dll", "darwin": ".dylib"}
+
+env.Append(CCFLAGS=["-fPIC"], LINKFLAGS=["-shared"])  # noqa: F821
+env.Replace(PROGNAME="libtd", PROGSUFFIX=SUFFIXES.get(sys.platform, ".so"))  # noqa: F821
@@ -0,0 +1,290 @@
+"""
+Live tuning and telemetry client for the device (src/telemetry.hh)
+
+Talks to the game over its USB serial port while it runs: read and write
+the tower and enemy stat tables and the wave spawns in RAM, read live
+counters, start waves and change saved settings. Tuned values last until
+reset; settings are saved to flash at the next frame boundary.
+
+Usage:
+    python tools/td_tune.py PORT hello
+    python tools/td_tune.py PORT dump [tower|enemy|wave]
+    python tools/td_tune.py PORT get tower cannon range
+    python tools/td_tune.py PORT set enemy tank health 20
+    python tools/td_tune.py PORT set wave 1.2 spawn_time 1.25   # wave 1, spawn 2 (0-based)
+    python tools/td_tune.py PORT counters [--watch SECONDS]
+    python tools/td_tune.py PORT wave 2
+    python tools/td_tune.py PORT setting brightness [60]
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, os.path.join(ROOT, "gam4"))
+
+from frame_stream import cobs_decode, crc32_mpeg2  # noqa: E402
+
+SCHEMA = 4
+
+# TelemetryCommand / TelemetryStatus (src/telemetry.hh)
+HELLO, FIELD, READ, WRITE, COUNTERS, START_WAVE, GET_SETTING, SET_SETTING = range(1, 9)
+STATUS = ["ok", "schema mismatch", "unknown command", "bad argument", "out of range"]
+
+TABLES = ["tower", "enemy", "wave"]
+U8, I32, F32, BOOL, ENEMY = range(5)
+
+TOWER_NAMES = ["machine_gun", "cannon", "sniper", "radar"]
+ENEMY_NAMES = ["scout", "tank", "splitter", "ghost"]
+
+# TelemetryCounter, in order
+COUNTER_NAMES = [
+    "uptime_ms", "tick", "wave", "lives", "money", "score",
+    "enemies", "towers", "projectiles",
+    "frames", "frame_us", "frame_us_max", "input_us", "sim_us", "draw_us", "oled_us",
+    "compose_us", "refresh_hz", "compose_hz",
+    "compose_damage", "compose_full_frames", "compose_backdrops",
+    "stream_frames", "stream_bytes", "stream_skipped",
+    "kv_commits", "kv_worst_stall_us", "link_errors",
+]
+
+# KvKey (src/kv_store.hh): name -> (key, struct format)
+SETTINGS = {
+    "high_scores": (0, "<5I"),
+    "volume": (1, "<B"),
+    "brightness": (2, "<B"),
+    "joystick_center": (3, "<2H"),
+    "frame_stream_hz": (4, "<B"),
+}
+
+
+class LinkError(Exception):
+    pass
+
+
+class Link:
+    """Request/response over the serial port, skipping console text and frames"""
+
+    def __init__(self, path, timeout=0.5, retries=3):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        if os.isatty(self.fd):
+            tty.setraw(self.fd, termios.TCSANOW)
+        self.timeout = timeout
+        self.retries = retries
+        self.sequence = 0
+        self.pending = b""
+
+    def close(self):
+        os.close(self.fd)
+
+    def _send(self, packet):
+        packet += struct.pack("<I", crc32_mpeg2(packet))
+        encoded = bytearray()
+        block = bytearray()
+        for byte in packet:
+            if byte == 0:
+                encoded += bytes([len(block) + 1]) + block
+                block = bytearray()
+                continue
+            block.append(byte)
+            if len(block) == 254:
+                encoded += b"\xff" + block
+                block = bytearray()
+        encoded += bytes([len(block) + 1]) + block
+        os.write(self.fd, b"\x00" + bytes(encoded) + b"\x00")
+
+    def _receive(self, command, sequence):
+        deadline = time.monotonic() + self.timeout
+        while True:
+            chunks = self.pending.split(b"\x00")
+            self.pending = chunks.pop()
+            for chunk in chunks:
+                packet = cobs_decode(chunk) if chunk else None
+                if packet is None or len(packet) < 8:
+                    continue
+                body, crc = packet[:-4], struct.unpack_from("<I", packet, len(packet) - 4)[0]
+                if crc32_mpeg2(body) != crc:
+                    continue
+                if body[1] == command | 0x80 and body[2] == sequence:
+                    return body[3], body[4:]
+
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            ready, _, _ = select.select([self.fd], [], [], remaining)
+            if ready:
+                self.pending += os.read(self.fd, 4096)
+
+    def request(self, command, arguments=b""):
+        """Result bytes of a request; raises LinkError on an error status"""
+        for _ in range(self.retries):
+            self.sequence = (self.sequence + 1) & 0xFF
+            self._send(bytes([SCHEMA, command, self.sequence]) + arguments)
+            response = self._receive(command, self.sequence)
+            if response is None:
+                continue
+            status, result = response
+            if status != 0:
+                raise LinkError(STATUS[status] if status < len(STATUS) else "status %d" % status)
+            return result
+        raise LinkError("no response (is the game running this firmware?)")
+
+
+class Device:
+    """The tunable fields and counters of a connected game"""
+
+    def __init__(self, link):
+        self.link = link
+        hello = link.request(HELLO)
+        field_count, counter_count, self.towers, self.enemies, waves = hello[:5]
+        self.spawns = list(hello[5:5 + waves])
+        if counter_count != len(COUNTER_NAMES):
+            raise LinkError("device reports %d counters, expected %d"
+                            % (counter_count, len(COUNTER_NAMES)))
+
+        self.fields = []
+        for index in range(field_count):
+            info = link.request(FIELD, bytes([index]))
+            table, kind = info[0], info[1]
+            low, high = struct.unpack_from("<ff", info, 2)
+            self.fields.append({"index": index, "table": TABLES[table], "type": kind,
+                                "min": low, "max": high, "name": info[10:].decode()})
+
+    def field(self, table, name):
+        for field in self.fields:
+            if field["table"] == table and field["name"] == name:
+                return field
+        names = ", ".join(f["name"] for f in self.fields if f["table"] == table)
+        raise LinkError("no %s field %r (have: %s)" % (table, name, names))
+
+    def rows(self, table):
+        if table == "tower":
+            return [(i, TOWER_NAMES[i] if i < len(TOWER_NAMES) else str(i))
+                    for i in range(self.towers)]
+        if table == "enemy":
+            return [(i, ENEMY_NAMES[i] if i < len(ENEMY_NAMES) else str(i))
+                    for i in range(self.enemies)]
+        return [(w << 8 | s, "%d.%d" % (w, s))
+                for w, count in enumerate(self.spawns) for s in range(count)]
+
+    def row(self, table, text):
+        for index, name in self.rows(table):
+            if text in (name, str(index)):
+                return index
+        raise LinkError("no %s row %r" % (table, text))
+
+    def read(self, field, row):
+        raw = self.link.request(READ, struct.pack("<BH", field["index"], row))
+        return _decode(field, struct.unpack("<I", raw)[0])
+
+    def write(self, field, row, value):
+        raw = self.link.request(WRITE, struct.pack("<BHI", field["index"], row,
+                                                   _encode(field, value)))
+        return _decode(field, struct.unpack("<I", raw)[0])
+
+    def counters(self):
+        raw = self.link.request(COUNTERS)
+        values = struct.unpack_from("<%dI" % raw[0], raw, 1)
+        return dict(zip(COUNTER_NAMES, values))
+
+
+def _decode(field, bits):
+    if field["type"] == F32:
+        return round(struct.unpack("<f", struct.pack("<I", bits))[0], 6)
+    if field["type"] == I32:
+        return struct.unpack("<i", struct.pack("<I", bits))[0]
+    if field["type"] == ENEMY:
+        return ENEMY_NAMES[bits] if bits < len(ENEMY_NAMES) else bits
+    return bits
+
+
+def _encode(field, text):
+    if field["type"] == F32:
+        return struct.unpack("<I", struct.pack("<f", float(text)))[0]
+    if field["type"] == ENEMY and text in ENEMY_NAMES:
+        return ENEMY_NAMES.index(text)
+    if field["type"] == BOOL and text.lower() in ("true", "false"):
+        return int(text.lower() == "true")
+    return int(text, 0) & 0xFFFFFFFF
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("port", help="serial device, e.g. /dev/ttyACM0")
+    parser.add_argument("command", choices=["hello", "dump", "get", "set", "counters",
+                                            "wave", "setting"])
+    parser.add_argument("args", nargs="*")
+    parser.add_argument("--watch", type=float, metavar="SECONDS",
+                        help="with counters: repeat every SECONDS")
+    args = parser.parse_args()
+
+    link = Link(args.port)
+    try:
+        if args.command == "setting":
+            run_setting(link, args.args)
+        elif args.command == "wave":
+            link.request(START_WAVE, struct.pack("<H", int(args.args[0])))
+            print("wave %s started" % args.args[0])
+        elif args.command == "counters":
+            run_counters(Device(link), args.watch)
+        else:
+            run_fields(Device(link), args.command, args.args)
+    except (LinkError, IndexError, ValueError) as error:
+        sys.exit("td_tune: %s" % (error or "missing argument"))
+    finally:
+        link.close()
+
+
+def run_fields(device, command, words):
+    if command == "hello":
+        print("schema %d: %d towers, %d enemies, waves of %s spawns, %d fields"
+              % (SCHEMA, device.towers, device.enemies, device.spawns, len(device.fields)))
+        for field in device.fields:
+            print("  %-6s %-18s %g..%g" % (field["table"], field["name"], field["min"], field["max"]))
+    elif command == "dump":
+        for table in words or TABLES:
+            fields = [f for f in device.fields if f["table"] == table]
+            for index, name in device.rows(table):
+                values = ", ".join("%s=%s" % (f["name"], device.read(f, index)) for f in fields)
+                print("%s %s: %s" % (table, name, values))
+    elif command == "get":
+        table, row, name = words[:3]
+        print(device.read(device.field(table, name), device.row(table, row)))
+    elif command == "set":
+        table, row, name, value = words[:4]
+        field = device.field(table, name)
+        index = device.row(table, row)
+        before = device.read(field, index)
+        after = device.write(field, index, value)
+        print("%s %s %s: %s -> %s" % (table, row, name, before, after))
+
+
+def run_counters(device, watch):
+    while True:
+        counters = device.counters()
+        print("  ".join("%s=%d" % item for item in counters.items()))
+        if not watch:
+            return
+        time.sleep(watch)
+
+
+def run_setting(link, words):
+    name = words[0]
+    if name not in SETTINGS:
+        raise LinkError("unknown setting %r (have: %s)" % (name, ", ".join(SETTINGS)))
+    key, layout = SETTINGS[name]
+    if len(words) > 1:
+        value = struct.pack(layout, *(int(word, 0) for word in words[1:]))
+        link.request(SET_SETTING, bytes([key]) + value)
+    raw = link.request(GET_SETTING, bytes([key]))
+    print("%s: %s" % (name, " ".join(str(v) for v in struct.unpack(layout, raw))))
+
+
+if __name__ == "__main__":
+    main()